@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <sstream>
 
+#include "./perf_counters.hpp"
 #include "kepler/kepler.hpp"
 #include "reference/batman.hpp"
 #include "reference/contour.hpp"
@@ -62,12 +63,14 @@ TEMPLATE_PRODUCT_TEST_CASE("baselined", "[bench][baseline][double]", Benchmark,
       const T eccentricity = (T(n) + T(0.5)) / T(num_ecc);                                        \
       std::ostringstream name;                                                                    \
       name << std::setprecision(1) << "e=" << eccentricity << "; n=" << num_anom;                 \
-      BENCHMARK(name.str().c_str()) {                                                             \
+      auto run = [&] {                                                                            \
         return kepler::solver::solve<typename TestType::starter_type,                             \
                                      typename TestType::refiner_type>(                            \
             eccentricity, num_anom, mean_anomaly.data(), ecc_anomaly.data(), sin_ecc_anom.data(), \
             cos_ecc_anom.data(), refiner);                                                        \
       };                                                                                          \
+      BENCHMARK(name.str().c_str()) { return run(); };                                            \
+      kepler::benchmark::record_counters(name.str(), num_anom, run);                              \
     }                                                                                             \
   }
 
@@ -91,6 +94,21 @@ MAIN_BENCHMARK("brandt21f", "[bench][non-iterative][brandt][float]",
 MAIN_BENCHMARK("brandt21d", "[bench][non-iterative][brandt][double]",
                (kepler::refiners::brandt<double>, kepler::starters::raposo_pulido_brandt<double>))
 
+MAIN_BENCHMARK("fukushima97f", "[bench][non-iterative][fukushima][float]",
+               (kepler::refiners::non_iterative<3, float>, kepler::starters::fukushima<float>))
+MAIN_BENCHMARK("fukushima97d", "[bench][non-iterative][fukushima][double]",
+               (kepler::refiners::non_iterative<3, double>, kepler::starters::fukushima<double>))
+
+MAIN_BENCHMARK("nijenhuis91f", "[bench][non-iterative][nijenhuis][float]",
+               (kepler::refiners::non_iterative<2, float>, kepler::starters::nijenhuis<float>))
+MAIN_BENCHMARK("nijenhuis91d", "[bench][non-iterative][nijenhuis][double]",
+               (kepler::refiners::non_iterative<2, double>, kepler::starters::nijenhuis<double>))
+
+MAIN_BENCHMARK("contour16f", "[bench][non-iterative][contour][float]",
+               (kepler::refiners::noop<float>, kepler::starters::contour16<float>))
+MAIN_BENCHMARK("contour16d", "[bench][non-iterative][contour][double]",
+               (kepler::refiners::noop<double>, kepler::starters::contour16<double>))
+
 #undef MAIN_BENCHMARK
 
 #define SIMD_BENCHMARK(NAME, TAGS, ALGO)                                                          \
@@ -103,12 +121,14 @@ MAIN_BENCHMARK("brandt21d", "[bench][non-iterative][brandt][double]",
       const T eccentricity = (T(n) + T(0.5)) / T(num_ecc);                                        \
       std::ostringstream name;                                                                    \
       name << std::setprecision(1) << "e=" << eccentricity << "; n=" << num_anom;                 \
-      BENCHMARK(name.str().c_str()) {                                                             \
+      auto run = [&] {                                                                            \
         return kepler::solver::solve_simd<typename TestType::starter_type,                        \
                                           typename TestType::refiner_type>(                       \
             eccentricity, num_anom, mean_anomaly.data(), ecc_anomaly.data(), sin_ecc_anom.data(), \
             cos_ecc_anom.data(), refiner);                                                        \
       };                                                                                          \
+      BENCHMARK(name.str().c_str()) { return run(); };                                            \
+      kepler::benchmark::record_counters(name.str(), num_anom, run);                              \
     }                                                                                             \
   }
 
@@ -132,8 +152,269 @@ SIMD_BENCHMARK("brandt21fv", "[bench][non-iterative][brandt][float][simd]",
 SIMD_BENCHMARK("brandt21dv", "[bench][non-iterative][brandt][double][simd]",
                (kepler::refiners::brandt<double>, kepler::starters::raposo_pulido_brandt<double>))
 
+SIMD_BENCHMARK("fukushima97fv", "[bench][non-iterative][fukushima][float][simd]",
+               (kepler::refiners::non_iterative<3, float>, kepler::starters::fukushima<float>))
+SIMD_BENCHMARK("fukushima97dv", "[bench][non-iterative][fukushima][double][simd]",
+               (kepler::refiners::non_iterative<3, double>, kepler::starters::fukushima<double>))
+
+SIMD_BENCHMARK("nijenhuis91fv", "[bench][non-iterative][nijenhuis][float][simd]",
+               (kepler::refiners::non_iterative<2, float>, kepler::starters::nijenhuis<float>))
+SIMD_BENCHMARK("nijenhuis91dv", "[bench][non-iterative][nijenhuis][double][simd]",
+               (kepler::refiners::non_iterative<2, double>, kepler::starters::nijenhuis<double>))
+
+SIMD_BENCHMARK("contour16fv", "[bench][non-iterative][contour][float][simd]",
+               (kepler::refiners::noop<float>, kepler::starters::contour16<float>))
+SIMD_BENCHMARK("contour16dv", "[bench][non-iterative][contour][double][simd]",
+               (kepler::refiners::noop<double>, kepler::starters::contour16<double>))
+
 #undef SIMD_BENCHMARK
 
+#define COMPACT_BENCHMARK(NAME, TAGS, ALGO)                                                       \
+  TEMPLATE_PRODUCT_TEST_CASE(NAME, TAGS, Benchmark, (ALGO)) {                                     \
+    const size_t num_ecc = 5;                                                                     \
+    const size_t num_anom = DEFAULT_NUM_DATA;                                                     \
+    const typename TestType::refiner_type refiner;                                                \
+    for (size_t n = 0; n < num_ecc; ++n) {                                                        \
+      GENERATE_TEST_DATA(num_anom);                                                               \
+      const T eccentricity = (T(n) + T(0.5)) / T(num_ecc);                                        \
+      std::ostringstream name;                                                                    \
+      name << std::setprecision(1) << "e=" << eccentricity << "; n=" << num_anom;                 \
+      auto run = [&] {                                                                            \
+        return kepler::compact::solve<typename TestType::starter_type,                            \
+                                      typename TestType::refiner_type>(                           \
+            eccentricity, num_anom, mean_anomaly.data(), ecc_anomaly.data(), sin_ecc_anom.data(), \
+            cos_ecc_anom.data(), refiner);                                                        \
+      };                                                                                          \
+      BENCHMARK(name.str().c_str()) { return run(); };                                            \
+      kepler::benchmark::record_counters(name.str(), num_anom, run);                              \
+    }                                                                                             \
+  }
+
+COMPACT_BENCHMARK("iter3fc", "[bench][iterative][third-order][float][simd][compact]",
+                  (kepler::refiners::iterative<3, float>))
+COMPACT_BENCHMARK("iter3dc", "[bench][iterative][third-order][double][simd][compact]",
+                  (kepler::refiners::iterative<3, double>))
+
+#undef COMPACT_BENCHMARK
+
+#define CORDIC_BENCHMARK(NAME, TAGS, SOLVE)                                                       \
+  TEMPLATE_TEST_CASE(NAME, TAGS, float, double) {                                                 \
+    using T = TestType;                                                                           \
+    const size_t num_ecc = 5;                                                                     \
+    const size_t num_anom = DEFAULT_NUM_DATA;                                                     \
+    for (size_t n = 0; n < num_ecc; ++n) {                                                        \
+      std::vector<T> mean_anomaly(num_anom), ecc_anomaly(num_anom), sin_ecc_anom(num_anom),       \
+          cos_ecc_anom(num_anom);                                                                 \
+      for (size_t m = 0; m < num_anom; ++m) {                                                     \
+        mean_anomaly[m] = T(100.) * m / T(num_anom - 1) - T(50.);                                 \
+      }                                                                                           \
+      const T eccentricity = (T(n) + T(0.5)) / T(num_ecc);                                        \
+      std::ostringstream name;                                                                    \
+      name << std::setprecision(1) << "e=" << eccentricity << "; n=" << num_anom                  \
+           << "; iterations=" << kepler::cordic::default_iterations<T>::value;                    \
+      auto run = [&] {                                                                            \
+        return kepler::cordic::SOLVE<T>(eccentricity, num_anom, mean_anomaly.data(),              \
+                                        ecc_anomaly.data(), sin_ecc_anom.data(),                  \
+                                        cos_ecc_anom.data());                                     \
+      };                                                                                          \
+      BENCHMARK(name.str().c_str()) { return run(); };                                            \
+      kepler::benchmark::record_counters(name.str(), num_anom, run);                              \
+    }                                                                                             \
+  }
+
+CORDIC_BENCHMARK("cordic", "[bench][non-iterative][cordic]", solve)
+CORDIC_BENCHMARK("cordicv", "[bench][non-iterative][cordic][simd]", solve_simd)
+
+#undef CORDIC_BENCHMARK
+
+// The table is generated once, outside of the timed region, as if it was
+// loaded from a file
+TEST_CASE("tabulatedfv", "[bench][non-iterative][tabulated][float][simd]") {
+  static const auto table = kepler::tabulated::table::generate();
+  const size_t num_ecc = 5;
+  const size_t num_anom = DEFAULT_NUM_DATA;
+  for (size_t n = 0; n < num_ecc; ++n) {
+    std::vector<float> mean_anomaly(num_anom), ecc_anomaly(num_anom), sin_ecc_anom(num_anom),
+        cos_ecc_anom(num_anom);
+    for (size_t m = 0; m < num_anom; ++m) {
+      mean_anomaly[m] = 100.f * m / float(num_anom - 1) - 50.f;
+    }
+    const float eccentricity = (float(n) + 0.5f) / float(num_ecc);
+    std::ostringstream name;
+    name << std::setprecision(1) << "e=" << eccentricity << "; n=" << num_anom;
+    auto run = [&] {
+      return kepler::tabulated::solve_simd(table, eccentricity, num_anom, mean_anomaly.data(),
+                                           ecc_anomaly.data(), sin_ecc_anom.data(),
+                                           cos_ecc_anom.data());
+    };
+    BENCHMARK(name.str().c_str()) { return run(); };
+    kepler::benchmark::record_counters(name.str(), num_anom, run);
+  }
+}
+
+// The partitioned solver only differs from "brandt21fv" and "brandt21dv" above
+// e = 0.78, so these sample the high eccentricity range
+TEMPLATE_TEST_CASE("brandt21vp", "[bench][non-iterative][brandt][simd][partition]", float,
+                   double) {
+  using T = TestType;
+  const size_t num_ecc = 5;
+  const size_t num_anom = DEFAULT_NUM_DATA;
+  for (size_t n = 0; n < num_ecc; ++n) {
+    std::vector<T> mean_anomaly(num_anom), ecc_anomaly(num_anom), sin_ecc_anom(num_anom),
+        cos_ecc_anom(num_anom);
+    for (size_t m = 0; m < num_anom; ++m) {
+      mean_anomaly[m] = T(100.) * m / T(num_anom - 1) - T(50.);
+    }
+    const T eccentricity = T(0.78) + T(0.22) * (T(n) + T(0.5)) / T(num_ecc);
+    std::ostringstream name;
+    name << std::setprecision(2) << "e=" << eccentricity << "; n=" << num_anom;
+    auto run = [&] {
+      return kepler::partition::solve<T>(eccentricity, num_anom, mean_anomaly.data(),
+                                         ecc_anomaly.data(), sin_ecc_anom.data(),
+                                         cos_ecc_anom.data());
+    };
+    BENCHMARK(name.str().c_str()) { return run(); };
+    kepler::benchmark::record_counters(name.str(), num_anom, run);
+  }
+}
+
+// The continuation and uniform grid solvers are meant for densely sampled
+// mean anomalies, so these compare them with the full solvers on a grid of
+// 1000 points per orbit rather than on the sparse data used above
+#define CONTINUATION_BENCHMARK(NAME, TAGS, FULL, CONTINUATION, UNIFORM)                           \
+  TEMPLATE_TEST_CASE(NAME, TAGS, float, double) {                                                 \
+    using T = TestType;                                                                           \
+    using starter_type = kepler::starters::raposo_pulido_brandt<T>;                               \
+    using refiner_type = kepler::refiners::brandt<T>;                                             \
+    const size_t num_ecc = 5;                                                                     \
+    const size_t num_anom = DEFAULT_NUM_DATA;                                                     \
+    const T mean_anomaly_0 = T(-10.);                                                             \
+    const T mean_anomaly_step = kepler::constants::twopi<T>() / T(1000.);                         \
+    std::vector<T> mean_anomaly(num_anom), ecc_anomaly(num_anom), sin_ecc_anom(num_anom),         \
+        cos_ecc_anom(num_anom);                                                                   \
+    for (size_t m = 0; m < num_anom; ++m) {                                                       \
+      mean_anomaly[m] = kepler::math::fma(T(m), mean_anomaly_step, mean_anomaly_0);               \
+    }                                                                                             \
+    for (size_t n = 0; n < num_ecc; ++n) {                                                        \
+      const T eccentricity = (T(n) + T(0.5)) / T(num_ecc);                                        \
+      std::ostringstream suffix;                                                                  \
+      suffix << std::setprecision(1) << "; e=" << eccentricity << "; n=" << num_anom;             \
+      auto full = [&] {                                                                           \
+        return kepler::solver::FULL<starter_type, refiner_type>(                                  \
+            eccentricity, num_anom, mean_anomaly.data(), ecc_anomaly.data(), sin_ecc_anom.data(), \
+            cos_ecc_anom.data());                                                                 \
+      };                                                                                          \
+      auto continuation = [&] {                                                                   \
+        return kepler::solver::CONTINUATION<starter_type, refiner_type>(                          \
+            eccentricity, num_anom, mean_anomaly.data(), ecc_anomaly.data(), sin_ecc_anom.data(), \
+            cos_ecc_anom.data());                                                                 \
+      };                                                                                          \
+      auto uniform = [&] {                                                                        \
+        return kepler::solver::UNIFORM<starter_type, refiner_type>(                               \
+            eccentricity, mean_anomaly_0, mean_anomaly_step, num_anom, ecc_anomaly.data(),        \
+            sin_ecc_anom.data(), cos_ecc_anom.data());                                            \
+      };                                                                                          \
+      BENCHMARK(("full" + suffix.str()).c_str()) { return full(); };                              \
+      BENCHMARK(("continuation" + suffix.str()).c_str()) { return continuation(); };              \
+      BENCHMARK(("uniform" + suffix.str()).c_str()) { return uniform(); };                        \
+      kepler::benchmark::record_counters("full" + suffix.str(), num_anom, full);                  \
+      kepler::benchmark::record_counters("continuation" + suffix.str(), num_anom, continuation);  \
+      kepler::benchmark::record_counters("uniform" + suffix.str(), num_anom, uniform);            \
+    }                                                                                             \
+  }
+
+CONTINUATION_BENCHMARK("brandt21c", "[bench][non-iterative][brandt][continuation]", solve,
+                       solve_continuation, solve_uniform)
+CONTINUATION_BENCHMARK("brandt21cv", "[bench][non-iterative][brandt][continuation][simd]",
+                       solve_simd, solve_continuation_simd, solve_uniform_simd)
+
+#undef CONTINUATION_BENCHMARK
+
+// A 27.4 day light curve at a 2 minute cadence, like a TESS sector, for a hot
+// Jupiter and for a longer period planet, comparing a full solve at every time
+// with the transit-window culling. The names give the fraction of the times
+// that are actually solved.
+TEMPLATE_TEST_CASE("transitv", "[bench][non-iterative][brandt][transit][simd]", float, double) {
+  using T = TestType;
+  using starter_type = kepler::starters::raposo_pulido_brandt<T>;
+  using refiner_type = kepler::refiners::brandt<T>;
+  const size_t num_time = 19728;
+  const kepler::transit::orbit<T> orbits[] = {
+      kepler::transit::orbit<T>::from_transit(T(3.5), T(1.), T(0.1), T(1.), T(8.8), T(1.545)),
+      kepler::transit::orbit<T>::from_transit(T(30.), T(1.), T(0.1), T(1.), T(40.), T(1.563))};
+  const T radius = T(1.1);
+  std::vector<T> time(num_time), mean_anomaly(num_time), ecc_anomaly(num_time),
+      sin_ecc_anom(num_time), cos_ecc_anom(num_time);
+  std::vector<std::size_t> index(num_time);
+  for (size_t m = 0; m < num_time; ++m) time[m] = T(2.) / T(1440.) * T(m);
+  for (const auto& orb : orbits) {
+    const T mean_motion = kepler::constants::twopi<T>() / orb.period;
+    for (size_t m = 0; m < num_time; ++m) {
+      mean_anomaly[m] = mean_motion * (time[m] - orb.time_of_periastron);
+    }
+    auto full = [&] {
+      return kepler::solver::solve_simd<starter_type, refiner_type>(
+          orb.eccentricity, num_time, mean_anomaly.data(), ecc_anomaly.data(),
+          sin_ecc_anom.data(), cos_ecc_anom.data());
+    };
+    auto culled = [&] {
+      return kepler::transit::solve<starter_type, refiner_type>(
+          orb, radius, num_time, time.data(), index.data(), ecc_anomaly.data(),
+          sin_ecc_anom.data(), cos_ecc_anom.data());
+    };
+    std::ostringstream suffix;
+    suffix << std::setprecision(2) << "; P=" << orb.period << "; n=" << num_time
+           << "; solved=" << double(culled()) / double(num_time);
+    BENCHMARK(("full" + suffix.str()).c_str()) { return full(); };
+    BENCHMARK(("culled" + suffix.str()).c_str()) { return culled(); };
+    kepler::benchmark::record_counters("full" + suffix.str(), num_time, full);
+    kepler::benchmark::record_counters("culled" + suffix.str(), num_time, culled);
+  }
+}
+
+// The double-double solvers are compared with the double precision solver
+// that provides their initial estimate, on the same data
+#define DOUBLE_DOUBLE_BENCHMARK(NAME, TAGS, SOLVE, DOUBLE_SOLVE)                                  \
+  TEST_CASE(NAME, TAGS) {                                                                         \
+    using starter_type = kepler::starters::raposo_pulido_brandt<double>;                          \
+    using refiner_type = kepler::refiners::brandt<double>;                                        \
+    const size_t num_ecc = 5;                                                                     \
+    const size_t num_anom = DEFAULT_NUM_DATA;                                                     \
+    for (size_t n = 0; n < num_ecc; ++n) {                                                        \
+      std::vector<double> mean_anomaly_hi(num_anom), mean_anomaly_lo(num_anom, 0.),               \
+          ecc_anomaly_hi(num_anom), ecc_anomaly_lo(num_anom), sin_ecc_anom_hi(num_anom),          \
+          sin_ecc_anom_lo(num_anom), cos_ecc_anom_hi(num_anom), cos_ecc_anom_lo(num_anom);        \
+      for (size_t m = 0; m < num_anom; ++m) {                                                     \
+        mean_anomaly_hi[m] = 100. * m / double(num_anom - 1) - 50.;                               \
+      }                                                                                           \
+      const double eccentricity = (double(n) + 0.5) / double(num_ecc);                            \
+      std::ostringstream suffix;                                                                  \
+      suffix << std::setprecision(1) << "; e=" << eccentricity << "; n=" << num_anom;             \
+      auto single = [&] {                                                                         \
+        return kepler::solver::DOUBLE_SOLVE<starter_type, refiner_type>(                          \
+            eccentricity, num_anom, mean_anomaly_hi.data(), ecc_anomaly_hi.data(),                \
+            sin_ecc_anom_hi.data(), cos_ecc_anom_hi.data());                                      \
+      };                                                                                          \
+      auto run = [&] {                                                                            \
+        return kepler::dd::SOLVE(eccentricity, num_anom,                                          \
+                                 {mean_anomaly_hi.data(), mean_anomaly_lo.data()},                \
+                                 {ecc_anomaly_hi.data(), ecc_anomaly_lo.data()},                  \
+                                 {sin_ecc_anom_hi.data(), sin_ecc_anom_lo.data()},                \
+                                 {cos_ecc_anom_hi.data(), cos_ecc_anom_lo.data()});               \
+      };                                                                                          \
+      BENCHMARK(("double" + suffix.str()).c_str()) { return single(); };                          \
+      BENCHMARK(("double-double" + suffix.str()).c_str()) { return run(); };                      \
+      kepler::benchmark::record_counters("double" + suffix.str(), num_anom, single);              \
+      kepler::benchmark::record_counters("double-double" + suffix.str(), num_anom, run);          \
+    }                                                                                             \
+  }
+
+DOUBLE_DOUBLE_BENCHMARK("dd", "[bench][non-iterative][double-double]", solve<>, solve)
+DOUBLE_DOUBLE_BENCHMARK("ddv", "[bench][non-iterative][double-double][simd]", solve_simd<>,
+                        solve_simd)
+
+#undef DOUBLE_DOUBLE_BENCHMARK
+
 #define REFERENCE_BENCHMARK(NAME, TAGS, ALGO)                                         \
   TEMPLATE_PRODUCT_TEST_CASE(NAME, TAGS, RefBenchmark, (ALGO)) {                      \
     const size_t num_ecc = 5;                                                         \
@@ -144,7 +425,7 @@ SIMD_BENCHMARK("brandt21dv", "[bench][non-iterative][brandt][double][simd]",
       const T eccentricity = (T(n) + T(0.5)) / T(num_ecc);                            \
       std::ostringstream name;                                                        \
       name << std::setprecision(1) << "e=" << eccentricity << "; n=" << num_anom;     \
-      BENCHMARK(name.str().c_str()) {                                                 \
+      auto run = [&] {                                                                \
         solver.setup(eccentricity);                                                   \
         for (std::size_t n = 0; n < num_anom; ++n) {                                  \
           ecc_anomaly[n] = solver.solve(mean_anomaly[n]);                             \
@@ -154,6 +435,8 @@ SIMD_BENCHMARK("brandt21dv", "[bench][non-iterative][brandt][double][simd]",
         return std::make_tuple(ecc_anomaly[num_anom - 1], sin_ecc_anom[num_anom - 1], \
                                cos_ecc_anom[num_anom - 1]);                           \
       };                                                                              \
+      BENCHMARK(name.str().c_str()) { return run(); };                                \
+      kepler::benchmark::record_counters(name.str(), num_anom, run);                  \
     }                                                                                 \
   }
 
@@ -0,0 +1,165 @@
+// A side by side comparison of the SIMD benchmarks compiled for each instruction
+// set supported by the toolchain.
+//
+// Usage: isa [--num-data N] [--min-time SECONDS] [--module-dir DIR]
+//
+// The kernels in isa_kernel.cpp are compiled once per instruction set into
+// separate modules, and this driver (which is itself compiled for the baseline
+// architecture) loads the ones that the host can execute. The time per element
+// is reported for each, along with the speedup relative to the first available
+// instruction set.
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "./isa_module.h"
+#include "./timing.hpp"
+#include "xsimd/xsimd.hpp"
+
+#ifndef KEPLER_ISA_MODULE_DIR
+#define KEPLER_ISA_MODULE_DIR "."
+#endif
+
+#ifndef KEPLER_ISA_MODULE_SUFFIX
+#define KEPLER_ISA_MODULE_SUFFIX ".so"
+#endif
+
+namespace {
+
+using kepler::benchmark::time_per_call;
+
+struct isa {
+  const char* name;
+  bool (*supported)();
+};
+
+// These names must match KEPLER_ISA_TARGETS in CMakeLists.txt
+const isa isas[] = {
+    {"sse2", [] { return bool(xsimd::available_architectures().sse2); }},
+    {"sse4_2", [] { return bool(xsimd::available_architectures().sse4_2); }},
+    {"avx", [] { return bool(xsimd::available_architectures().avx); }},
+    {"avx2", [] { return bool(xsimd::available_architectures().fma3_avx2); }},
+    {"avx512f", [] { return bool(xsimd::available_architectures().avx512f); }}};
+
+struct module {
+  std::string name, arch;
+  void* handle;
+  kepler_isa_num_algorithms_fn num_algorithms;
+  kepler_isa_algorithm_name_fn algorithm_name;
+  kepler_isa_solve_fn solve;
+  kepler_isa_solvef_fn solvef;
+};
+
+bool load(const std::string& dir, const isa& target, module& mod) {
+  std::string path = dir + "/kepler_isa_" + target.name + KEPLER_ISA_MODULE_SUFFIX;
+  mod.handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (mod.handle == nullptr) return false;
+  auto arch = reinterpret_cast<kepler_isa_arch_fn>(dlsym(mod.handle, "kepler_isa_arch"));
+  mod.num_algorithms = reinterpret_cast<kepler_isa_num_algorithms_fn>(
+      dlsym(mod.handle, "kepler_isa_num_algorithms"));
+  mod.algorithm_name = reinterpret_cast<kepler_isa_algorithm_name_fn>(
+      dlsym(mod.handle, "kepler_isa_algorithm_name"));
+  mod.solve = reinterpret_cast<kepler_isa_solve_fn>(dlsym(mod.handle, "kepler_isa_solve"));
+  mod.solvef = reinterpret_cast<kepler_isa_solvef_fn>(dlsym(mod.handle, "kepler_isa_solvef"));
+  if (!arch || !mod.num_algorithms || !mod.algorithm_name || !mod.solve || !mod.solvef) {
+    dlclose(mod.handle);
+    return false;
+  }
+  mod.name = target.name;
+  mod.arch = arch();
+  return true;
+}
+
+// The mean time per element over the same eccentricities as benchmark.cpp
+template <typename T, typename Solve>
+double time_algorithm(Solve solve, std::size_t algorithm, std::size_t size, double min_time) {
+  const std::size_t num_ecc = 5;
+  std::vector<T> mean_anomaly(size), ecc_anomaly(size), sin_ecc_anom(size), cos_ecc_anom(size);
+  for (std::size_t m = 0; m < size; ++m) {
+    mean_anomaly[m] = T(100.) * T(m) / T(std::max<std::size_t>(size - 1, 1)) - T(50.);
+  }
+  double total = 0;
+  for (std::size_t n = 0; n < num_ecc; ++n) {
+    const T eccentricity = (T(n) + T(0.5)) / T(num_ecc);
+    total += time_per_call(
+        [&] {
+          solve(algorithm, eccentricity, size, mean_anomaly.data(), ecc_anomaly.data(),
+                sin_ecc_anom.data(), cos_ecc_anom.data());
+        },
+        min_time / double(num_ecc));
+  }
+  return total / double(num_ecc) / double(size) * 1e9;
+}
+
+void usage() {
+  std::cerr << "usage: isa [--num-data N] [--min-time SECONDS] [--module-dir DIR]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t size = 1000;
+  double min_time = 0.1;
+  std::string dir = KEPLER_ISA_MODULE_DIR;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--num-data") {
+      size = std::strtoull(argv[++i], nullptr, 10);
+    } else if (i + 1 < argc && arg == "--min-time") {
+      min_time = std::atof(argv[++i]);
+    } else if (i + 1 < argc && arg == "--module-dir") {
+      dir = argv[++i];
+    } else {
+      usage();
+      return arg == "-h" || arg == "--help" ? 0 : 1;
+    }
+  }
+  if (size == 0) {
+    usage();
+    return 1;
+  }
+
+  std::vector<module> modules;
+  for (const auto& target : isas) {
+    module mod;
+    if (!target.supported()) {
+      std::printf("%-8s not supported by this host\n", target.name);
+    } else if (!load(dir, target, mod)) {
+      const char* error = dlerror();
+      std::printf("%-8s not built (%s)\n", target.name, error ? error : "missing symbols");
+    } else {
+      std::printf("%-8s loaded (xsimd arch: %s)\n", target.name, mod.arch.c_str());
+      modules.push_back(mod);
+    }
+  }
+  if (modules.empty()) return 1;
+
+  std::printf("\nns per element for n=%zu, with the speedup relative to %s:\n\n%-12s %-7s",
+              size, modules[0].name.c_str(), "algorithm", "type");
+  for (const auto& mod : modules) std::printf(" %18s", mod.name.c_str());
+  std::printf("\n");
+
+  for (std::size_t algorithm = 0; algorithm < modules[0].num_algorithms(); ++algorithm) {
+    for (int precision = 0; precision < 2; ++precision) {
+      std::printf("%-12s %-7s", modules[0].algorithm_name(algorithm),
+                  precision ? "double" : "float");
+      double baseline = 0;
+      for (const auto& mod : modules) {
+        double ns = precision ? time_algorithm<double>(mod.solve, algorithm, size, min_time)
+                              : time_algorithm<float>(mod.solvef, algorithm, size, min_time);
+        if (baseline == 0) baseline = ns;
+        std::printf(" %9.3g (%5.2fx)", ns, baseline / ns);
+      }
+      std::printf("\n");
+    }
+  }
+
+  for (auto& mod : modules) dlclose(mod.handle);
+  return 0;
+}
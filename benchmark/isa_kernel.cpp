@@ -0,0 +1,70 @@
+// The benchmark kernels, compiled once per instruction set into a separate
+// module (see KEPLER_ISA_TARGETS in CMakeLists.txt). The modules are built with
+// hidden visibility and loaded with RTLD_LOCAL, so that the inline functions
+// instantiated for one instruction set can't be substituted for those of
+// another.
+
+#include "./isa_module.h"
+#include "kepler/kepler.hpp"
+#include "xsimd/xsimd.hpp"
+
+namespace {
+
+template <typename T>
+using solve_fn = void (*)(T, std::size_t, const T*, T*, T*, T*);
+
+template <typename Starter, typename Refiner>
+void solve(typename Starter::value_type eccentricity, std::size_t size,
+           const typename Starter::value_type* mean_anomaly,
+           typename Starter::value_type* eccentric_anomaly,
+           typename Starter::value_type* sin_eccentric_anomaly,
+           typename Starter::value_type* cos_eccentric_anomaly) {
+  kepler::solver::solve_simd<Starter, Refiner>(eccentricity, size, mean_anomaly,
+                                               eccentric_anomaly, sin_eccentric_anomaly,
+                                               cos_eccentric_anomaly);
+}
+
+template <typename T>
+struct algorithm {
+  const char* name;
+  solve_fn<T> func;
+};
+
+// The same configurations as the SIMD benchmarks in benchmark.cpp
+template <typename T>
+const algorithm<T> algorithms[] = {
+    {"iter1", &solve<kepler::starters::basic<T>, kepler::refiners::iterative<1, T>>},
+    {"iter3", &solve<kepler::starters::basic<T>, kepler::refiners::iterative<3, T>>},
+    {"markley95", &solve<kepler::starters::markley<T>, kepler::refiners::non_iterative<3, T>>},
+    {"brandt21",
+     &solve<kepler::starters::raposo_pulido_brandt<T>, kepler::refiners::brandt<T>>}};
+
+constexpr std::size_t num_algorithms = sizeof(algorithms<double>) / sizeof(algorithm<double>);
+
+}  // namespace
+
+#define KEPLER_ISA_EXPORT extern "C" __attribute__((visibility("default")))
+
+KEPLER_ISA_EXPORT const char* kepler_isa_arch() { return xsimd::default_arch::name(); }
+
+KEPLER_ISA_EXPORT std::size_t kepler_isa_num_algorithms() { return num_algorithms; }
+
+KEPLER_ISA_EXPORT const char* kepler_isa_algorithm_name(std::size_t n) {
+  return n < num_algorithms ? algorithms<double>[n].name : nullptr;
+}
+
+KEPLER_ISA_EXPORT void kepler_isa_solve(std::size_t n, double eccentricity, std::size_t size,
+                                        const double* mean_anomaly, double* eccentric_anomaly,
+                                        double* sin_eccentric_anomaly,
+                                        double* cos_eccentric_anomaly) {
+  algorithms<double>[n].func(eccentricity, size, mean_anomaly, eccentric_anomaly,
+                             sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+KEPLER_ISA_EXPORT void kepler_isa_solvef(std::size_t n, float eccentricity, std::size_t size,
+                                         const float* mean_anomaly, float* eccentric_anomaly,
+                                         float* sin_eccentric_anomaly,
+                                         float* cos_eccentric_anomaly) {
+  algorithms<float>[n].func(eccentricity, size, mean_anomaly, eccentric_anomaly,
+                            sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
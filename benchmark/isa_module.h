@@ -0,0 +1,27 @@
+#ifndef KEPLER_BENCHMARK_ISA_MODULE_H
+#define KEPLER_BENCHMARK_ISA_MODULE_H
+
+// The interface exported by each of the per-ISA benchmark modules built from
+// isa_kernel.cpp, and loaded at runtime by isa.cpp
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef const char* (*kepler_isa_arch_fn)(void);
+typedef size_t (*kepler_isa_num_algorithms_fn)(void);
+typedef const char* (*kepler_isa_algorithm_name_fn)(size_t algorithm);
+typedef void (*kepler_isa_solve_fn)(size_t algorithm, double eccentricity, size_t size,
+                                    const double* mean_anomaly, double* eccentric_anomaly,
+                                    double* sin_eccentric_anomaly, double* cos_eccentric_anomaly);
+typedef void (*kepler_isa_solvef_fn)(size_t algorithm, float eccentricity, size_t size,
+                                     const float* mean_anomaly, float* eccentric_anomaly,
+                                     float* sin_eccentric_anomaly, float* cos_eccentric_anomaly);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
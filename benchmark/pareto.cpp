@@ -0,0 +1,242 @@
+// An accuracy versus speed comparison of all the starter/refiner pairs.
+//
+// Usage: pareto [--num-eccentricity N] [--num-mean-anomaly N] [--min-time SECONDS]
+//               [--output FILE]
+//
+// Each configuration is run over a dense grid of eccentricities in [0, 1) and
+// mean anomalies in [0, 2 pi), and the maximum and RMS errors of E, sin(E) and
+// cos(E) are computed against a long double reference solution. These are
+// paired with the throughput of the same configuration over the same grid and
+// written out as a CSV table, where the `pareto` column flags the
+// configurations for which no other configuration is both faster and more
+// accurate (comparing the largest of the three maximum errors).
+//
+// Note: on platforms where long double is the same as double, the reference is
+// only good to double precision and the errors of the double precision
+// solvers are not meaningful.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "./timing.hpp"
+#include "kepler/kepler.hpp"
+
+namespace {
+
+using kepler::benchmark::time_per_call;
+using real = long double;
+
+constexpr real pi = 3.141592653589793238462643383279502884L;
+
+struct options {
+  std::size_t num_eccentricity = 200;
+  std::size_t num_mean_anomaly = 2000;
+  double min_time = 0.2;
+  std::string output;
+};
+
+struct error {
+  double max = 0, sum2 = 0;
+  std::size_t count = 0;
+
+  void add(real delta) {
+    double value = double(std::abs(delta));
+    max = std::max(max, value);
+    sum2 += value * value;
+    count += 1;
+  }
+
+  double rms() const { return count ? std::sqrt(sum2 / double(count)) : 0.0; }
+};
+
+struct result {
+  std::string precision, starter, refiner;
+  double ns_per_element;
+  error eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly;
+  bool pareto = false;
+
+  double max_error() const {
+    return std::max(
+        {eccentric_anomaly.max, sin_eccentric_anomaly.max, cos_eccentric_anomaly.max});
+  }
+};
+
+// A safeguarded Newton solve in long double for M in [0, 2 pi)
+real reference(real eccentricity, real mean_anomaly) {
+  bool high = mean_anomaly > pi;
+  if (high) mean_anomaly = 2 * pi - mean_anomaly;
+  real lo = 0, hi = pi;
+  real ecc_anom = std::min(mean_anomaly + real(0.85) * eccentricity, pi);
+  for (int i = 0; i < 200; ++i) {
+    real f = ecc_anom - eccentricity * std::sin(ecc_anom) - mean_anomaly;
+    if (f > 0) {
+      hi = ecc_anom;
+    } else {
+      lo = ecc_anom;
+    }
+    real next = ecc_anom - f / (1 - eccentricity * std::cos(ecc_anom));
+    if (!(next > lo && next < hi)) next = real(0.5) * (lo + hi);
+    if (next == ecc_anom || hi - lo <= std::numeric_limits<real>::epsilon() * hi) break;
+    ecc_anom = next;
+  }
+  return high ? 2 * pi - ecc_anom : ecc_anom;
+}
+
+template <typename T>
+struct grid {
+  std::vector<T> eccentricity, mean_anomaly;
+  std::vector<real> eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly;
+  std::vector<T> ecc_anom, sin_ecc_anom, cos_ecc_anom;
+
+  explicit grid(const options& opts) {
+    const std::size_t num_e = opts.num_eccentricity, num_M = opts.num_mean_anomaly;
+    for (std::size_t i = 0; i < num_e; ++i) {
+      // Cluster the eccentricities towards 1 where the solvers are hardest
+      double x = double(i) / double(num_e);
+      eccentricity.push_back(T(1 - (1 - x) * (1 - x)));
+    }
+    for (std::size_t j = 0; j < num_M; ++j) {
+      mean_anomaly.push_back(T(2 * pi * real(j) / real(num_M)));
+    }
+    for (T e : eccentricity) {
+      for (T M : mean_anomaly) {
+        real E = reference(real(e), real(M));
+        eccentric_anomaly.push_back(E);
+        sin_eccentric_anomaly.push_back(std::sin(E));
+        cos_eccentric_anomaly.push_back(std::cos(E));
+      }
+    }
+    ecc_anom.resize(num_e * num_M);
+    sin_ecc_anom.resize(num_e * num_M);
+    cos_ecc_anom.resize(num_e * num_M);
+  }
+};
+
+template <typename Starter, typename Refiner, typename T>
+void evaluate(const options& opts, grid<T>& g, const char* precision, const char* starter,
+              const char* refiner, std::vector<result>& results) {
+  const std::size_t num_M = g.mean_anomaly.size();
+  auto solve = [&] {
+    for (std::size_t i = 0; i < g.eccentricity.size(); ++i) {
+      kepler::solver::solve_simd<Starter, Refiner>(
+          g.eccentricity[i], num_M, g.mean_anomaly.data(), &(g.ecc_anom[i * num_M]),
+          &(g.sin_ecc_anom[i * num_M]), &(g.cos_ecc_anom[i * num_M]));
+    }
+  };
+  double seconds = time_per_call(solve, opts.min_time);
+
+  result r;
+  r.precision = precision;
+  r.starter = starter;
+  r.refiner = refiner;
+  r.ns_per_element = seconds / double(g.ecc_anom.size()) * 1e9;
+  for (std::size_t n = 0; n < g.ecc_anom.size(); ++n) {
+    real delta = real(g.ecc_anom[n]) - g.eccentric_anomaly[n];
+    r.eccentric_anomaly.add(std::remainder(delta, 2 * pi));
+    r.sin_eccentric_anomaly.add(real(g.sin_ecc_anom[n]) - g.sin_eccentric_anomaly[n]);
+    r.cos_eccentric_anomaly.add(real(g.cos_ecc_anom[n]) - g.cos_eccentric_anomaly[n]);
+  }
+  std::fprintf(stderr, "%s %s/%s: %.3g ns/element, max error %.3g\n", precision, starter,
+               refiner, r.ns_per_element, r.max_error());
+  results.push_back(r);
+}
+
+template <template <typename> class Starter, typename T>
+void evaluate_starter(const options& opts, grid<T>& g, const char* precision, const char* name,
+                      std::vector<result>& results) {
+  using namespace kepler::refiners;
+  evaluate<Starter<T>, noop<T>>(opts, g, precision, name, "noop", results);
+  evaluate<Starter<T>, iterative<1, T>>(opts, g, precision, name, "iterative1", results);
+  evaluate<Starter<T>, iterative<2, T>>(opts, g, precision, name, "iterative2", results);
+  evaluate<Starter<T>, iterative<3, T>>(opts, g, precision, name, "iterative3", results);
+  evaluate<Starter<T>, non_iterative<1, T>>(opts, g, precision, name, "non_iterative1", results);
+  evaluate<Starter<T>, non_iterative<2, T>>(opts, g, precision, name, "non_iterative2", results);
+  evaluate<Starter<T>, non_iterative<3, T>>(opts, g, precision, name, "non_iterative3", results);
+  evaluate<Starter<T>, brandt<T>>(opts, g, precision, name, "brandt", results);
+}
+
+template <typename T>
+void evaluate_all(const options& opts, const char* precision, std::vector<result>& results) {
+  using namespace kepler::starters;
+  grid<T> g(opts);
+  evaluate_starter<noop>(opts, g, precision, "noop", results);
+  evaluate_starter<basic>(opts, g, precision, "basic", results);
+  evaluate_starter<mikkola>(opts, g, precision, "mikkola", results);
+  evaluate_starter<markley>(opts, g, precision, "markley", results);
+  evaluate_starter<raposo_pulido_brandt>(opts, g, precision, "raposo_pulido_brandt", results);
+  evaluate_starter<fukushima>(opts, g, precision, "fukushima", results);
+  evaluate_starter<nijenhuis>(opts, g, precision, "nijenhuis", results);
+  evaluate_starter<contour16>(opts, g, precision, "contour16", results);
+}
+
+void mark_pareto(std::vector<result>& results) {
+  for (auto& r : results) {
+    r.pareto = std::none_of(results.begin(), results.end(), [&](const result& other) {
+      bool no_worse =
+          other.ns_per_element <= r.ns_per_element && other.max_error() <= r.max_error();
+      bool better = other.ns_per_element < r.ns_per_element || other.max_error() < r.max_error();
+      return no_worse && better;
+    });
+  }
+}
+
+void usage() {
+  std::cerr << "usage: pareto [--num-eccentricity N] [--num-mean-anomaly N] "
+               "[--min-time SECONDS] [--output FILE]"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--num-eccentricity") {
+      opts.num_eccentricity = std::strtoull(argv[++i], nullptr, 10);
+    } else if (i + 1 < argc && arg == "--num-mean-anomaly") {
+      opts.num_mean_anomaly = std::strtoull(argv[++i], nullptr, 10);
+    } else if (i + 1 < argc && arg == "--min-time") {
+      opts.min_time = std::atof(argv[++i]);
+    } else if (i + 1 < argc && arg == "--output") {
+      opts.output = argv[++i];
+    } else {
+      usage();
+      return arg == "-h" || arg == "--help" ? 0 : 1;
+    }
+  }
+  if (opts.num_eccentricity == 0 || opts.num_mean_anomaly == 0) {
+    usage();
+    return 1;
+  }
+
+  std::vector<result> results;
+  evaluate_all<float>(opts, "float", results);
+  evaluate_all<double>(opts, "double", results);
+  mark_pareto(results);
+  std::sort(results.begin(), results.end(),
+            [](const result& a, const result& b) { return a.max_error() < b.max_error(); });
+
+  std::ofstream file;
+  if (!opts.output.empty()) file.open(opts.output);
+  std::ostream& out = opts.output.empty() ? std::cout : file;
+  out << "precision,starter,refiner,ns_per_element,max_error_E,rms_error_E,max_error_sinE,"
+         "rms_error_sinE,max_error_cosE,rms_error_cosE,pareto\n";
+  for (const auto& r : results) {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer), "%s,%s,%s,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%d\n",
+                  r.precision.c_str(), r.starter.c_str(), r.refiner.c_str(), r.ns_per_element,
+                  r.eccentric_anomaly.max, r.eccentric_anomaly.rms(),
+                  r.sin_eccentric_anomaly.max, r.sin_eccentric_anomaly.rms(),
+                  r.cos_eccentric_anomaly.max, r.cos_eccentric_anomaly.rms(), int(r.pareto));
+    out << buffer;
+  }
+  return out ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+#ifndef KEPLER_BENCHMARK_PERF_COUNTERS_HPP
+#define KEPLER_BENCHMARK_PERF_COUNTERS_HPP
+
+// Optional hardware performance counters for the benchmarks, using
+// perf_event_open on Linux. This is enabled by defining KEPLER_PERF_COUNTERS
+// (see the KEPLER_BENCHMARK_PERF_COUNTERS CMake option). Only user space events
+// are counted, so this works without root as long as
+// /proc/sys/kernel/perf_event_paranoid is at most 2. Events that aren't
+// supported by the current machine are skipped.
+//
+// `record_counters(name, num_elements, func)` runs `func` repeatedly with the
+// counters enabled and reports the counts per element as a Catch2 warning of
+// the form
+//
+//   perf: <benchmark name> | cycles=... instructions=... branch_misses=...
+//
+// which is written into the XML results next to the benchmark timings, and
+// picked up by `tools/benchmark_results/collect.py`.
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <string>
+
+#ifdef KEPLER_PERF_COUNTERS
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace kepler {
+namespace benchmark {
+
+class perf_counters {
+ public:
+  perf_counters() {
+    add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    add("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    add("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    add("l1d_misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D));
+    add("llc_misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL));
+  }
+
+  ~perf_counters() {
+    for (auto& c : counters_) close(c.fd);
+  }
+
+  perf_counters(const perf_counters&) = delete;
+  perf_counters& operator=(const perf_counters&) = delete;
+
+  bool available() const { return !counters_.empty(); }
+
+  void start() {
+    for (auto& c : counters_) {
+      ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  void stop() {
+    for (auto& c : counters_) ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+
+  // Format the counts, scaled for multiplexing and divided by `scale`
+  std::string format(double scale) const {
+    std::string result;
+    for (const auto& c : counters_) {
+      std::uint64_t values[3] = {0, 0, 0};  // value, time enabled, time running
+      if (read(c.fd, values, sizeof(values)) != ssize_t(sizeof(values))) continue;
+      if (values[2] == 0) continue;
+      double count = double(values[0]) * double(values[1]) / double(values[2]);
+      char buffer[64];
+      std::snprintf(buffer, sizeof(buffer), "%s%s=%.6g", result.empty() ? "" : " ", c.name,
+                    count / scale);
+      result += buffer;
+    }
+    return result;
+  }
+
+ private:
+  struct counter {
+    const char* name;
+    int fd;
+  };
+  std::vector<counter> counters_;
+
+  static std::uint64_t cache_event(std::uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+
+  void add(const char* name, std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    if (fd >= 0) counters_.push_back({name, fd});
+  }
+};
+
+template <typename F>
+void record_counters(const std::string& name, std::size_t num_elements, F&& func) {
+  static perf_counters counters;
+  if (!counters.available()) return;
+
+  // Choose the number of repetitions to run for about 10 ms, so that the
+  // counting overhead is negligible, then count
+  std::size_t reps = 10;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t n = 0; n < reps; ++n) func();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (elapsed < 0.01) reps = std::size_t(double(reps) * 0.01 / std::max(elapsed, 1e-6)) + 1;
+
+  counters.start();
+  for (std::size_t n = 0; n < reps; ++n) func();
+  counters.stop();
+  WARN("perf: " << name << " | " << counters.format(double(reps) * double(num_elements)));
+}
+
+}  // namespace benchmark
+}  // namespace kepler
+
+#else
+
+namespace kepler {
+namespace benchmark {
+
+template <typename F>
+inline void record_counters(const std::string&, std::size_t, F&&) {}
+
+}  // namespace benchmark
+}  // namespace kepler
+
+#endif
+
+#endif
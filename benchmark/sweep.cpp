@@ -0,0 +1,369 @@
+// A throughput sweep over array sizes, precisions and starter/refiner pairs,
+// reported against a simple roofline for the current core.
+//
+// Usage: sweep [--max-size N] [--min-time SECONDS] [--eccentricity E] [--output FILE]
+//              [--large-batch auto|on|off|compare] [--huge-pages]
+//
+// The peak floating point rate and memory bandwidth are measured on startup
+// with an FMA loop and a STREAM-style triad, both single threaded to match the
+// solver. Each result reports the time per element, the memory traffic rate and
+// the nominal floating point rate, along with the fraction of the bandwidth and
+// of the attainable roofline performance that these represent. The results are
+// written as JSON that can be ingested by `tools/benchmark_results/collect.py`.
+//
+// By default, the streaming solver, with non-temporal stores and prefetching,
+// is used above the last level cache size (see kepler/kepler/memory.hpp), like
+// a caller choosing with `memory::is_large_batch` would. `--large-batch` forces
+// that mode on or off instead, and `compare` runs every size both ways to show
+// the difference in bandwidth. `--huge-pages` allocates the arrays with
+// `kepler::memory::huge_page_allocator`.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "./timing.hpp"
+#include "kepler/kepler.hpp"
+#include "xsimd/xsimd.hpp"
+
+namespace xs = xsimd;
+
+namespace {
+
+using kepler::benchmark::clock_type;
+using kepler::benchmark::seconds_since;
+using kepler::benchmark::time_per_call;
+
+// Nominal floating point operation counts for the pieces of each algorithm,
+// counting a fused multiply-add as two operations and the transcendental
+// functions by the size of the polynomials used to evaluate them. These are
+// only used to place the results on the roofline, so they are approximate.
+namespace flops {
+constexpr double reduction = 6;
+constexpr double sincos = 30;
+constexpr double cbrt = 20;
+constexpr double init = sincos + 4;
+constexpr double step[] = {0, 3, 6, 10};
+
+constexpr double noop = 0;
+constexpr double basic = 1;
+constexpr double mikkola = cbrt + 25;
+constexpr double markley = cbrt + 20;
+constexpr double raposo_pulido_brandt = 14;
+constexpr double fukushima = 20;
+constexpr double nijenhuis = 50;
+constexpr double contour16 = sincos + 14 * 22 + 8;
+}  // namespace flops
+
+struct options {
+  std::size_t max_size = 100000000;
+  double min_time = 0.1;
+  double eccentricity = 0.5;
+  std::string output;
+  std::string large_batch = "auto";
+  bool huge_pages = false;
+};
+
+struct machine {
+  double bandwidth;  // GB/s
+  double peak_float, peak_double;  // GFLOP/s
+};
+
+template <typename T>
+double measure_peak() {
+  using B = xs::batch<T>;
+  constexpr std::size_t num_chains = 16;
+  constexpr std::size_t num_steps = 1 << 22;
+  B acc[num_chains];
+  for (std::size_t i = 0; i < num_chains; ++i) acc[i] = B(T(1e-3) * T(i));
+  const B a(T(0.999999)), b(T(1e-7));
+  double best = 0;
+  for (int trial = 0; trial < 5; ++trial) {
+    auto start = clock_type::now();
+    for (std::size_t n = 0; n < num_steps; ++n) {
+      for (std::size_t i = 0; i < num_chains; ++i) acc[i] = xs::fma(acc[i], a, b);
+    }
+    double elapsed = seconds_since(start);
+    best = std::max(best, 2.0 * B::size * num_chains * num_steps / elapsed * 1e-9);
+  }
+  B sum(T(0));
+  for (std::size_t i = 0; i < num_chains; ++i) sum += acc[i];
+  volatile T sink = xs::reduce_add(sum);
+  (void)sink;
+  return best;
+}
+
+double measure_bandwidth() {
+  const std::size_t size = std::size_t(1) << 24;
+  std::vector<double> a(size, 0.0), b(size, 1.0), c(size, 2.0);
+  double best = 0;
+  for (int trial = 0; trial < 5; ++trial) {
+    auto start = clock_type::now();
+    for (std::size_t i = 0; i < size; ++i) a[i] = b[i] + 3.0 * c[i];
+    double elapsed = seconds_since(start);
+    best = std::max(best, 3.0 * sizeof(double) * size / elapsed * 1e-9);
+  }
+  volatile double sink = a[size / 2];
+  (void)sink;
+  return best;
+}
+
+// An array that is optionally backed by huge pages
+template <typename T>
+struct buffer {
+  std::vector<T> plain;
+  std::vector<T, kepler::memory::huge_page_allocator<T>> huge;
+
+  buffer(std::size_t size, bool huge_pages) {
+    if (huge_pages) {
+      huge.resize(size);
+    } else {
+      plain.resize(size);
+    }
+  }
+
+  T* data() { return plain.empty() ? huge.data() : plain.data(); }
+  T& operator[](std::size_t n) { return data()[n]; }
+};
+
+// The mean number of iterations taken by the iterative refiner, following the
+// same steps as the scalar solver
+template <int order, typename Starter, typename T>
+double mean_iterations(const Starter& starter, T eccentricity, buffer<T>& mean_anomaly,
+                       std::size_t size) {
+  const kepler::refiners::iterative<order, T> refiner;
+  std::size_t total = 0, count = std::min<std::size_t>(size, 10000);
+  for (std::size_t n = 0; n < count; ++n) {
+    T reduced;
+    kepler::reduction::range_reduce(std::abs(mean_anomaly[n]), reduced);
+    T ecc_anom = starter.start(reduced);
+    for (int i = 0; i < refiner.max_iterations; ++i, ++total) {
+      auto state = kepler::householder::init(eccentricity, reduced, ecc_anom);
+      if (std::abs(state.f0) < refiner.tolerance) break;
+      ecc_anom += kepler::householder::step<order>(state);
+    }
+  }
+  return double(total) / double(count);
+}
+
+template <typename T>
+struct context {
+  const options& opts;
+  const machine& mach;
+  const char* precision;
+  double peak;
+  buffer<T> mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly;
+  std::vector<std::string>& results;
+
+  context(const options& opts, const machine& mach, const char* precision, double peak,
+          std::vector<std::string>& results)
+      : opts(opts),
+        mach(mach),
+        precision(precision),
+        peak(peak),
+        mean_anomaly(opts.max_size, opts.huge_pages),
+        eccentric_anomaly(opts.max_size, opts.huge_pages),
+        sin_eccentric_anomaly(opts.max_size, opts.huge_pages),
+        cos_eccentric_anomaly(opts.max_size, opts.huge_pages),
+        results(results) {
+    // A low discrepancy sequence in [-50, 50], so that the small sizes sample
+    // the whole range too
+    for (std::size_t m = 0; m < opts.max_size; ++m) {
+      double x = double(m) * 0.6180339887498949;
+      mean_anomaly[m] = T(100. * (x - std::floor(x)) - 50.);
+    }
+  }
+};
+
+// The large batch modes to run
+std::vector<std::string> large_batch_modes(const std::string& mode) {
+  if (mode == "compare") return {"off", "on"};
+  return {mode};
+}
+
+// Whether a large batch mode uses the streaming solver for `bytes` of input
+// and output
+bool use_streaming(const std::string& mode, std::size_t bytes) {
+  if (mode == "auto") return kepler::memory::is_large_batch(bytes);
+  return mode == "on";
+}
+
+template <typename Starter, typename Refiner, typename Tag, typename T>
+double time_solver(context<T>& ctx, const Refiner& refiner, std::size_t size) {
+  const T eccentricity = T(ctx.opts.eccentricity);
+  return time_per_call(
+      [&] {
+        kepler::solver::solve_simd<Starter, Refiner, Tag>(
+            eccentricity, size, ctx.mean_anomaly.data(), ctx.eccentric_anomaly.data(),
+            ctx.sin_eccentric_anomaly.data(), ctx.cos_eccentric_anomaly.data(), refiner);
+      },
+      ctx.opts.min_time);
+}
+
+std::vector<std::size_t> sizes(std::size_t max_size) {
+  std::vector<std::size_t> result;
+  for (std::size_t decade = 1; decade <= max_size; decade *= 10) {
+    result.push_back(decade);
+    if (3 * decade <= max_size) result.push_back(3 * decade);
+    if (decade > max_size / 10) break;
+  }
+  if (result.back() != max_size) result.push_back(max_size);
+  return result;
+}
+
+template <typename Starter, typename Refiner, typename T>
+void sweep(context<T>& ctx, const char* starter_name, const char* refiner_name,
+           double refiner_flops, double starter_flops) {
+  const Refiner refiner;
+  const double flops_per_element = flops::reduction + starter_flops + refiner_flops;
+  const double bytes_per_element = 4.0 * sizeof(T);
+  const double attainable =
+      std::min(ctx.peak, flops_per_element / bytes_per_element * ctx.mach.bandwidth);
+
+  const auto modes = large_batch_modes(ctx.opts.large_batch);
+  for (std::size_t size : sizes(ctx.opts.max_size)) {
+    for (const auto& mode : modes) {
+      double seconds =
+          use_streaming(mode, std::size_t(bytes_per_element) * size)
+              ? time_solver<Starter, Refiner, kepler::memory::streaming_mode>(ctx, refiner, size)
+              : time_solver<Starter, Refiner, xs::unaligned_mode>(ctx, refiner, size);
+      double ns_per_element = seconds / double(size) * 1e9;
+      double gb_per_second = bytes_per_element / ns_per_element;
+      double gflops = flops_per_element / ns_per_element;
+
+      char buffer[1024];
+      std::snprintf(buffer, sizeof(buffer),
+                    "{\"starter\": \"%s\", \"refiner\": \"%s\", \"precision\": \"%s\", "
+                    "\"eccentricity\": %g, \"size\": %zu, \"large_batch\": \"%s\", "
+                    "\"huge_pages\": %s, \"ns_per_element\": %.6g, \"gb_per_second\": %.6g, "
+                    "\"gflops\": %.6g, \"flops_per_element\": %.6g, "
+                    "\"bytes_per_element\": %g, \"bandwidth_fraction\": %.6g, "
+                    "\"roofline_fraction\": %.6g}",
+                    starter_name, refiner_name, ctx.precision, ctx.opts.eccentricity, size,
+                    mode.c_str(), ctx.opts.huge_pages ? "true" : "false", ns_per_element,
+                    gb_per_second, gflops, flops_per_element, bytes_per_element,
+                    gb_per_second / ctx.mach.bandwidth, gflops / attainable);
+      ctx.results.push_back(buffer);
+      std::fprintf(stderr, "%s %s/%s n=%zu (large batch %s): %.3g ns/element, %.3g GB/s, "
+                   "%.3g GFLOP/s\n",
+                   ctx.precision, starter_name, refiner_name, size, mode.c_str(), ns_per_element,
+                   gb_per_second, gflops);
+    }
+  }
+}
+
+template <template <typename> class Starter, typename T>
+void sweep_starter(context<T>& ctx, const char* name, double starter_flops) {
+  using namespace kepler::refiners;
+  const Starter<T> starter(T(ctx.opts.eccentricity));
+  const T e = T(ctx.opts.eccentricity);
+  const std::size_t n = ctx.opts.max_size;
+
+  sweep<Starter<T>, noop<T>>(ctx, name, "noop", flops::sincos, starter_flops);
+  sweep<Starter<T>, iterative<1, T>>(
+      ctx, name, "iterative1",
+      mean_iterations<1>(starter, e, ctx.mean_anomaly, n) * (flops::init + flops::step[1] + 1) +
+          flops::init + flops::sincos,
+      starter_flops);
+  sweep<Starter<T>, iterative<3, T>>(
+      ctx, name, "iterative3",
+      mean_iterations<3>(starter, e, ctx.mean_anomaly, n) * (flops::init + flops::step[3] + 1) +
+          flops::init + flops::sincos,
+      starter_flops);
+  sweep<Starter<T>, non_iterative<3, T>>(ctx, name, "non_iterative3",
+                                         flops::init + flops::step[3] + 1 + flops::sincos,
+                                         starter_flops);
+  sweep<Starter<T>, brandt<T>>(ctx, name, "brandt",
+                               flops::init + flops::step[e < T(0.78) ? 2 : 3] + 1 + flops::sincos,
+                               starter_flops);
+}
+
+template <typename T>
+void sweep_all(context<T>& ctx) {
+  using namespace kepler::starters;
+  sweep_starter<noop>(ctx, "noop", flops::noop);
+  sweep_starter<basic>(ctx, "basic", flops::basic);
+  sweep_starter<mikkola>(ctx, "mikkola", flops::mikkola);
+  sweep_starter<markley>(ctx, "markley", flops::markley);
+  sweep_starter<raposo_pulido_brandt>(ctx, "raposo_pulido_brandt", flops::raposo_pulido_brandt);
+  sweep_starter<fukushima>(ctx, "fukushima", flops::fukushima);
+  sweep_starter<nijenhuis>(ctx, "nijenhuis", flops::nijenhuis);
+  sweep_starter<contour16>(ctx, "contour16", flops::contour16);
+}
+
+void usage() {
+  std::cerr << "usage: sweep [--max-size N] [--min-time SECONDS] [--eccentricity E] "
+               "[--output FILE]\n"
+               "             [--large-batch auto|on|off|compare] [--huge-pages]"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--max-size") {
+      opts.max_size = std::strtoull(argv[++i], nullptr, 10);
+    } else if (i + 1 < argc && arg == "--min-time") {
+      opts.min_time = std::atof(argv[++i]);
+    } else if (i + 1 < argc && arg == "--eccentricity") {
+      opts.eccentricity = std::atof(argv[++i]);
+    } else if (i + 1 < argc && arg == "--output") {
+      opts.output = argv[++i];
+    } else if (i + 1 < argc && arg == "--large-batch") {
+      opts.large_batch = argv[++i];
+    } else if (arg == "--huge-pages") {
+      opts.huge_pages = true;
+    } else {
+      usage();
+      return arg == "-h" || arg == "--help" ? 0 : 1;
+    }
+  }
+  if (opts.max_size == 0 || !(opts.eccentricity >= 0 && opts.eccentricity < 1) ||
+      (opts.large_batch != "auto" && opts.large_batch != "on" && opts.large_batch != "off" &&
+       opts.large_batch != "compare")) {
+    usage();
+    return 1;
+  }
+
+  machine mach;
+  mach.bandwidth = measure_bandwidth();
+  mach.peak_float = measure_peak<float>();
+  mach.peak_double = measure_peak<double>();
+  std::fprintf(stderr, "bandwidth: %.3g GB/s; peak: %.3g GFLOP/s (float), %.3g GFLOP/s (double)\n",
+               mach.bandwidth, mach.peak_float, mach.peak_double);
+
+  std::vector<std::string> results;
+  {
+    context<float> ctx(opts, mach, "float", mach.peak_float, results);
+    sweep_all(ctx);
+  }
+  {
+    context<double> ctx(opts, mach, "double", mach.peak_double, results);
+    sweep_all(ctx);
+  }
+
+  std::ofstream file;
+  if (!opts.output.empty()) file.open(opts.output);
+  std::ostream& out = opts.output.empty() ? std::cout : file;
+  out << "{\n  \"type\": \"sweep\",\n  \"machine\": {\"arch\": \"" << xs::default_arch::name()
+      << "\", \"simd_size_float\": " << xs::batch<float>::size
+      << ", \"simd_size_double\": " << xs::batch<double>::size
+      << ", \"bandwidth\": " << mach.bandwidth << ", \"peak_float\": " << mach.peak_float
+      << ", \"peak_double\": " << mach.peak_double
+      << ", \"large_batch_threshold\": " << kepler::memory::large_batch_threshold()
+      << "},\n  \"results\": [\n";
+  for (std::size_t n = 0; n < results.size(); ++n) {
+    out << "    " << results[n] << (n + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  return out ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#ifndef KEPLER_BENCHMARK_TIMING_HPP
+#define KEPLER_BENCHMARK_TIMING_HPP
+
+// Wall clock timing for the standalone benchmark drivers (sweep, pareto and
+// isa), which don't use the Catch2 benchmark runner.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace kepler {
+namespace benchmark {
+
+using clock_type = std::chrono::steady_clock;
+
+inline double seconds_since(clock_type::time_point start) {
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// Time `func` by repeating it until at least `min_time` seconds have passed,
+// returning the time per call in seconds
+template <typename F>
+double time_per_call(F&& func, double min_time) {
+  func();
+  std::size_t reps = 1;
+  for (;;) {
+    auto start = clock_type::now();
+    for (std::size_t n = 0; n < reps; ++n) func();
+    double elapsed = seconds_since(start);
+    if (elapsed >= min_time) return elapsed / double(reps);
+    double scale = elapsed > 0 ? 1.2 * min_time / elapsed : 10.0;
+    reps = std::max(2 * reps, std::size_t(double(reps) * scale));
+  }
+}
+
+}  // namespace benchmark
+}  // namespace kepler
+
+#endif
@@ -20,6 +20,112 @@ void kepler_solvef(size_t size, const float* eccentricity, size_t batch_size,
                    const float* mean_anomaly, float* eccentric_anomaly,
                    float* sin_eccentric_anomaly, float* cos_eccentric_anomaly);
 
+// Streaming solvers for a fixed eccentricity; see kepler::Solver. The create
+// functions return NULL if the allocation fails.
+typedef struct kepler_solver kepler_solver;
+typedef struct kepler_solverf kepler_solverf;
+
+typedef struct kepler_solver_stats {
+  size_t chunks;
+  size_t elements;
+  size_t batches;
+} kepler_solver_stats;
+
+kepler_solver* kepler_solver_create(double eccentricity);
+void kepler_solver_reset(kepler_solver* solver, double eccentricity);
+void kepler_solver_push(kepler_solver* solver, size_t size, const double* mean_anomaly,
+                        double* eccentric_anomaly, double* sin_eccentric_anomaly,
+                        double* cos_eccentric_anomaly);
+void kepler_solver_get_stats(const kepler_solver* solver, kepler_solver_stats* stats);
+void kepler_solver_destroy(kepler_solver* solver);
+
+kepler_solverf* kepler_solverf_create(float eccentricity);
+void kepler_solverf_reset(kepler_solverf* solver, float eccentricity);
+void kepler_solverf_push(kepler_solverf* solver, size_t size, const float* mean_anomaly,
+                         float* eccentric_anomaly, float* sin_eccentric_anomaly,
+                         float* cos_eccentric_anomaly);
+void kepler_solverf_get_stats(const kepler_solverf* solver, kepler_solver_stats* stats);
+void kepler_solverf_destroy(kepler_solverf* solver);
+
+// Plans select the solver algorithm at runtime. All of the setup, including
+// choosing the implementation and starting the worker threads, happens in
+// kepler_plan_create, which returns NULL if the configuration is invalid. The
+// `order` argument sets the order of the Householder steps for the iterative
+// and non-iterative refiners (1, 2 or 3), and is ignored otherwise. The
+// `tolerance` is only used by the iterative refiner, and a non-positive value
+// selects the default. Setting `num_threads` to 0 uses the hardware
+// concurrency. Executing a plan returns KEPLER_ERROR_WRONG_PRECISION if the
+// plan was created for the other precision, and KEPLER_ERROR_INVALID_ARGUMENT
+// if the plan is NULL, or if any of the arrays is NULL for a non-empty input.
+typedef enum kepler_starter {
+  KEPLER_STARTER_NOOP = 0,
+  KEPLER_STARTER_BASIC = 1,
+  KEPLER_STARTER_MIKKOLA = 2,
+  KEPLER_STARTER_MARKLEY = 3,
+  KEPLER_STARTER_RAPOSO_PULIDO_BRANDT = 4,
+  KEPLER_STARTER_FUKUSHIMA = 5,
+  KEPLER_STARTER_NIJENHUIS = 6,
+  KEPLER_STARTER_CONTOUR = 7
+} kepler_starter;
+
+typedef enum kepler_refiner {
+  KEPLER_REFINER_NOOP = 0,
+  KEPLER_REFINER_ITERATIVE = 1,
+  KEPLER_REFINER_NON_ITERATIVE = 2,
+  KEPLER_REFINER_BRANDT = 3
+} kepler_refiner;
+
+typedef enum kepler_precision {
+  KEPLER_PRECISION_DOUBLE = 0,
+  KEPLER_PRECISION_FLOAT = 1
+} kepler_precision;
+
+typedef enum kepler_status {
+  KEPLER_SUCCESS = 0,
+  KEPLER_ERROR_INVALID_ARGUMENT = 1,
+  KEPLER_ERROR_WRONG_PRECISION = 2
+} kepler_status;
+
+typedef struct kepler_plan kepler_plan;
+
+kepler_plan* kepler_plan_create(kepler_starter starter, kepler_refiner refiner, int order,
+                                kepler_precision precision, double tolerance,
+                                size_t num_threads);
+kepler_status kepler_plan_execute(const kepler_plan* plan, size_t size,
+                                  const double* eccentricity, size_t batch_size,
+                                  const double* mean_anomaly, double* eccentric_anomaly,
+                                  double* sin_eccentric_anomaly, double* cos_eccentric_anomaly);
+kepler_status kepler_plan_executef(const kepler_plan* plan, size_t size,
+                                   const float* eccentricity, size_t batch_size,
+                                   const float* mean_anomaly, float* eccentric_anomaly,
+                                   float* sin_eccentric_anomaly, float* cos_eccentric_anomaly);
+void kepler_plan_destroy(kepler_plan* plan);
+
+// Solver instrumentation; see kepler::stats::convergence. The counts are only
+// collected when the library is built with KEPLER_ENABLE_STATS, and are
+// otherwise always zero. The counters are shared by all solvers and threads,
+// and accumulate until kepler_stats_reset is called.
+#define KEPLER_NUM_RESIDUAL_BINS 16
+
+typedef struct kepler_convergence_stats {
+  size_t calls;
+  size_t elements;
+  size_t iterations;
+  size_t max_iterations_reached;
+  size_t iteration_batches;
+  size_t singular;
+  size_t singular_mixed_batches;
+  size_t brandt_second_order;
+  size_t brandt_third_order;
+  size_t brandt_mixed_batches;
+  size_t non_finite;
+  size_t residual_histogram[KEPLER_NUM_RESIDUAL_BINS];
+} kepler_convergence_stats;
+
+int kepler_stats_enabled(void);
+void kepler_stats_get(kepler_convergence_stats* stats);
+void kepler_stats_reset(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,9 +9,20 @@
 
 #include <cstdint>
 
+#include "kepler/kepler/astrometry.hpp"
+#include "kepler/kepler/compact.hpp"
+#include "kepler/kepler/cordic.hpp"
+#include "kepler/kepler/double_double.hpp"
+#include "kepler/kepler/ensemble.hpp"
+#include "kepler/kepler/memory.hpp"
+#include "kepler/kepler/partition.hpp"
 #include "kepler/kepler/refiners.hpp"
 #include "kepler/kepler/solver.hpp"
 #include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/stats.hpp"
+#include "kepler/kepler/stream.hpp"
+#include "kepler/kepler/tabulated.hpp"
+#include "kepler/kepler/transit.hpp"
 
 namespace kepler {
 
@@ -29,5 +40,22 @@ void solve(std::size_t size, const T* eccentricity, std::size_t batch_size, cons
   }
 }
 
+// Solve for mean anomalies given as an unsigned fixed-point fraction of a full
+// orbit, M = 2 pi phase / 2^N where N is the number of bits in `U`. This skips
+// floating point range reduction entirely and returns E in [0, 2 pi].
+template <typename T, typename U>
+void solve_phase(std::size_t size, const T* eccentricity, std::size_t batch_size, const U* phase,
+                 T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  for (std::size_t n = 0; n < size; ++n) {
+    solver::solve_phase_simd<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+        eccentricity[n], batch_size, phase, eccentric_anomaly, sin_eccentric_anomaly,
+        cos_eccentric_anomaly);
+    phase += batch_size;
+    eccentric_anomaly += batch_size;
+    sin_eccentric_anomaly += batch_size;
+    cos_eccentric_anomaly += batch_size;
+  }
+}
+
 }  // namespace kepler
 #endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+#ifndef KEPLER_ASTROMETRY_HPP
+#define KEPLER_ASTROMETRY_HPP
+
+#include <cmath>
+#include <cstddef>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/math.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "xsimd/xsimd.hpp"
+
+namespace kepler {
+namespace astrometry {
+
+namespace xs = xsimd;
+
+// Structure of arrays of the Thiele-Innes constants, one element per orbit.
+// The projected offsets of the orbit are
+//
+//   x = A X + F Y,  y = B X + G Y,
+//
+// where X = cos E - e and Y = sqrt(1 - e^2) sin E.
+template <typename T>
+struct thiele_innes {
+  const T* A;
+  const T* B;
+  const T* F;
+  const T* G;
+};
+
+namespace detail {
+
+// The Thiele-Innes projection of a single orbit, with sqrt(1 - e^2) folded into
+// F and G, the eccentricity offset folded into a constant term, and the whole
+// thing scaled by `scale` (the parallax, for constants in physical units).
+template <typename T>
+struct projection {
+  T A, B, F, G, x0, y0;
+
+  projection(const T& eccentricity, const T& A_, const T& B_, const T& F_, const T& G_,
+             const T& scale) {
+    const T beta = std::sqrt((T(1) - eccentricity) * (T(1) + eccentricity));
+    A = scale * A_;
+    B = scale * B_;
+    F = scale * beta * F_;
+    G = scale * beta * G_;
+    x0 = -A * eccentricity;
+    y0 = -B * eccentricity;
+  }
+
+  template <typename V>
+  inline void operator()(const V& sin_eccentric_anomaly, const V& cos_eccentric_anomaly, V& x,
+                         V& y) const {
+    x = math::fma(V(A), cos_eccentric_anomaly, math::fma(V(F), sin_eccentric_anomaly, V(x0)));
+    y = math::fma(V(B), cos_eccentric_anomaly, math::fma(V(G), sin_eccentric_anomaly, V(y0)));
+  }
+};
+
+// The offsets are computed directly from the sine and cosine returned by the
+// solver, while they are still in registers
+template <typename Tag, typename T, typename Kernel>
+inline void solve_offsets(const Kernel& kernel, const projection<T>& proj, std::size_t size,
+                          const T* mean_anomaly, T* x, T* y) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    auto mean_anom = xs::load(&(mean_anomaly[i]), Tag());
+    B ecc_anom, sin_ecc_anom, cos_ecc_anom, x_, y_;
+    solver::detail::solve_batch(kernel, mean_anom, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    proj(sin_ecc_anom, cos_ecc_anom, x_, y_);
+    x_.store(&x[i], Tag());
+    y_.store(&y[i], Tag());
+  }
+
+  for (std::size_t i = vec_size; i < size; ++i) {
+    T ecc_anom, sin_ecc_anom, cos_ecc_anom;
+    solver::detail::solve_one(kernel, mean_anomaly[i], ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    proj(sin_ecc_anom, cos_ecc_anom, x[i], y[i]);
+  }
+}
+
+template <typename Tag, typename T, typename Kernel>
+inline void solve_along_scan(const Kernel& kernel, const projection<T>& proj, std::size_t size,
+                             const T* mean_anomaly, const T* sin_scan_angle,
+                             const T* cos_scan_angle, T* delta) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    auto mean_anom = xs::load(&(mean_anomaly[i]), Tag());
+    B ecc_anom, sin_ecc_anom, cos_ecc_anom, x, y;
+    solver::detail::solve_batch(kernel, mean_anom, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    proj(sin_ecc_anom, cos_ecc_anom, x, y);
+    auto sin_psi = xs::load(&(sin_scan_angle[i]), Tag());
+    auto cos_psi = xs::load(&(cos_scan_angle[i]), Tag());
+    math::fma(x, sin_psi, y * cos_psi).store(&delta[i], Tag());
+  }
+
+  for (std::size_t i = vec_size; i < size; ++i) {
+    T ecc_anom, sin_ecc_anom, cos_ecc_anom, x, y;
+    solver::detail::solve_one(kernel, mean_anomaly[i], ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    proj(sin_ecc_anom, cos_ecc_anom, x, y);
+    delta[i] = math::fma(x, sin_scan_angle[i], y * cos_scan_angle[i]);
+  }
+}
+
+}  // namespace detail
+
+// Compute the projected offsets (x, y) for `num_orbits` orbits, each at
+// `num_epochs` mean anomalies. Like `kepler::solve`, the mean anomalies and the
+// outputs are stored with shape (num_orbits, num_epochs), and the starter is
+// only set up once per orbit.
+template <typename T, typename Starter = starters::raposo_pulido_brandt<T>,
+          typename Refiner = refiners::brandt<T>, typename Tag = xs::unaligned_mode>
+inline void solve(std::size_t num_orbits, const T* eccentricity,
+                  const thiele_innes<T>& elements, std::size_t num_epochs,
+                  const T* mean_anomaly, T* x, T* y, const Refiner& refiner = Refiner()) {
+  for (std::size_t n = 0; n < num_orbits; ++n) {
+    const detail::projection<T> proj(eccentricity[n], elements.A[n], elements.B[n],
+                                     elements.F[n], elements.G[n], T(1));
+    const std::size_t offset = n * num_epochs;
+    solver::detail::with_kernel<Starter>(eccentricity[n], refiner, [&](const auto& kernel) {
+      detail::solve_offsets<Tag>(kernel, proj, num_epochs, &(mean_anomaly[offset]),
+                                 &(x[offset]), &(y[offset]));
+    });
+  }
+}
+
+// Compute the along-scan offsets
+//
+//   delta = parallax * (x sin(psi) + y cos(psi))
+//
+// where psi is the scan angle at each epoch, shared by all orbits, as used for
+// fitting Gaia-style epoch astrometry. If the Thiele-Innes constants are in
+// angular units, `parallax` can be null.
+template <typename T, typename Starter = starters::raposo_pulido_brandt<T>,
+          typename Refiner = refiners::brandt<T>, typename Tag = xs::unaligned_mode>
+inline void solve_along_scan(std::size_t num_orbits, const T* eccentricity,
+                             const thiele_innes<T>& elements, const T* parallax,
+                             std::size_t num_epochs, const T* mean_anomaly,
+                             const T* sin_scan_angle, const T* cos_scan_angle, T* delta,
+                             const Refiner& refiner = Refiner()) {
+  for (std::size_t n = 0; n < num_orbits; ++n) {
+    const detail::projection<T> proj(eccentricity[n], elements.A[n], elements.B[n],
+                                     elements.F[n], elements.G[n],
+                                     parallax == nullptr ? T(1) : parallax[n]);
+    const std::size_t offset = n * num_epochs;
+    solver::detail::with_kernel<Starter>(eccentricity[n], refiner, [&](const auto& kernel) {
+      detail::solve_along_scan<Tag>(kernel, proj, num_epochs, &(mean_anomaly[offset]),
+                                    sin_scan_angle, cos_scan_angle, &(delta[offset]));
+    });
+  }
+}
+
+}  // namespace astrometry
+}  // namespace kepler
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef KEPLER_COMPACT_HPP
+#define KEPLER_COMPACT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/householder.hpp"
+#include "kepler/kepler/math.hpp"
+#include "kepler/kepler/reduction.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/stats.hpp"
+#include "xsimd/xsimd.hpp"
+
+// A compacting SIMD solver for `refiners::iterative`. The batch version of the
+// iterative refiner keeps stepping until every lane has converged, so a single
+// slow lane, near e = 1 and M = 0, holds the whole batch for up to
+// `max_iterations` steps. Instead, the unconverged elements are held in a fixed
+// work area of `num_slots` batches, in the reduced frame, along with the
+// Householder state at their current estimate. Each pass takes up to
+// `pass_iterations` steps on every batch, checking for convergence after each
+// step. The elements that are done are then written out, the rest are packed
+// down to the front of the work area, and the free slots are refilled from the
+// input, so every step is taken on full batches of unconverged elements until
+// the input runs out.
+
+namespace kepler {
+namespace compact {
+
+namespace xs = xsimd;
+
+// The number of steps taken on each batch before it is compacted
+constexpr int pass_iterations = 1;
+
+// The number of batches in the work area
+constexpr std::size_t num_slots = 8;
+
+namespace detail {
+
+// The elements in flight, as a structure of arrays, packed into the first
+// `size` lanes. The solution is unfolded from the reduced frame using
+// E = offset + sign * E_reduced and sin(E) = sign * sin(E_reduced). The number
+// of steps taken on each element is kept as a T, so that it can be compared
+// with the budget in a batch.
+template <typename T, typename A>
+struct slots {
+  static constexpr std::size_t capacity = num_slots * xs::batch<T, A>::size;
+
+  std::size_t size = 0;
+  std::size_t index[capacity];
+  alignas(A::alignment()) T mean_anomaly[capacity];
+  alignas(A::alignment()) T eccentric_anomaly[capacity];
+  alignas(A::alignment()) T sign[capacity];
+  alignas(A::alignment()) T offset[capacity];
+  alignas(A::alignment()) T steps[capacity];
+  alignas(A::alignment()) T f0[capacity];
+  alignas(A::alignment()) T ecc_sin[capacity];
+  alignas(A::alignment()) T ecc_cos[capacity];
+
+  // Copy the last element into the rest of its batch, so that the work area
+  // can be loaded in full batches; the padding lanes are never written out
+  void pad() {
+    constexpr std::size_t simd_size = xs::batch<T, A>::size;
+    std::size_t padded = (size + simd_size - 1) / simd_size * simd_size;
+    for (std::size_t k = size; k < padded; ++k) {
+      index[k] = index[size - 1];
+      mean_anomaly[k] = mean_anomaly[size - 1];
+      eccentric_anomaly[k] = eccentric_anomaly[size - 1];
+      sign[k] = sign[size - 1];
+      offset[k] = offset[size - 1];
+      steps[k] = steps[size - 1];
+      f0[k] = f0[size - 1];
+      ecc_sin[k] = ecc_sin[size - 1];
+      ecc_cos[k] = ecc_cos[size - 1];
+    }
+  }
+};
+
+// Write out the elements of the batch at slot `j` that are done, and move the
+// rest down to slot `kept`, given their updated estimates and states. The
+// kept elements stay in order, and `kept` never passes `j + k`, so nothing is
+// overwritten before it has been read. Returns the new number of kept
+// elements.
+template <typename T, typename A>
+inline std::size_t retire(const T& eccentricity, slots<T, A>& work, std::size_t j,
+                          std::size_t count, std::size_t kept,
+                          const xs::batch<T, A>& ecc_anom, const xs::batch<T, A>& steps,
+                          const householder::detail::state<xs::batch<T, A>>& state,
+                          const typename xs::batch<T, A>::batch_bool_type& done,
+                          T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                          T* cos_eccentric_anomaly) {
+  using B = xs::batch<T, A>;
+  constexpr std::size_t simd_size = B::size;
+
+  // Nothing is done and nothing has moved, so the batch stays where it is
+  if (kept == j && xs::none(done)) {
+    ecc_anom.store_unaligned(&work.eccentric_anomaly[j]);
+    steps.store_unaligned(&work.steps[j]);
+    state.f0.store_unaligned(&work.f0[j]);
+    state.ecc_sin.store_unaligned(&work.ecc_sin[j]);
+    state.ecc_cos.store_unaligned(&work.ecc_cos[j]);
+    return kept + count;
+  }
+
+  // The sine and cosine are recovered from the state, as in `brandt`
+  const B sin_ecc_anom = state.ecc_sin / B(eccentricity);
+  const B cos_ecc_anom = state.ecc_cos / B(eccentricity);
+
+  // Everything is done and contiguous in the output, so the results can be
+  // stored directly
+  const std::size_t first = work.index[j];
+  if (count == simd_size && xs::all(done) && work.index[j + count - 1] - first == count - 1) {
+    const B sign = B::load_unaligned(&work.sign[j]);
+    stats::record_solution(eccentricity, B::load_unaligned(&work.mean_anomaly[j]), ecc_anom,
+                           sin_ecc_anom, cos_ecc_anom);
+    xs::fma(sign, ecc_anom, B::load_unaligned(&work.offset[j]))
+        .store_unaligned(&eccentric_anomaly[first]);
+    (sign * sin_ecc_anom).store_unaligned(&sin_eccentric_anomaly[first]);
+    cos_ecc_anom.store_unaligned(&cos_eccentric_anomaly[first]);
+    return kept;
+  }
+
+  alignas(A::alignment()) T E[simd_size], s[simd_size], c[simd_size], st[simd_size],
+      f[simd_size], es[simd_size], ec[simd_size];
+  ecc_anom.store_aligned(E);
+  sin_ecc_anom.store_aligned(s);
+  cos_ecc_anom.store_aligned(c);
+  steps.store_aligned(st);
+  state.f0.store_aligned(f);
+  state.ecc_sin.store_aligned(es);
+  state.ecc_cos.store_aligned(ec);
+  std::uint64_t mask = done.mask();
+  for (std::size_t k = 0; k < count; ++k) {
+    const std::size_t i = j + k;
+    if ((mask >> k) & 1) {
+      stats::record_solution(eccentricity, work.mean_anomaly[i], E[k], s[k], c[k]);
+      eccentric_anomaly[work.index[i]] = math::fma(work.sign[i], E[k], work.offset[i]);
+      sin_eccentric_anomaly[work.index[i]] = work.sign[i] * s[k];
+      cos_eccentric_anomaly[work.index[i]] = c[k];
+    } else {
+      work.index[kept] = work.index[i];
+      work.mean_anomaly[kept] = work.mean_anomaly[i];
+      work.eccentric_anomaly[kept] = E[k];
+      work.sign[kept] = work.sign[i];
+      work.offset[kept] = work.offset[i];
+      work.steps[kept] = st[k];
+      work.f0[kept] = f[k];
+      work.ecc_sin[kept] = es[k];
+      work.ecc_cos[kept] = ec[k];
+      ++kept;
+    }
+  }
+  return kept;
+}
+
+// Reduce and start the `count` elements from `first`, at most a batch, write
+// out the ones that are already done, and append the rest to the work area
+template <typename Starter, int order, typename T, typename A>
+inline void fill(const T& eccentricity, const Starter& starter,
+                 const refiners::iterative<order, T>& refiner, const T* mean_anomaly,
+                 std::size_t first, std::size_t count, slots<T, A>& work,
+                 T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  using B = xs::batch<T, A>;
+  constexpr std::size_t simd_size = B::size;
+  stats::lanes scope(count);
+  B mean_anom;
+  if (count == simd_size) {
+    mean_anom = B::load_unaligned(&mean_anomaly[first]);
+  } else {
+    alignas(A::alignment()) T buffer[simd_size];
+    for (std::size_t k = 0; k < simd_size; ++k) {
+      buffer[k] = mean_anomaly[first + std::min(k, count - 1)];
+    }
+    mean_anom = B::load_aligned(buffer);
+  }
+
+  auto sgn = xs::copysign(B(T(1.)), mean_anom);
+  B mean_anom_reduc;
+  auto high = reduction::range_reduce(xs::abs(mean_anom), mean_anom_reduc);
+  const std::size_t j = work.size;
+  mean_anom_reduc.store_unaligned(&work.mean_anomaly[j]);
+  xs::select(high, -sgn, sgn).store_unaligned(&work.sign[j]);
+  xs::select(high, constants::twopi<T>() * sgn, B(T(0.))).store_unaligned(&work.offset[j]);
+  for (std::size_t k = 0; k < count; ++k) work.index[j + k] = first + k;
+
+  const B ecc_anom = starter.start(mean_anom_reduc);
+  const B steps(T(0.));
+  auto state = householder::init(eccentricity, mean_anom_reduc, ecc_anom);
+  auto exhausted = steps >= B(T(refiner.max_iterations));
+  auto done = exhausted | (xs::abs(state.f0) < B(refiner.tolerance));
+  stats::record_max_iterations(exhausted);
+  work.size = retire(eccentricity, work, j, count, j, ecc_anom, steps, state, done,
+                     eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+// Take up to `pass_iterations` steps on the `count` elements in the batch at
+// slot `j`, none of which are done, then retire the batch. This takes the same
+// steps as `refiners::iterative`, so the results match.
+template <int order, typename T, typename A>
+inline std::size_t iterate(const T& eccentricity, const refiners::iterative<order, T>& refiner,
+                           slots<T, A>& work, std::size_t j, std::size_t count,
+                           std::size_t kept, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                           T* cos_eccentric_anomaly) {
+  using B = xs::batch<T, A>;
+  stats::lanes scope(count);
+  const B mean_anom = B::load_aligned(&work.mean_anomaly[j]);
+  B ecc_anom = B::load_aligned(&work.eccentric_anomaly[j]);
+  B steps = B::load_aligned(&work.steps[j]);
+  householder::detail::state<B> state{B::load_aligned(&work.f0[j]),
+                                      B::load_aligned(&work.ecc_sin[j]),
+                                      B::load_aligned(&work.ecc_cos[j])};
+  const B max_steps(T(refiner.max_iterations));
+
+  typename B::batch_bool_type done(false), exhausted(false);
+  for (int n = 0; n < pass_iterations; ++n) {
+    stats::record_iterations(!done);
+    stats::record_iteration_batch();
+    auto delta = householder::step<order>(state);
+    ecc_anom = xs::select(done, ecc_anom, ecc_anom + delta);
+    steps = xs::select(done, steps, steps + B(T(1.)));
+    state = householder::init(eccentricity, mean_anom, ecc_anom);
+    exhausted = steps >= max_steps;
+    done = done | exhausted | (xs::abs(state.f0) < B(refiner.tolerance));
+    if (xs::all(done)) break;
+  }
+
+  // An element that used up the budget is counted even if its last step
+  // converged, as in `refiners::iterative`
+  stats::record_max_iterations(exhausted);
+  return retire(eccentricity, work, j, count, kept, ecc_anom, steps, state, done,
+                eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+// The series kernel at low eccentricity doesn't iterate, so there is nothing
+// to compact
+template <typename T>
+inline void solve(const solver::detail::low_eccentricity_kernel<T>& kernel, std::size_t size,
+                  const T* mean_anomaly, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                  T* cos_eccentric_anomaly) {
+  solver::detail::solve_simd<xs::unaligned_mode>(kernel, size, mean_anomaly, eccentric_anomaly,
+                                                 sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+template <typename Starter, int order, typename T>
+inline void solve(
+    const solver::detail::starter_refiner_kernel<Starter, refiners::iterative<order, T>>& kernel,
+    std::size_t size, const T* mean_anomaly, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+    T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  using A = typename B::arch_type;
+  constexpr std::size_t simd_size = B::size;
+
+  slots<T, A> work;
+  std::size_t next = 0;
+  while (true) {
+    while (next < size && work.size + simd_size <= work.capacity) {
+      std::size_t count = std::min(simd_size, size - next);
+      fill(kernel.eccentricity, kernel.starter, kernel.refiner, mean_anomaly, next, count, work,
+           eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+      next += count;
+    }
+    if (work.size == 0) break;
+
+    work.pad();
+    std::size_t kept = 0;
+    for (std::size_t j = 0; j < work.size; j += simd_size) {
+      kept = iterate(kernel.eccentricity, kernel.refiner, work, j,
+                     std::min(simd_size, work.size - j), kept, eccentric_anomaly,
+                     sin_eccentric_anomaly, cos_eccentric_anomaly);
+    }
+    work.size = kept;
+  }
+}
+
+}  // namespace detail
+
+// Solve Kepler's equation with `refiners::iterative`, compacting the
+// unconverged elements after every `pass_iterations` steps. The results match
+// `solver::solve_simd` with the same starter and refiner, to within the
+// refiner's tolerance.
+template <typename Starter, typename Refiner>
+inline void solve(const typename solver::value_type<Starter, Refiner>::type& eccentricity,
+                  std::size_t size,
+                  const typename solver::value_type<Starter, Refiner>::type* mean_anomaly,
+                  typename solver::value_type<Starter, Refiner>::type* eccentric_anomaly,
+                  typename solver::value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+                  typename solver::value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+                  const Refiner& refiner = Refiner()) {
+  stats::record_call(size);
+  solver::detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                  cos_eccentric_anomaly);
+  });
+}
+
+}  // namespace compact
+}  // namespace kepler
+
+#endif
@@ -41,6 +41,7 @@ KEPLER_DEFINE_CONSTANT(elevenpio12, 0x40384e88, 0x400709d10d3e7eab)
 // Limits for range reduction
 KEPLER_DEFINE_CONSTANT(twentypi, 0x427b53d1, 0x404f6a7a2955385e)
 KEPLER_DEFINE_CONSTANT(twoopi, 0x3f22f983, 0x3fe45f306dc9c883)
+KEPLER_DEFINE_CONSTANT(oneotwopi, 0x3e22f983, 0x3fc45f306dc9c883)
 KEPLER_DEFINE_CONSTANT(mediumpi, 0x43490fdb, 0x412921fb54442d18)
 
 KEPLER_DEFINE_CONSTANT(range_max, 0x4b800000, 0x4340000000000000)
@@ -53,9 +54,16 @@ KEPLER_DEFINE_CONSTANT(pio2_2t, 0x2e85a308, 0x3ba3198a2e037073)
 KEPLER_DEFINE_CONSTANT(pio2_3, 0x2e85a300, 0x3ba3198a2e000000)
 KEPLER_DEFINE_CONSTANT(pio2_3t, 0x248d3132, 0x397b839a252049c1)
 
+// The error in the working precision value of pi/2
+KEPLER_DEFINE_CONSTANT(pio2_lo, 0xb33bbd2e, 0x3c91a62633145c07)
+
 KEPLER_DEFINE_CONSTANT(sixth, 0x3e2aaaab, 0x3fc5555555555555)
 KEPLER_DEFINE_CONSTANT(twentieth, 0x3d4ccccd, 0x3fa999999999999a)
 
+// Below this eccentricity, the third order series solution is exact to working
+// precision
+KEPLER_DEFINE_CONSTANT(low_eccentricity, 0x3a83126f, 0x3f1a36e2eb1c432d)
+
 // Algorithm-specific constants
 KEPLER_DEFINE_CONSTANT(markley_factor1, 0x40f4da39, 0x401e9b471164c596)
 KEPLER_DEFINE_CONSTANT(markley_factor2, 0x3fa6450f, 0x3ff4c8a1d518acbd)
@@ -0,0 +1,132 @@
+#ifndef KEPLER_CORDIC_HPP
+#define KEPLER_CORDIC_HPP
+
+#include <cmath>
+#include <cstddef>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/math.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "xsimd/xsimd.hpp"
+
+// A CORDIC-like solver following Zechmeister (2018). Starting from E = pi/2,
+// each iteration rotates E by +/- pi / 2^(n + 2), with the sign chosen so
+// that E - e sin(E) moves towards M, and the sine and cosine of E are updated
+// by the same rotation using precomputed tables. This is a bisection, so each
+// iteration gains one bit of precision, and it only needs additions and
+// multiplications: no transcendental functions or divisions are evaluated per
+// element, and the cost is independent of the eccentricity and mean anomaly.
+// The sine and cosine are returned directly from the rotation accumulators.
+//
+// https://ui.adsabs.harvard.edu/abs/2018A%26A...619A.128Z/abstract
+
+namespace kepler {
+namespace cordic {
+
+namespace xs = xsimd;
+
+// The number of iterations needed to reach the precision of T
+template <typename T>
+struct default_iterations;
+
+template <>
+struct default_iterations<float> {
+  static constexpr int value = 24;
+};
+
+template <>
+struct default_iterations<double> {
+  static constexpr int value = 52;
+};
+
+namespace detail {
+
+// The rotation angles and their sines and cosines, computed once in long
+// double precision
+template <typename T, int num_iterations>
+struct tables {
+  T angle[num_iterations], sin_angle[num_iterations], cos_angle[num_iterations];
+
+  tables() {
+    long double alpha = 3.141592653589793238462643383279502884L / 4;
+    for (int n = 0; n < num_iterations; ++n) {
+      angle[n] = T(alpha);
+      sin_angle[n] = T(std::sin(alpha));
+      cos_angle[n] = T(std::cos(alpha));
+      alpha /= 2;
+    }
+  }
+
+  static const tables& get() {
+    static const tables instance;
+    return instance;
+  }
+};
+
+template <typename T>
+inline T sign(const T& x) {
+  return std::copysign(T(1.), x);
+}
+
+template <typename T, typename A>
+inline xs::batch<T, A> sign(const xs::batch<T, A>& x) {
+  return xs::copysign(xs::batch<T, A>(T(1.)), x);
+}
+
+// A kernel for `solver::detail::solve_simd`, for reduced mean anomalies in
+// [0, pi]
+template <typename T, int num_iterations>
+struct kernel {
+  const T& eccentricity;
+  const tables<T, num_iterations>& table;
+
+  template <typename V>
+  inline V operator()(const V& mean_anomaly, V* sin_eccentric_anomaly,
+                      V* cos_eccentric_anomaly) const {
+    const V ecc(eccentricity);
+    V ecc_anom(constants::pio2<T>()), s(T(1.)), c(T(0.));
+    for (int n = 0; n < num_iterations; ++n) {
+      auto sigma = sign(mean_anomaly - math::fnma(ecc, s, ecc_anom));
+      auto sin_alpha = sigma * V(table.sin_angle[n]);
+      auto cos_alpha = V(table.cos_angle[n]);
+      ecc_anom = math::fma(sigma, V(table.angle[n]), ecc_anom);
+      auto c_next = math::fnma(s, sin_alpha, c * cos_alpha);
+      s = math::fma(c, sin_alpha, s * cos_alpha);
+      c = c_next;
+    }
+    *sin_eccentric_anomaly = s;
+    *cos_eccentric_anomaly = c;
+    return ecc_anom;
+  }
+};
+
+}  // namespace detail
+
+// Solve Kepler's equation using `num_iterations` CORDIC-like rotations, for an
+// absolute error in E of about pi / 2^(num_iterations + 1)
+template <typename T, int num_iterations = default_iterations<T>::value>
+inline void solve(const T& eccentricity, std::size_t size, const T* mean_anomaly,
+                  T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  static_assert(num_iterations > 0, "num_iterations must be positive");
+  const detail::kernel<T, num_iterations> kernel{eccentricity,
+                                                 detail::tables<T, num_iterations>::get()};
+  solver::detail::solve(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                        cos_eccentric_anomaly);
+}
+
+template <typename T, int num_iterations = default_iterations<T>::value,
+          typename Tag = xs::unaligned_mode>
+inline void solve_simd(const T& eccentricity, std::size_t size, const T* mean_anomaly,
+                       T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                       T* cos_eccentric_anomaly) {
+  static_assert(num_iterations > 0, "num_iterations must be positive");
+  const detail::kernel<T, num_iterations> kernel{eccentricity,
+                                                 detail::tables<T, num_iterations>::get()};
+  solver::detail::solve_simd<Tag>(kernel, size, mean_anomaly, eccentric_anomaly,
+                                  sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+}  // namespace cordic
+}  // namespace kepler
+
+#endif
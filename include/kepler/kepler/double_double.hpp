@@ -0,0 +1,475 @@
+#ifndef KEPLER_DOUBLE_DOUBLE_HPP
+#define KEPLER_DOUBLE_DOUBLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/householder.hpp"
+#include "kepler/kepler/math.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "xsimd/xsimd.hpp"
+
+// Double-double arithmetic, for solving Kepler's equation to about 1e-30. A
+// value is the unevaluated sum hi + lo of two doubles with |lo| <= ulp(hi) / 2,
+// and the algorithms follow the QD library of Hida, Li & Bailey (2001). Values
+// are templated on the type of their parts, so the same code handles scalars
+// (`value<double>`) and SIMD batches of pairs (`value<xs::batch<double>>`).
+//
+// The solver finds E in double precision with any of the usual starters and
+// refiners, and then takes a single Householder step in double-double
+// arithmetic, which converges to well below the double-double precision since
+// the error is already ~1e-16.
+//
+// https://www.davidhbailey.com/dhbpapers/qd.pdf
+
+namespace kepler {
+namespace dd {
+
+namespace xs = xsimd;
+
+namespace detail {
+
+// Requires |a| >= |b|
+template <typename V>
+inline V fast_two_sum(const V& a, const V& b, V& err) {
+  V s = a + b;
+  err = b - (s - a);
+  return s;
+}
+
+#if defined(__FMA__) || defined(__ARM_FEATURE_FMA)
+
+inline double two_prod(const double& a, const double& b, double& err) {
+  double p = a * b;
+  err = std::fma(a, b, -p);
+  return p;
+}
+
+template <typename A>
+inline xs::batch<double, A> two_prod(const xs::batch<double, A>& a,
+                                     const xs::batch<double, A>& b,
+                                     xs::batch<double, A>& err) {
+  auto p = a * b;
+  err = xs::fms(a, b, p);
+  return p;
+}
+
+#else
+
+// Without a hardware FMA, Dekker's product is exact but about 4x slower
+template <typename V>
+inline void split(const V& a, V& hi, V& lo) {
+  V t = V(134217729.) * a;
+  hi = t - (t - a);
+  lo = a - hi;
+}
+
+template <typename V>
+inline V two_prod(const V& a, const V& b, V& err) {
+  V p = a * b, a_hi, a_lo, b_hi, b_lo;
+  split(a, a_hi, a_lo);
+  split(b, b_hi, b_lo);
+  err = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+  return p;
+}
+
+#endif
+
+}  // namespace detail
+
+template <typename V>
+struct value {
+  V hi, lo;
+
+  value() = default;
+  value(const V& hi, const V& lo) : hi(hi), lo(lo) {}
+  value(const V& x) : hi(x), lo(V(0.)) {}
+
+  template <typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value &&
+                                                    !std::is_same<U, V>::value>>
+  value(const U& x) : hi(V(double(x))), lo(V(0.)) {}
+
+  friend inline value operator-(const value& a) { return {-a.hi, -a.lo}; }
+
+  friend inline value operator+(const value& a, const value& b) {
+    V e1, e2;
+    V s = math::two_sum(a.hi, b.hi, e1);
+    V t = math::two_sum(a.lo, b.lo, e2);
+    e1 += t;
+    s = detail::fast_two_sum(s, e1, e1);
+    e1 += e2;
+    s = detail::fast_two_sum(s, e1, e1);
+    return {s, e1};
+  }
+
+  friend inline value operator+(const value& a, const V& b) {
+    V e;
+    V s = math::two_sum(a.hi, b, e);
+    e += a.lo;
+    s = detail::fast_two_sum(s, e, e);
+    return {s, e};
+  }
+
+  friend inline value operator-(const value& a, const value& b) { return a + (-b); }
+  friend inline value operator-(const value& a, const V& b) { return a + (-b); }
+
+  friend inline value operator*(const value& a, const value& b) {
+    V e;
+    V p = detail::two_prod(a.hi, b.hi, e);
+    e += a.hi * b.lo + a.lo * b.hi;
+    p = detail::fast_two_sum(p, e, e);
+    return {p, e};
+  }
+
+  friend inline value operator*(const value& a, const V& b) {
+    V e;
+    V p = detail::two_prod(a.hi, b, e);
+    e += a.lo * b;
+    p = detail::fast_two_sum(p, e, e);
+    return {p, e};
+  }
+
+  friend inline value operator/(const value& a, const value& b) {
+    V q1 = a.hi / b.hi;
+    value r = a - b * q1;
+    V q2 = r.hi / b.hi;
+    r = r - b * q2;
+    V q3 = r.hi / b.hi;
+    q1 = detail::fast_two_sum(q1, q2, q2);
+    return value(q1, q2) + q3;
+  }
+};
+
+// Arrays of double-double values, with the high and low parts stored in
+// separate arrays so that they can be loaded directly into batches
+struct const_array {
+  const double* hi;
+  const double* lo;
+};
+
+struct array {
+  double* hi;
+  double* lo;
+};
+
+namespace detail {
+
+// 2 pi split into three doubles
+constexpr double twopi[3] = {0x1.921fb54442d18p+2, 0x1.1a62633145c07p-52,
+                             -0x1.f1976b7ed8fbcp-108};
+
+// The sine and cosine are evaluated as a table lookup at the nearest multiple
+// of pi / num_nodes, followed by a short Taylor series in the remainder
+constexpr int num_nodes = 32;
+
+// 1 / n! for the terms of the Taylor series evaluated in double-double
+constexpr int num_factorials = 9;
+
+inline value<double> series_sin(const value<double>& x, int num_terms) {
+  auto x2 = x * x;
+  value<double> term = x, sum = x;
+  for (int n = 3; n < 2 * num_terms; n += 2) {
+    term = -term * x2 / value<double>(double((n - 1) * n));
+    sum = sum + term;
+  }
+  return sum;
+}
+
+inline value<double> series_cos(const value<double>& x, int num_terms) {
+  auto x2 = x * x;
+  value<double> term(1.), sum(1.);
+  for (int n = 2; n < 2 * num_terms; n += 2) {
+    term = -term * x2 / value<double>(double((n - 1) * n));
+    sum = sum + term;
+  }
+  return sum;
+}
+
+struct tables {
+  double sin_hi[num_nodes + 1], sin_lo[num_nodes + 1], cos_hi[num_nodes + 1],
+      cos_lo[num_nodes + 1];
+  value<double> inv_factorial[num_factorials];
+
+  tables() {
+    value<double> factorial(1.);
+    for (int n = 0; n < num_factorials; ++n) {
+      if (n > 0) factorial = factorial * double(n);
+      inv_factorial[n] = value<double>(1.) / factorial;
+    }
+
+    // The nodes up to pi/4 are evaluated using the full Taylor series, and the
+    // rest follow from symmetry
+    constexpr int quarter = num_nodes / 4, half = num_nodes / 2;
+    const value<double> step =
+        value<double>(twopi[0] / (2 * num_nodes), twopi[1] / (2 * num_nodes)) +
+        twopi[2] / (2 * num_nodes);
+    value<double> s[quarter + 1], c[quarter + 1];
+    for (int j = 0; j <= quarter; ++j) {
+      auto x = step * double(j);
+      s[j] = series_sin(x, 20);
+      c[j] = series_cos(x, 20);
+    }
+    for (int j = 0; j <= num_nodes; ++j) {
+      int k = j <= half ? j : num_nodes - j;
+      value<double> sin_j, cos_j;
+      if (k <= quarter) {
+        sin_j = s[k];
+        cos_j = c[k];
+      } else {
+        sin_j = c[half - k];
+        cos_j = s[half - k];
+      }
+      if (j > half) cos_j = -cos_j;
+      sin_hi[j] = sin_j.hi;
+      sin_lo[j] = sin_j.lo;
+      cos_hi[j] = cos_j.hi;
+      cos_lo[j] = cos_j.lo;
+    }
+  }
+
+  static const tables& get() {
+    static const tables instance;
+    return instance;
+  }
+};
+
+inline double nearest_node(const double& x) {
+  return std::min(std::max(std::nearbyint(x * (num_nodes / constants::pi<double>())), 0.),
+                  double(num_nodes));
+}
+
+template <typename A>
+inline xs::batch<double, A> nearest_node(const xs::batch<double, A>& x) {
+  using B = xs::batch<double, A>;
+  return xs::min(xs::max(xs::nearbyint(x * B(num_nodes / constants::pi<double>())), B(0.)),
+                 B(double(num_nodes)));
+}
+
+inline double lookup(const double* table, const double& node) { return table[int(node)]; }
+
+template <typename A>
+inline xs::batch<double, A> lookup(const double* table, const xs::batch<double, A>& node) {
+  return xs::batch<double, A>::gather(table, xs::to_int(node));
+}
+
+inline double copysign_one(const double& x) { return std::copysign(1., x); }
+
+template <typename A>
+inline xs::batch<double, A> copysign_one(const xs::batch<double, A>& x) {
+  return xs::copysign(xs::batch<double, A>(1.), x);
+}
+
+template <typename V>
+inline value<V> twopi_value() {
+  return value<V>(V(twopi[0]), V(twopi[1])) + V(twopi[2]);
+}
+
+inline double clamp_pi(const double& x) { return std::min(x, constants::pi<double>()); }
+
+template <typename A>
+inline xs::batch<double, A> clamp_pi(const xs::batch<double, A>& x) {
+  return xs::min(x, constants::pi<xs::batch<double, A>>());
+}
+
+inline double nearest_turn(const double& x) { return std::nearbyint(x / twopi[0]); }
+
+template <typename A>
+inline xs::batch<double, A> nearest_turn(const xs::batch<double, A>& x) {
+  return xs::nearbyint(x / xs::batch<double, A>(twopi[0]));
+}
+
+// x - n c for an integer n and c = c0 + c1 + c2, to double-double precision
+template <typename V>
+inline value<V> subtract_multiple(const value<V>& x, const V& n, double scale) {
+  V e0, e1;
+  V p0 = two_prod(n, V(twopi[0] * scale), e0);
+  V p1 = two_prod(n, V(twopi[1] * scale), e1);
+  return ((x - value<V>(p0, e0)) - value<V>(p1, e1)) - n * V(twopi[2] * scale);
+}
+
+template <typename V>
+inline value<V> broadcast(const value<double>& x) {
+  return {V(x.hi), V(x.lo)};
+}
+
+template <typename V>
+inline value<V> select(const bool& flag, const value<V>& a, const value<V>& b) {
+  return flag ? a : b;
+}
+
+template <typename V, typename M>
+inline value<V> select(const M& flag, const value<V>& a, const value<V>& b) {
+  return {xs::select(flag, a.hi, b.hi), xs::select(flag, a.lo, b.lo)};
+}
+
+}  // namespace detail
+
+// The sine and cosine, for 0 <= x <= pi
+template <typename V>
+inline void sincos(const value<V>& x, value<V>& s, value<V>& c) {
+  const auto& t = detail::tables::get();
+  const auto* f = t.inv_factorial;
+
+  auto node = detail::nearest_node(x.hi);
+  auto r = detail::subtract_multiple(x, node, 1. / (2 * detail::num_nodes));
+  auto r2 = r * r;
+
+  // With |r| <= pi / 64, the terms beyond r^8 only need double precision
+  auto x2 = r2.hi;
+  auto sin_tail = x2 * math::fma(x2, math::fma(x2, V(-1. / 1307674368000.), V(1. / 6227020800.)),
+                                 V(-1. / 39916800.));
+  auto cos_tail = x2 * math::fma(x2, math::fma(x2, V(1. / 20922789888000.), V(-1. / 87178291200.)),
+                                 V(1. / 479001600.));
+  value<V> sin_r = value<V>(V(1. / 362880.), V(0.)) + sin_tail;
+  sin_r = sin_r * r2 - detail::broadcast<V>(f[7]);
+  sin_r = sin_r * r2 + detail::broadcast<V>(f[5]);
+  sin_r = sin_r * r2 - detail::broadcast<V>(f[3]);
+  sin_r = r + r * r2 * sin_r;
+  value<V> cos_r = value<V>(V(-1. / 3628800.), V(0.)) + cos_tail;
+  cos_r = cos_r * r2 + detail::broadcast<V>(f[8]);
+  cos_r = cos_r * r2 - detail::broadcast<V>(f[6]);
+  cos_r = cos_r * r2 + detail::broadcast<V>(f[4]);
+  cos_r = cos_r * r2 - detail::broadcast<V>(f[2]);
+  cos_r = cos_r * r2 + V(1.);
+
+  value<V> sin_node(detail::lookup(t.sin_hi, node), detail::lookup(t.sin_lo, node));
+  value<V> cos_node(detail::lookup(t.cos_hi, node), detail::lookup(t.cos_lo, node));
+  s = sin_node * cos_r + cos_node * sin_r;
+  c = cos_node * cos_r - sin_node * sin_r;
+}
+
+// Reduce x to the range [0, pi], returning true (per lane) when the result
+// was reflected, like `reduction::range_reduce`
+template <typename V>
+inline auto range_reduce(const value<V>& x, value<V>& xr) {
+  auto turns = detail::nearest_turn(x.hi);
+  xr = detail::subtract_multiple(x, turns, 1.);
+  auto flip = xr.hi < V(0.);
+  xr = detail::select(flip, -xr, xr);
+  return flip;
+}
+
+// The Householder state for the double-double eccentric anomaly, setting its
+// sine and cosine
+template <typename V>
+inline householder::detail::state<value<V>> init(const double& eccentricity,
+                                                 const value<V>& mean_anomaly,
+                                                 const value<V>& eccentric_anomaly,
+                                                 value<V>& sin_eccentric_anomaly,
+                                                 value<V>& cos_eccentric_anomaly) {
+  sincos(eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+  auto ecc_sin = sin_eccentric_anomaly * V(eccentricity);
+  auto f0 = (eccentric_anomaly - ecc_sin) - mean_anomaly;
+  return {f0, ecc_sin, cos_eccentric_anomaly * V(eccentricity)};
+}
+
+namespace detail {
+
+// Solve for a double-double mean anomaly, using `kernel` for the double
+// precision estimate in the reduced range
+template <int order, typename V, typename Kernel>
+inline void solve(const Kernel& kernel, const double& eccentricity,
+                  const value<V>& mean_anomaly, value<V>& eccentric_anomaly,
+                  value<V>& sin_eccentric_anomaly, value<V>& cos_eccentric_anomaly) {
+  // As for `solver::detail::solve_one`, E is returned in [0, 2 pi) with the
+  // sign of M
+  auto sgn = copysign_one(mean_anomaly.hi);
+  value<V> reduced;
+  auto high = range_reduce(mean_anomaly * sgn, reduced);
+
+  // The reduced value can exceed pi by an ulp, which the double precision
+  // kernels don't expect
+  V s, c;
+  value<V> ecc_anom(kernel(clamp_pi(reduced.hi), &s, &c));
+  auto state = init(eccentricity, reduced, ecc_anom, sin_eccentric_anomaly,
+                    cos_eccentric_anomaly);
+  auto delta = householder::step<order>(state);
+  ecc_anom = ecc_anom + delta;
+
+  // The step is tiny, so the sine and cosine are rotated through it using the
+  // second order expansion
+  auto half_delta2 = V(0.5) * delta.hi * delta.hi;
+  auto sin_ecc_anom = (sin_eccentric_anomaly + cos_eccentric_anomaly * delta) -
+                      sin_eccentric_anomaly.hi * half_delta2;
+  auto cos_ecc_anom = (cos_eccentric_anomaly - sin_eccentric_anomaly * delta) -
+                      cos_eccentric_anomaly.hi * half_delta2;
+
+  eccentric_anomaly = select(high, twopi_value<V>() - ecc_anom, ecc_anom) * sgn;
+  sin_eccentric_anomaly = select(high, -sin_ecc_anom, sin_ecc_anom) * sgn;
+  cos_eccentric_anomaly = cos_ecc_anom;
+}
+
+template <int order, typename Kernel>
+inline void solve_element(const Kernel& kernel, const double& eccentricity, std::size_t i,
+                          const const_array& mean_anomaly, const array& eccentric_anomaly,
+                          const array& sin_eccentric_anomaly,
+                          const array& cos_eccentric_anomaly) {
+  value<double> E, s, c;
+  solve<order>(kernel, eccentricity, value<double>(mean_anomaly.hi[i], mean_anomaly.lo[i]), E,
+               s, c);
+  eccentric_anomaly.hi[i] = E.hi;
+  eccentric_anomaly.lo[i] = E.lo;
+  sin_eccentric_anomaly.hi[i] = s.hi;
+  sin_eccentric_anomaly.lo[i] = s.lo;
+  cos_eccentric_anomaly.hi[i] = c.hi;
+  cos_eccentric_anomaly.lo[i] = c.lo;
+}
+
+}  // namespace detail
+
+// Solve Kepler's equation in double-double precision, for a double precision
+// eccentricity. The `Starter` and `Refiner` are used for the initial double
+// precision estimate, which is followed by a Householder step of order
+// `order` in double-double arithmetic.
+template <int order = 2, typename Starter = starters::raposo_pulido_brandt<double>,
+          typename Refiner = refiners::brandt<double>>
+inline void solve(const double& eccentricity, std::size_t size, const_array mean_anomaly,
+                  array eccentric_anomaly, array sin_eccentric_anomaly,
+                  array cos_eccentric_anomaly, const Refiner& refiner = Refiner()) {
+  solver::detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    for (std::size_t i = 0; i < size; ++i) {
+      detail::solve_element<order>(kernel, eccentricity, i, mean_anomaly, eccentric_anomaly,
+                                   sin_eccentric_anomaly, cos_eccentric_anomaly);
+    }
+  });
+}
+
+template <int order = 2, typename Starter = starters::raposo_pulido_brandt<double>,
+          typename Refiner = refiners::brandt<double>, typename Tag = xs::unaligned_mode>
+inline void solve_simd(const double& eccentricity, std::size_t size, const_array mean_anomaly,
+                       array eccentric_anomaly, array sin_eccentric_anomaly,
+                       array cos_eccentric_anomaly, const Refiner& refiner = Refiner()) {
+  using B = xs::batch<double>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  solver::detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    for (std::size_t i = 0; i < vec_size; i += simd_size) {
+      const value<B> M(xs::load(&(mean_anomaly.hi[i]), Tag()),
+                       xs::load(&(mean_anomaly.lo[i]), Tag()));
+      value<B> E, s, c;
+      detail::solve<order>(kernel, eccentricity, M, E, s, c);
+      E.hi.store(&(eccentric_anomaly.hi[i]), Tag());
+      E.lo.store(&(eccentric_anomaly.lo[i]), Tag());
+      s.hi.store(&(sin_eccentric_anomaly.hi[i]), Tag());
+      s.lo.store(&(sin_eccentric_anomaly.lo[i]), Tag());
+      c.hi.store(&(cos_eccentric_anomaly.hi[i]), Tag());
+      c.lo.store(&(cos_eccentric_anomaly.lo[i]), Tag());
+    }
+
+    for (std::size_t i = vec_size; i < size; ++i) {
+      detail::solve_element<order>(kernel, eccentricity, i, mean_anomaly, eccentric_anomaly,
+                                   sin_eccentric_anomaly, cos_eccentric_anomaly);
+    }
+  });
+}
+
+}  // namespace dd
+}  // namespace kepler
+
+#endif
@@ -0,0 +1,337 @@
+#ifndef KEPLER_ENSEMBLE_HPP
+#define KEPLER_ENSEMBLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "xsimd/xsimd.hpp"
+
+namespace kepler {
+namespace ensemble {
+
+namespace xs = xsimd;
+
+// Structure of arrays of orbit parameters, one element per sample, such as the
+// walkers of an ensemble sampler
+template <typename T>
+struct samples {
+  const T* period;
+  const T* time_of_periastron;
+  const T* eccentricity;
+};
+
+// The work is tiled into blocks of `time_block_size` times, so that the times
+// and the outputs for a block stay in L1 while the samples are swept over it,
+// and blocks of `sample_block_size` samples, for which the starters are set up
+// once and reused for every block of times.
+constexpr std::size_t time_block_size = 256;
+constexpr std::size_t sample_block_size = 16;
+
+namespace detail {
+
+// When vectorizing over samples, each SIMD lane has its own eccentricity so
+// starters that are set up for a fixed eccentricity can't be used. Only
+// combinations with a setup-free starter, for which `lane_solver` is true, are
+// vectorized this way; the others are always solved along the times.
+template <typename Starter, typename Refiner>
+struct lane_solver : std::false_type {};
+
+template <typename T, int order_>
+struct lane_solver<starters::markley<T>, refiners::non_iterative<order_, T>> : std::true_type {
+  static constexpr int order = order_;
+};
+
+// The Markley (1995) starter with the eccentricity dependent factors computed
+// per lane, followed by a single Householder step of order `order`, like
+// `starters::markley` with `refiners::non_iterative<order>`. Lanes below
+// `constants::low_eccentricity` use the series from
+// `solver::detail::low_eccentricity_kernel` instead, as they would in
+// `solver::solve_simd`, so the results don't depend on the axis.
+template <typename T, typename A, int order>
+struct lane_kernel {
+  using B = xs::batch<T, A>;
+  B eccentricity, ome, alpha_factor, three_ome;
+  typename B::batch_bool_type low;
+
+  explicit lane_kernel(const B& eccentricity)
+      : eccentricity(eccentricity),
+        ome(B(T(1.)) - eccentricity),
+        alpha_factor(B(constants::markley_factor2<T>()) / (B(T(1.)) + eccentricity)),
+        three_ome(B(T(3.)) * ome),
+        low(eccentricity < B(constants::low_eccentricity<T>())) {}
+
+  inline B operator()(const B& mean_anomaly, B* sin_eccentric_anomaly,
+                      B* cos_eccentric_anomaly) const {
+    if (xs::all(low)) return series(mean_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+    auto ecc_anom = refiners::detail::_non_iterative_step<order>(eccentricity, mean_anomaly,
+                                                                 start(mean_anomaly));
+    auto sincos = math::sincos(ecc_anom);
+    *sin_eccentric_anomaly = sincos.first;
+    *cos_eccentric_anomaly = sincos.second;
+    if (xs::any(low)) {
+      B s, c;
+      ecc_anom = xs::select(low, series(mean_anomaly, &s, &c), ecc_anom);
+      *sin_eccentric_anomaly = xs::select(low, s, *sin_eccentric_anomaly);
+      *cos_eccentric_anomaly = xs::select(low, c, *cos_eccentric_anomaly);
+    }
+    return ecc_anom;
+  }
+
+  // The series kernel works lane by lane when its eccentricity is a batch
+  inline B series(const B& mean_anomaly, B* sin_eccentric_anomaly,
+                  B* cos_eccentric_anomaly) const {
+    const solver::detail::low_eccentricity_kernel<B> kernel{eccentricity};
+    auto sincos = math::sincos(mean_anomaly);
+    return kernel.evaluate(mean_anomaly, sincos.first, sincos.second, sin_eccentric_anomaly,
+                           cos_eccentric_anomaly);
+  }
+
+  inline B start(const B& mean_anomaly) const {
+    auto m2 = mean_anomaly * mean_anomaly;
+    auto alpha = xs::fma(alpha_factor, constants::pi<T>() - mean_anomaly,
+                         B(constants::markley_factor1<T>()));
+
+    auto d = xs::fma(eccentricity, alpha, three_ome);
+    alpha *= d;
+
+    auto r = mean_anomaly * xs::fma(B(T(3.)) * alpha, d - ome, m2);
+    auto q = xs::fms(B(T(2.)) * ome, alpha, m2);
+    auto q2 = q * q;
+
+    auto w = xs::cbrt(xs::abs(r) + xs::sqrt(xs::fma(q2, q, r * r)));
+    w *= w;
+
+    auto denom = xs::fma(w, w + q, q2);
+    return xs::fma(B(T(2.)) * r / denom, w, mean_anomaly) / d;
+  }
+};
+
+// Pointers to a segment of one row of the output
+template <typename T>
+struct row {
+  T* eccentric_anomaly;
+  T* sin_eccentric_anomaly;
+  T* cos_eccentric_anomaly;
+};
+
+// The solvers below write each row segment to the pointers returned by
+// `sink.get(lane, sample, time)`, where `lane` is in [0, SIMD width), and then
+// call `sink.flush(lane, sample, time, count)` once it is complete.
+
+// Write directly into dense (num_samples, num_times) outputs
+template <typename T>
+struct dense_sink {
+  std::size_t num_times;
+  T* eccentric_anomaly;
+  T* sin_eccentric_anomaly;
+  T* cos_eccentric_anomaly;
+
+  inline row<T> get(std::size_t, std::size_t sample, std::size_t time) const {
+    const std::size_t offset = sample * num_times + time;
+    return {eccentric_anomaly + offset, sin_eccentric_anomaly + offset,
+            cos_eccentric_anomaly + offset};
+  }
+
+  inline void flush(std::size_t, std::size_t, std::size_t, std::size_t) const {}
+};
+
+// Write into a tile buffer, and hand each completed row segment to `func`
+template <typename T, typename Func>
+struct reduce_sink {
+  static constexpr std::size_t num_lanes = xs::batch<T>::size;
+  Func& func;
+  T buffer[3][num_lanes][time_block_size];
+
+  explicit reduce_sink(Func& func) : func(func) {}
+
+  inline row<T> get(std::size_t lane, std::size_t, std::size_t) {
+    return {buffer[0][lane], buffer[1][lane], buffer[2][lane]};
+  }
+
+  inline void flush(std::size_t lane, std::size_t sample, std::size_t time, std::size_t count) {
+    func(sample, time, count, static_cast<const T*>(buffer[0][lane]),
+         static_cast<const T*>(buffer[1][lane]), static_cast<const T*>(buffer[2][lane]));
+  }
+};
+
+// Solve one row segment, vectorized over the times
+template <typename T, typename Kernel>
+inline void solve_row(const Kernel& kernel, const T& mean_motion, const T& time_of_periastron,
+                      std::size_t size, const T* time, const row<T>& out) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    auto mean_anom =
+        B(mean_motion) * (xs::load(&(time[i]), xs::unaligned_mode()) - B(time_of_periastron));
+    B ecc_anom, sin_ecc_anom, cos_ecc_anom;
+    solver::detail::solve_batch(kernel, mean_anom, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    ecc_anom.store(&(out.eccentric_anomaly[i]), xs::unaligned_mode());
+    sin_ecc_anom.store(&(out.sin_eccentric_anomaly[i]), xs::unaligned_mode());
+    cos_ecc_anom.store(&(out.cos_eccentric_anomaly[i]), xs::unaligned_mode());
+  }
+
+  for (std::size_t i = vec_size; i < size; ++i) {
+    solver::detail::solve_one(kernel, mean_motion * (time[i] - time_of_periastron),
+                              out.eccentric_anomaly[i], out.sin_eccentric_anomaly[i],
+                              out.cos_eccentric_anomaly[i]);
+  }
+}
+
+template <typename Starter, typename Refiner, typename T, typename Sink>
+inline void solve_along_times(std::size_t num_samples, const samples<T>& params,
+                              std::size_t num_times, const T* time, const Refiner& refiner,
+                              Sink& sink) {
+  std::vector<Starter> starters;
+  starters.reserve(sample_block_size);
+  for (std::size_t n0 = 0; n0 < num_samples; n0 += sample_block_size) {
+    const std::size_t n1 = std::min(num_samples, n0 + sample_block_size);
+    starters.clear();
+    for (std::size_t n = n0; n < n1; ++n) starters.emplace_back(params.eccentricity[n]);
+
+    for (std::size_t j0 = 0; j0 < num_times; j0 += time_block_size) {
+      const std::size_t count = std::min(time_block_size, num_times - j0);
+      for (std::size_t n = n0; n < n1; ++n) {
+        const T mean_motion = constants::twopi<T>() / params.period[n];
+        const row<T> out = sink.get(0, n, j0);
+        solver::detail::with_kernel(
+            params.eccentricity[n], starters[n - n0], refiner, [&](const auto& kernel) {
+              solve_row(kernel, mean_motion, params.time_of_periastron[n], count, &(time[j0]),
+                        out);
+            });
+        sink.flush(0, n, j0, count);
+      }
+    }
+  }
+}
+
+template <typename Starter, typename Refiner, typename T, typename Sink>
+inline void solve_along_samples(std::size_t num_samples, const samples<T>& params,
+                                std::size_t num_times, const T* time, const Refiner& refiner,
+                                Sink& sink) {
+  static_assert(lane_solver<Starter, Refiner>::value,
+                "only setup-free starters can be vectorized over samples");
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = num_samples - num_samples % simd_size;
+  alignas(B::arch_type::alignment()) T buffer[3][simd_size];
+  row<T> out[simd_size];
+
+  for (std::size_t n = 0; n < vec_size; n += simd_size) {
+    const lane_kernel<T, typename B::arch_type, lane_solver<Starter, Refiner>::order> kernel(
+        xs::load(&(params.eccentricity[n]), xs::unaligned_mode()));
+    const auto mean_motion =
+        B(constants::twopi<T>()) / xs::load(&(params.period[n]), xs::unaligned_mode());
+    const auto time_of_periastron =
+        xs::load(&(params.time_of_periastron[n]), xs::unaligned_mode());
+
+    for (std::size_t j0 = 0; j0 < num_times; j0 += time_block_size) {
+      const std::size_t count = std::min(time_block_size, num_times - j0);
+      for (std::size_t l = 0; l < simd_size; ++l) out[l] = sink.get(l, n + l, j0);
+      for (std::size_t j = 0; j < count; ++j) {
+        auto mean_anom = mean_motion * (B(time[j0 + j]) - time_of_periastron);
+        B ecc_anom, sin_ecc_anom, cos_ecc_anom;
+        solver::detail::solve_batch(kernel, mean_anom, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+        ecc_anom.store(buffer[0], xs::aligned_mode());
+        sin_ecc_anom.store(buffer[1], xs::aligned_mode());
+        cos_ecc_anom.store(buffer[2], xs::aligned_mode());
+        for (std::size_t l = 0; l < simd_size; ++l) {
+          out[l].eccentric_anomaly[j] = buffer[0][l];
+          out[l].sin_eccentric_anomaly[j] = buffer[1][l];
+          out[l].cos_eccentric_anomaly[j] = buffer[2][l];
+        }
+      }
+      for (std::size_t l = 0; l < simd_size; ++l) sink.flush(l, n + l, j0, count);
+    }
+  }
+
+  // The remaining samples use the scalar version of the same algorithm
+  for (std::size_t n = vec_size; n < num_samples; ++n) {
+    const T mean_motion = constants::twopi<T>() / params.period[n];
+    solver::detail::with_kernel<Starter>(params.eccentricity[n], refiner, [&](const auto& kernel) {
+      for (std::size_t j0 = 0; j0 < num_times; j0 += time_block_size) {
+        const std::size_t count = std::min(time_block_size, num_times - j0);
+        const row<T> out = sink.get(0, n, j0);
+        for (std::size_t j = 0; j < count; ++j) {
+          solver::detail::solve_one(kernel,
+                                    mean_motion * (time[j0 + j] - params.time_of_periastron[n]),
+                                    out.eccentric_anomaly[j], out.sin_eccentric_anomaly[j],
+                                    out.cos_eccentric_anomaly[j]);
+        }
+        sink.flush(0, n, j0, count);
+      }
+    });
+  }
+}
+
+// Vectorize along whichever axis is longer, if the starter allows it
+template <typename Starter, typename Refiner, typename T, typename Sink>
+inline void solve(std::size_t num_samples, const samples<T>& params, std::size_t num_times,
+                  const T* time, const Refiner& refiner, Sink& sink, std::true_type) {
+  if (num_samples > num_times) {
+    solve_along_samples<Starter>(num_samples, params, num_times, time, refiner, sink);
+  } else {
+    solve_along_times<Starter>(num_samples, params, num_times, time, refiner, sink);
+  }
+}
+
+template <typename Starter, typename Refiner, typename T, typename Sink>
+inline void solve(std::size_t num_samples, const samples<T>& params, std::size_t num_times,
+                  const T* time, const Refiner& refiner, Sink& sink, std::false_type) {
+  solve_along_times<Starter>(num_samples, params, num_times, time, refiner, sink);
+}
+
+template <typename Starter, typename Refiner, typename T, typename Sink>
+inline void solve(std::size_t num_samples, const samples<T>& params, std::size_t num_times,
+                  const T* time, const Refiner& refiner, Sink& sink) {
+  solve<Starter>(num_samples, params, num_times, time, refiner, sink,
+                 lane_solver<Starter, Refiner>());
+}
+
+}  // namespace detail
+
+// Solve for the eccentric anomaly of each of `num_samples` orbits at each of
+// the `num_times` shared observation times, where the mean anomaly is
+// 2 pi (t - t_p) / P. The outputs are dense arrays with shape
+// (num_samples, num_times). The solve is vectorized over the times or, when
+// there are more samples than times and the starter has no per-eccentricity
+// setup (`starters::markley` with `refiners::non_iterative`), over the samples.
+// Either way, the results match `solver::solve_simd` for each sample.
+template <typename T, typename Starter = starters::raposo_pulido_brandt<T>,
+          typename Refiner = refiners::brandt<T>>
+inline void solve(std::size_t num_samples, const samples<T>& params, std::size_t num_times,
+                  const T* time, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                  T* cos_eccentric_anomaly, const Refiner& refiner = Refiner()) {
+  detail::dense_sink<T> sink{num_times, eccentric_anomaly, sin_eccentric_anomaly,
+                             cos_eccentric_anomaly};
+  detail::solve<Starter>(num_samples, params, num_times, time, refiner, sink);
+}
+
+// The same, but instead of writing out the full result, each tile is solved
+// into a small buffer and passed to
+//
+//   func(sample, time_begin, count, eccentric_anomaly, sin_eccentric_anomaly,
+//        cos_eccentric_anomaly)
+//
+// one row segment at a time, in no particular order, so that it can be reduced
+// (to a log likelihood, for example) while it is still in cache. The pointers
+// are only valid during the call.
+template <typename T, typename Starter = starters::raposo_pulido_brandt<T>,
+          typename Refiner = refiners::brandt<T>, typename Func>
+inline void reduce(std::size_t num_samples, const samples<T>& params, std::size_t num_times,
+                   const T* time, Func&& func, const Refiner& refiner = Refiner()) {
+  detail::reduce_sink<T, Func> sink(func);
+  detail::solve<Starter>(num_samples, params, num_times, time, refiner, sink);
+}
+
+}  // namespace ensemble
+}  // namespace kepler
+
+#endif
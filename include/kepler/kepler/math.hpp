@@ -2,6 +2,7 @@
 #define KEPLER_MATH_HPP
 
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include "kepler/kepler/utils.hpp"
@@ -34,6 +35,16 @@ inline xs::batch<T, A> fnma(const xs::batch<T, A>& a, const xs::batch<T, A>& b,
   return xs::fnma(a, b, c);
 }
 
+// Error-free transformation of a sum: returns fl(a + b) and sets `err` so that
+// a + b = fl(a + b) + err exactly
+template <typename T>
+inline T two_sum(const T& a, const T& b, T& err) {
+  T s = a + b;
+  T bb = s - a;
+  err = (a - (s - bb)) + (b - bb);
+  return s;
+}
+
 template <typename T>
 inline T horner_dynamic(const T&, const T& c1) {
   return c1;
@@ -96,37 +107,38 @@ inline T horner_static(const T& x) noexcept {
 
 namespace detail {
 
-template <typename T>
-static inline T cos_eval(const T&);
-template <typename T>
-static inline T sin_eval(const T&, const T&);
+// The polynomial approximations below are valid for |x| <= pi/4, where z = x^2.
+// They are templated on the argument type so that they can be evaluated for
+// both scalars and SIMD batches.
+template <typename T, typename V>
+using enable_if_value_type_t =
+    typename std::enable_if<std::is_same<typename value_type<T>::type, V>::value, T>::type;
 
-template <>
-inline float cos_eval<float>(const float& z) {
-  float y = horner_static<float, 0x3d2aaaa5, 0xbab60619, 0x37ccf5ce>(z);
-  return 1. + fma(z, -0.5f, y * z * z);
+template <typename T>
+inline enable_if_value_type_t<T, float> cos_eval(const T& z) {
+  T y = horner_static<T, 0x3d2aaaa5, 0xbab60619, 0x37ccf5ce>(z);
+  return T(1.f) + math::fma(z, T(-0.5f), y * z * z);
 }
 
-template <>
-inline float sin_eval<float>(const float& z, const float& x) {
-  float y = horner_static<float, 0xbe2aaaa2, 0x3c08839d, 0xb94ca1f9>(z);
-  return fma(y * z, x, x);
+template <typename T>
+inline enable_if_value_type_t<T, float> sin_eval(const T& z, const T& x) {
+  T y = horner_static<T, 0xbe2aaaa2, 0x3c08839d, 0xb94ca1f9>(z);
+  return math::fma(y * z, x, x);
 }
 
-template <>
-inline double cos_eval<double>(const double& z) {
-  double y = horner_static<double, 0x3fe0000000000000ull, 0xbfa5555555555551ull,
-                           0x3f56c16c16c15d47ull, 0xbefa01a019ddbcd9ull, 0x3e927e4f8e06d9a5ull,
-                           0xbe21eea7c1e514d4ull, 0x3da8ff831ad9b219ull>(z);
-  return 1. - y * z;
+template <typename T>
+inline enable_if_value_type_t<T, double> cos_eval(const T& z) {
+  T y = horner_static<T, 0x3fe0000000000000ull, 0xbfa5555555555551ull, 0x3f56c16c16c15d47ull,
+                      0xbefa01a019ddbcd9ull, 0x3e927e4f8e06d9a5ull, 0xbe21eea7c1e514d4ull,
+                      0x3da8ff831ad9b219ull>(z);
+  return T(1.) - y * z;
 }
 
-template <>
-inline double sin_eval<double>(const double& z, const double& x) {
-  double y =
-      horner_static<double, 0xbfc5555555555548ull, 0x3f8111111110f7d0ull, 0xbf2a01a019bfdf03ull,
-                    0x3ec71de3567d4896ull, 0xbe5ae5e5a9291691ull, 0x3de5d8fd1fcf0ec1ull>(z);
-  return fma(y * z, x, x);
+template <typename T>
+inline enable_if_value_type_t<T, double> sin_eval(const T& z, const T& x) {
+  T y = horner_static<T, 0xbfc5555555555548ull, 0x3f8111111110f7d0ull, 0xbf2a01a019bfdf03ull,
+                      0x3ec71de3567d4896ull, 0xbe5ae5e5a9291691ull, 0x3de5d8fd1fcf0ec1ull>(z);
+  return math::fma(y * z, x, x);
 }
 
 template <typename T>
@@ -166,6 +178,13 @@ inline std::pair<xs::batch<T, A>, xs::batch<T, A>> sincos(const xs::batch<T, A>&
   return xs::sincos(x);
 }
 
+// NOTE: only valid for |x| <= pi/4; no range reduction is performed
+template <typename T>
+inline std::pair<T, T> sincos_small(const T& x) {
+  const auto z = x * x;
+  return std::make_pair(detail::sin_eval(z, x), detail::cos_eval(z));
+}
+
 }  // namespace math
 }  // namespace kepler
 
@@ -0,0 +1,255 @@
+#ifndef KEPLER_MEMORY_HPP
+#define KEPLER_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define KEPLER_MEMORY_X86
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define KEPLER_MEMORY_POSIX
+#endif
+
+#include "xsimd/xsimd.hpp"
+
+// Support for batches that are much larger than the last level cache. Passing
+// `streaming_mode` as the Tag of `solver::solve_simd` writes the outputs with
+// non-temporal stores, which bypass the cache rather than first reading every
+// output line into it and then evicting the input, and prefetches the mean
+// anomalies ahead of use. This is opt-in, since it slows down batches that fit
+// in the cache. `is_large_batch` compares a size with `large_batch_threshold`,
+// which defaults to the size of the last level cache, for callers that choose
+// the mode at runtime. `huge_page_allocator` can be used for the arrays
+// themselves, to reduce TLB misses when streaming through them.
+
+namespace kepler {
+namespace memory {
+
+namespace xs = xsimd;
+
+// The Tag for the streaming version of `solver::solve_simd`
+struct streaming_mode {};
+
+// How far ahead of the current batch the mean anomalies are prefetched
+constexpr std::size_t prefetch_distance = 1024;
+
+constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+// Used when the size of the last level cache can't be queried
+constexpr std::size_t default_cache_size = std::size_t(32) << 20;
+
+namespace detail {
+
+inline std::size_t last_level_cache_size() {
+#if defined(KEPLER_MEMORY_POSIX) && defined(_SC_LEVEL3_CACHE_SIZE)
+  long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if (size <= 0) size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  if (size > 0) return static_cast<std::size_t>(size);
+#endif
+  return default_cache_size;
+}
+
+inline std::atomic<std::size_t>& threshold() {
+  static std::atomic<std::size_t> value(last_level_cache_size());
+  return value;
+}
+
+// The non-temporal store for batches of `bytes` bytes of T, if there is one.
+// This is keyed on the size rather than on the register type, since vector
+// types lose their attributes as template arguments.
+template <typename T, std::size_t bytes>
+struct nontemporal {
+  static constexpr bool value = false;
+};
+
+#ifdef KEPLER_MEMORY_X86
+template <>
+struct nontemporal<float, 16> {
+  static constexpr bool value = true;
+  template <typename B>
+  static void store(float* ptr, const B& x) {
+    _mm_stream_ps(ptr, x);
+  }
+};
+
+template <>
+struct nontemporal<double, 16> {
+  static constexpr bool value = true;
+  template <typename B>
+  static void store(double* ptr, const B& x) {
+    _mm_stream_pd(ptr, x);
+  }
+};
+#endif
+
+#ifdef __AVX__
+template <>
+struct nontemporal<float, 32> {
+  static constexpr bool value = true;
+  template <typename B>
+  static void store(float* ptr, const B& x) {
+    _mm256_stream_ps(ptr, x);
+  }
+};
+
+template <>
+struct nontemporal<double, 32> {
+  static constexpr bool value = true;
+  template <typename B>
+  static void store(double* ptr, const B& x) {
+    _mm256_stream_pd(ptr, x);
+  }
+};
+#endif
+
+#ifdef __AVX512F__
+template <>
+struct nontemporal<float, 64> {
+  static constexpr bool value = true;
+  template <typename B>
+  static void store(float* ptr, const B& x) {
+    _mm512_stream_ps(ptr, x);
+  }
+};
+
+template <>
+struct nontemporal<double, 64> {
+  static constexpr bool value = true;
+  template <typename B>
+  static void store(double* ptr, const B& x) {
+    _mm512_stream_pd(ptr, x);
+  }
+};
+#endif
+
+template <typename T, typename A>
+using nontemporal_for = nontemporal<T, xs::batch<T, A>::size * sizeof(T)>;
+
+template <typename T, typename A>
+inline void stream(T* ptr, const xs::batch<T, A>& x, std::true_type) {
+  nontemporal_for<T, A>::store(ptr, x);
+}
+
+template <typename T, typename A>
+inline void stream(T* ptr, const xs::batch<T, A>& x, std::false_type) {
+  x.store_aligned(ptr);
+}
+
+}  // namespace detail
+
+// The number of bytes of input and output above which `is_large_batch` says
+// that a batch should be streamed
+inline std::size_t large_batch_threshold() {
+  return detail::threshold().load(std::memory_order_relaxed);
+}
+
+inline void set_large_batch_threshold(std::size_t bytes) {
+  detail::threshold().store(bytes, std::memory_order_relaxed);
+}
+
+inline bool is_large_batch(std::size_t bytes) { return bytes > large_batch_threshold(); }
+
+template <typename T>
+inline void prefetch(const T* ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr, 0, 0);
+#elif defined(KEPLER_MEMORY_X86)
+  _mm_prefetch(reinterpret_cast<const char*>(ptr), _MM_HINT_NTA);
+#else
+  (void)ptr;
+#endif
+}
+
+// Store a batch to an aligned address without allocating it in the cache, or
+// with an ordinary aligned store if the architecture has no such instruction.
+// Call `fence` after the last of these stores, before the results are used.
+template <typename T, typename A>
+inline void stream(T* ptr, const xs::batch<T, A>& x) {
+  detail::stream(ptr, x,
+                 std::integral_constant<bool, detail::nontemporal_for<T, A>::value>());
+}
+
+inline void fence() {
+#ifdef KEPLER_MEMORY_X86
+  _mm_sfence();
+#endif
+}
+
+// An allocator that asks for transparent huge pages for allocations of at least
+// `huge_page_size`, where the platform supports it. Smaller allocations, and
+// all allocations elsewhere, are just aligned to a cache line.
+template <typename T>
+struct huge_page_allocator {
+  typedef T value_type;
+
+  huge_page_allocator() = default;
+  template <typename U>
+  huge_page_allocator(const huge_page_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc();
+    const std::size_t bytes = n * sizeof(T);
+#if defined(KEPLER_MEMORY_POSIX) && defined(MADV_HUGEPAGE)
+    if (bytes >= huge_page_size) {
+      // Over-allocate so that the block can be aligned to a huge page, and
+      // return the unused ends
+      const std::size_t length = round_up(bytes);
+      void* mapping = mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (mapping == MAP_FAILED) throw std::bad_alloc();
+      char* base = static_cast<char*>(mapping);
+      char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<std::uintptr_t>(base)));
+      if (aligned != base) munmap(base, std::size_t(aligned - base));
+      const std::size_t tail = huge_page_size - std::size_t(aligned - base);
+      if (tail) munmap(aligned + length, tail);
+      madvise(aligned, length, MADV_HUGEPAGE);
+      return reinterpret_cast<T*>(aligned);
+    }
+#endif
+    return static_cast<T*>(::operator new(bytes, std::align_val_t(64)));
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    const std::size_t bytes = n * sizeof(T);
+#if defined(KEPLER_MEMORY_POSIX) && defined(MADV_HUGEPAGE)
+    if (bytes >= huge_page_size) {
+      munmap(ptr, round_up(bytes));
+      return;
+    }
+#endif
+    ::operator delete(ptr, std::align_val_t(64));
+  }
+
+  template <typename U>
+  bool operator==(const huge_page_allocator<U>&) const noexcept {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const huge_page_allocator<U>&) const noexcept {
+    return false;
+  }
+
+ private:
+  template <typename U>
+  static U round_up(U value) {
+    return (value + huge_page_size - 1) / huge_page_size * huge_page_size;
+  }
+};
+
+}  // namespace memory
+}  // namespace kepler
+
+#undef KEPLER_MEMORY_X86
+#undef KEPLER_MEMORY_POSIX
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef KEPLER_PARTITION_HPP
+#define KEPLER_PARTITION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/reduction.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/stats.hpp"
+#include "xsimd/xsimd.hpp"
+
+// A regime-partitioned version of the `raposo_pulido_brandt` starter with the
+// `brandt` refiner. For e >= 0.78, both of these branch on the reduced mean
+// anomaly: the starter uses a singular corner expansion for small M instead of
+// the table lookup, and the refiner takes a third order step for M <= 0.4
+// instead of a second order step. A SIMD batch that straddles either boundary
+// has to evaluate both branches and select between them. Instead, a cheap
+// classification pass counts the reduced mean anomalies in each of the three
+// possible regimes, their indices are sorted by regime into a single buffer,
+// and every regime is solved with a single branch-free kernel before the
+// results are scattered back. Since no batch
+// mixes the refiner's branches, the sine and cosine are also rotated through
+// the final step, like the scalar refiner does, rather than being recomputed.
+
+namespace kepler {
+namespace partition {
+
+namespace xs = xsimd;
+
+namespace detail {
+
+enum regime : int {
+  lookup_second_order,
+  lookup_third_order,
+  singular_third_order,
+  num_regimes
+};
+
+// The reduced mean anomalies, in their original order. The solution is
+// unfolded from the reduced frame using E = offset + sign * E_r and
+// sin(E) = sign * sin(E_r).
+template <typename T>
+struct reduced {
+  std::vector<T> mean_anomaly, sign, offset;
+
+  explicit reduced(std::size_t size) : mean_anomaly(size), sign(size), offset(size) {}
+};
+
+// This matches the branches in `raposo_pulido_brandt::start` and
+// `brandt::refine` for eccentricities above 0.78
+template <typename T>
+inline regime classify(const T& ome, const T& mean_anomaly) {
+  if (mean_anomaly > T(0.4)) return lookup_second_order;
+  if (T(2.) * mean_anomaly + ome > T(0.2)) return lookup_third_order;
+  return singular_third_order;
+}
+
+template <typename T>
+inline void count_regime(std::size_t* counts, const T& ome, const T& mean_anomaly) {
+  auto r = classify(ome, mean_anomaly);
+  stats::record_singular(r == singular_third_order);
+  stats::record_brandt(r == lookup_second_order);
+  ++counts[r];
+}
+
+// Solve the `size` elements of one regime, whose indices are listed in `index`
+template <int starter_regime, int order, typename T>
+inline void solve_regime(const starters::raposo_pulido_brandt<T>& starter,
+                         const T& eccentricity, const reduced<T>& r, const std::size_t* index,
+                         std::size_t size, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                         T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  using A = typename B::arch_type;
+  constexpr std::size_t simd_size = B::size;
+
+  alignas(A::alignment()) T M[simd_size], E[simd_size], s[simd_size], c[simd_size];
+  for (std::size_t j = 0; j < size; j += simd_size) {
+    // The last batch is padded with copies of the last element, and the
+    // padding lanes are never written out
+    std::size_t count = std::min(simd_size, size - j);
+    for (std::size_t k = 0; k < simd_size; ++k) {
+      M[k] = r.mean_anomaly[index[j + std::min(k, count - 1)]];
+    }
+
+    auto mean_anom = B::load_aligned(M);
+    auto ecc_anom = starter_regime == singular_third_order ? starter.singular(mean_anom)
+                                                           : starter.lookup(mean_anom);
+    B sin_ecc_anom, cos_ecc_anom;
+    ecc_anom = refiners::detail::brandt_step<order>(eccentricity, mean_anom, ecc_anom,
+                                                    &sin_ecc_anom, &cos_ecc_anom);
+    ecc_anom.store_aligned(E);
+    sin_ecc_anom.store_aligned(s);
+    cos_ecc_anom.store_aligned(c);
+
+    for (std::size_t k = 0; k < count; ++k) {
+      auto i = index[j + k];
+      auto sgn = r.sign[i];
+      stats::record_solution(eccentricity, M[k], E[k], s[k], c[k]);
+      eccentric_anomaly[i] = math::fma(sgn, E[k], r.offset[i]);
+      sin_eccentric_anomaly[i] = sgn * s[k];
+      cos_eccentric_anomaly[i] = c[k];
+    }
+  }
+}
+
+template <typename T>
+inline void solve(const starters::raposo_pulido_brandt<T>& starter, const T& eccentricity,
+                  std::size_t size, const T* mean_anomaly, T* eccentric_anomaly,
+                  T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+  const T ome = T(1.) - eccentricity;
+
+  // The classification pass reduces the mean anomalies in batches, and counts
+  // the elements in each regime
+  reduced<T> r(size);
+  std::size_t counts[num_regimes] = {};
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    auto mean_anom = B::load_unaligned(&mean_anomaly[i]);
+    auto sgn = xs::copysign(B(T(1.)), mean_anom);
+    B mean_anom_reduc;
+    auto high = reduction::range_reduce(xs::abs(mean_anom), mean_anom_reduc);
+    mean_anom_reduc.store_unaligned(&r.mean_anomaly[i]);
+    xs::select(high, -sgn, sgn).store_unaligned(&r.sign[i]);
+    xs::select(high, constants::twopi<T>() * sgn, B(T(0.))).store_unaligned(&r.offset[i]);
+    for (std::size_t k = 0; k < simd_size; ++k) count_regime(counts, ome, r.mean_anomaly[i + k]);
+  }
+  for (std::size_t i = vec_size; i < size; ++i) {
+    auto sgn = std::copysign(T(1.), mean_anomaly[i]);
+    bool high = reduction::range_reduce(std::abs(mean_anomaly[i]), r.mean_anomaly[i]);
+    r.sign[i] = high ? -sgn : sgn;
+    r.offset[i] = high ? constants::twopi<T>() * sgn : T(0.);
+    count_regime(counts, ome, r.mean_anomaly[i]);
+  }
+
+  // Then the indices are sorted by regime into a single buffer, with the
+  // regimes in contiguous ranges
+  std::size_t begin[num_regimes + 1] = {};
+  for (int n = 0; n < num_regimes; ++n) begin[n + 1] = begin[n] + counts[n];
+  std::size_t next[num_regimes];
+  std::copy(begin, begin + num_regimes, next);
+  std::vector<std::size_t> index(size);
+  for (std::size_t i = 0; i < size; ++i) index[next[classify(ome, r.mean_anomaly[i])]++] = i;
+
+  solve_regime<lookup_second_order, 2>(starter, eccentricity, r,
+                                       index.data() + begin[lookup_second_order],
+                                       counts[lookup_second_order], eccentric_anomaly,
+                                       sin_eccentric_anomaly, cos_eccentric_anomaly);
+  solve_regime<lookup_third_order, 3>(starter, eccentricity, r,
+                                      index.data() + begin[lookup_third_order],
+                                      counts[lookup_third_order], eccentric_anomaly,
+                                      sin_eccentric_anomaly, cos_eccentric_anomaly);
+  solve_regime<singular_third_order, 3>(starter, eccentricity, r,
+                                        index.data() + begin[singular_third_order],
+                                        counts[singular_third_order], eccentric_anomaly,
+                                        sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+}  // namespace detail
+
+// Solve Kepler's equation with the `raposo_pulido_brandt` starter and `brandt`
+// refiner, partitioning the mean anomalies by regime. Below e = 0.78 there is
+// only one regime, so this is the same as `solver::solve_simd`.
+template <typename T>
+inline void solve(const T& eccentricity, std::size_t size, const T* mean_anomaly,
+                  T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  using starter_type = starters::raposo_pulido_brandt<T>;
+  using refiner_type = refiners::brandt<T>;
+  if (eccentricity < T(0.78)) {
+    solver::solve_simd<starter_type, refiner_type>(eccentricity, size, mean_anomaly,
+                                                   eccentric_anomaly, sin_eccentric_anomaly,
+                                                   cos_eccentric_anomaly);
+  } else {
+    stats::record_call(size);
+    const starter_type starter(eccentricity);
+    detail::solve(starter, eccentricity, size, mean_anomaly, eccentric_anomaly,
+                  sin_eccentric_anomaly, cos_eccentric_anomaly);
+  }
+}
+
+}  // namespace partition
+}  // namespace kepler
+
+#endif
@@ -1,11 +1,14 @@
 #ifndef KEPLER_REDUCTION_HPP
 #define KEPLER_REDUCTION_HPP
 
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
 
 #include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/math.hpp"
 #include "xsimd/xsimd.hpp"
 
 namespace kepler {
@@ -48,6 +51,186 @@ inline double quadrant(const double& x) noexcept {
   return 4. * (a - floor(a));
 }
 
+// Payne-Hanek reduction for arguments beyond `mediumpi`, where the Cody-Waite
+// reduction above runs out of bits. The argument is split into three D-bit
+// integer digits, and multiplied exactly by the D-bit digits of 2/pi, starting
+// from the first digit that contributes to the result modulo 4. The products
+// are accumulated with carries in floating point, so every operation is exact
+// until the final fraction is assembled, and the same fixed sequence of
+// operations is used for every argument so it vectorizes directly.
+template <typename T>
+struct payne_hanek_traits;
+
+template <>
+struct payne_hanek_traits<double> {
+  static constexpr int digit_bits = 24;
+  static constexpr int num_digits = 7;
+  static constexpr int mantissa_bits = 52;
+  static constexpr int exponent_bias = 1023;
+
+  // The 24-bit digits of 2/pi, with leading zero padding
+  static constexpr double table[] = {
+      0x000000, 0x000000, 0x000000,
+      0xA2F983, 0x6E4E44, 0x1529FC, 0x2757D1, 0xF534DD, 0xC0DB62, 0x95993C, 0x439041,
+      0xFE5163, 0xABDEBB, 0xC561B7, 0x246E3A, 0x424DD2, 0xE00649, 0x2EEA09, 0xD1921C,
+      0xFE1DEB, 0x1CB129, 0xA73EE8, 0x8235F5, 0x2EBB44, 0x84E99C, 0x7026B4, 0x5F7E41,
+      0x3991D6, 0x398353, 0x39F49C, 0x845F8B, 0xBDF928, 0x3B1FF8, 0x97FFDE, 0x05980F,
+      0xEF2F11, 0x8B5A0A, 0x6D1F6D, 0x367ECF, 0x27CB09, 0xB74F46, 0x3F669E, 0x5FEA2D,
+      0x7527BA, 0xC7EBE5, 0xF17B3D, 0x0739F7, 0x8A5292, 0xEA6BFB, 0x5FB11F, 0x8D5D08,
+  };
+};
+
+template <>
+struct payne_hanek_traits<float> {
+  static constexpr int digit_bits = 11;
+  static constexpr int num_digits = 8;
+  static constexpr int mantissa_bits = 23;
+  static constexpr int exponent_bias = 127;
+
+  // The 11-bit digits of 2/pi, with leading zero padding
+  static constexpr float table[] = {
+      0x000, 0x000, 0x000,
+      0x517, 0x660, 0x6DC, 0x4E4, 0x20A, 0x4A7, 0x784, 0x757, 0x68F,
+      0x54D, 0x1BB, 0x40D, 0x5B1, 0x256, 0x327, 0x443, 0x482, 0x07F,
+  };
+};
+
+// NOTE: only valid for finite x > mediumpi
+template <typename T>
+inline T payne_hanek(const T& x, T& xr) noexcept {
+  using traits = payne_hanek_traits<T>;
+  constexpr int D = traits::digit_bits;
+  constexpr int K = traits::num_digits;
+  const T radix = T(1 << D);
+  const T inv_radix = T(1.) / radix;
+
+  // Split x into three D-bit digits: x = (x0 + x1 / 2^D + x2 / 2^2D) * 2^e0
+  const int e0 = std::ilogb(x) - (D - 1);
+  T z = std::ldexp(x, -e0);
+  const T x0 = std::floor(z);
+  z = (z - x0) * radix;
+  const T x1 = std::floor(z);
+  const T x2 = (z - x1) * radix;
+
+  // The digits of 2/pi before j0 only contribute multiples of 4
+  const int j0 = e0 >= 3 ? (e0 - 3) / D : -((D + 2 - e0) / D);
+  const T* c = traits::table + j0 + 1;
+  T q[K];
+  for (int k = 0; k < K; ++k) {
+    q[k] = x0 * c[k + 2] + x1 * c[k + 1] + x2 * c[k];
+  }
+  for (int k = K - 1; k > 0; --k) {
+    T carry = std::floor(q[k] * inv_radix);
+    q[k] -= carry * radix;
+    q[k - 1] += carry;
+  }
+
+  // The integer part modulo 4 comes from the first two digits
+  T w = std::ldexp(T(1.), e0 - D * (j0 + 1));
+  T a = q[0] * w;
+  a -= T(4.) * std::floor(T(0.25) * a);
+  w *= inv_radix;
+  a += q[1] * w;
+  a -= T(4.) * std::floor(T(0.25) * a);
+  T n = std::floor(a);
+  a -= n;
+  if (a >= T(0.5)) {
+    n += T(1.);
+    a -= T(1.);
+  }
+
+  // The remaining digits don't overlap so they can be summed exactly into a
+  // double-length fraction, starting from the least significant
+  T wk[K];
+  wk[1] = w;
+  for (int k = 2; k < K; ++k) wk[k] = wk[k - 1] * inv_radix;
+  T lo = T(0.), err;
+  T hi = q[K - 1] * wk[K - 1];
+  for (int k = K - 2; k > 1; --k) {
+    hi = math::two_sum(q[k] * wk[k], hi, err);
+    lo += err;
+  }
+  hi = math::two_sum(a, hi, err);
+  lo += err;
+
+  xr = hi * constants::pio2<T>() + (lo * constants::pio2<T>() + hi * constants::pio2_lo<T>());
+  return n - T(4.) * std::floor(T(0.25) * n);
+}
+
+template <typename A, typename T>
+inline xs::batch<T, A> payne_hanek(const xs::batch<T, A>& x, xs::batch<T, A>& xr) noexcept {
+  using B = xs::batch<T, A>;
+  using I = xs::as_integer_t<B>;
+  using IT = typename I::value_type;
+  using traits = payne_hanek_traits<T>;
+  constexpr int D = traits::digit_bits;
+  constexpr int K = traits::num_digits;
+  const B radix(T(1 << D));
+  const B inv_radix(T(1.) / T(1 << D));
+  const I bias(IT(traits::exponent_bias));
+
+  auto pow2 = [&](const I& e) {
+    return xs::bitwise_cast<T>((e + bias) << traits::mantissa_bits);
+  };
+
+  // Split x into three D-bit digits: x = (x0 + x1 / 2^D + x2 / 2^2D) * 2^e0
+  auto e0 = (xs::bitwise_cast<IT>(x) >> traits::mantissa_bits) -
+            I(IT(traits::exponent_bias + D - 1));
+  auto z = x * pow2(-e0);
+  auto x0 = xs::floor(z);
+  z = (z - x0) * radix;
+  auto x1 = xs::floor(z);
+  auto x2 = (z - x1) * radix;
+
+  // The digits of 2/pi before j0 only contribute multiples of 4
+  auto j0 =
+      xs::batch_cast<IT>(xs::floor((xs::batch_cast<T>(e0) - B(T(2.5))) * B(T(1.) / T(D))));
+  auto idx = j0 + I(IT(1));
+  std::array<B, K + 2> c;
+  for (int k = 0; k < K + 2; ++k) {
+    c[k] = B::gather(traits::table, idx + I(IT(k)));
+  }
+  std::array<B, K> q;
+  for (int k = 0; k < K; ++k) {
+    q[k] = x0 * c[k + 2] + x1 * c[k + 1] + x2 * c[k];
+  }
+  for (int k = K - 1; k > 0; --k) {
+    auto carry = xs::floor(q[k] * inv_radix);
+    q[k] -= carry * radix;
+    q[k - 1] += carry;
+  }
+
+  // The integer part modulo 4 comes from the first two digits
+  auto w = pow2(e0 - I(IT(D)) * (j0 + I(IT(1))));
+  auto a = q[0] * w;
+  a -= B(T(4.)) * xs::floor(B(T(0.25)) * a);
+  w *= inv_radix;
+  a += q[1] * w;
+  a -= B(T(4.)) * xs::floor(B(T(0.25)) * a);
+  auto n = xs::floor(a);
+  a -= n;
+  auto up = a >= B(T(0.5));
+  n = xs::select(up, n + B(T(1.)), n);
+  a = xs::select(up, a - B(T(1.)), a);
+
+  // The remaining digits don't overlap so they can be summed exactly into a
+  // double-length fraction, starting from the least significant
+  std::array<B, K> wk;
+  wk[1] = w;
+  for (int k = 2; k < K; ++k) wk[k] = wk[k - 1] * inv_radix;
+  B lo(T(0.)), err;
+  B hi = q[K - 1] * wk[K - 1];
+  for (int k = K - 2; k > 1; --k) {
+    hi = math::two_sum(q[k] * wk[k], hi, err);
+    lo += err;
+  }
+  hi = math::two_sum(a, hi, err);
+  lo += err;
+
+  xr = hi * constants::pio2<B>() + (lo * constants::pio2<B>() + hi * constants::pio2_lo<B>());
+  return n - B(T(4.)) * xs::floor(B(T(0.25)) * n);
+}
+
 template <typename T>
 inline T trig_reduce(const T& x, T& xr) noexcept {
   if (x <= constants::pio4<T>()) {
@@ -78,19 +261,34 @@ inline T trig_reduce(const T& x, T& xr) noexcept {
     w = fn * constants::pio2_3t<T>() - ((t - r) - w);
     xr = r - w;
     return quadrant(fn);
-  } else {
-    T n;
-    if (x == std::numeric_limits<T>::infinity()) {
-      n = T(0.);
-      xr = std::numeric_limits<T>::quiet_NaN();
-    } else {
-      double y[2];
-      std::int32_t n_ = xsimd::detail::__ieee754_rem_pio2(x, y);
-      n = T(n_ & 3);
-      xr = T(y[0]);
-    }
-    return n;
+  } else if (std::isfinite(x)) {
+    return payne_hanek(x, xr);
+  }
+  xr = std::numeric_limits<T>::quiet_NaN();
+  return T(0.);
+}
+
+template <typename A, typename T>
+inline xs::batch<T, A> trig_reduce(const xs::batch<T, A>& x, xs::batch<T, A>& xr) noexcept {
+  using B = xs::batch<T, A>;
+  auto large = x > constants::mediumpi<B>();
+  if (xs::none(large)) return xs::kernel::detail::trigo_reducer<B>::reduce(x, xr);
+
+  // xsimd falls back on a scalar reduction for any lane beyond mediumpi, so we
+  // handle those lanes with the vectorized Payne-Hanek reduction instead
+  auto finite = xs::isfinite(x);
+  B xr_large;
+  auto n_large = payne_hanek(xs::select(large & finite, x, constants::twopi<B>()), xr_large);
+  xr_large = xs::select(finite, xr_large, B(std::numeric_limits<T>::quiet_NaN()));
+  if (xs::all(large)) {
+    xr = xr_large;
+    return n_large;
   }
+  B xr_small;
+  auto n_small =
+      xs::kernel::detail::trigo_reducer<B>::reduce(xs::select(large, B(T(0.)), x), xr_small);
+  xr = xs::select(large, xr_large, xr_small);
+  return xs::select(large, n_large, n_small);
 }
 
 }  // namespace detail
@@ -112,7 +310,7 @@ inline bool range_reduce(const T& x, T& xr) noexcept {
 template <typename A, typename T>
 inline xs::batch_bool<T, A> range_reduce(xs::batch<T, A> const& x, xs::batch<T, A>& xr) noexcept {
   using B = xs::batch<T, A>;
-  auto quad = xs::kernel::detail::trigo_reducer<B>::reduce(x, xr);
+  auto quad = detail::trig_reduce(x, xr);
   xr = xs::fma(quad, constants::pio2<B>(), xr);
   auto lo = xr < B(0.);
   auto hi = xr >= constants::pi<B>();
@@ -120,6 +318,64 @@ inline xs::batch_bool<T, A> range_reduce(xs::batch<T, A> const& x, xs::batch<T,
   return hi | lo;
 }
 
+// Mean anomalies stored as an unsigned fixed-point fraction of a full orbit,
+// M = 2 pi phase / 2^N for an N-bit phase, can be reduced exactly using
+// integer arithmetic: the top bit selects the half orbit and reflecting the
+// second half is just a two's complement negation. The only rounding happens
+// in the final conversion to floating point.
+template <typename T, typename U>
+inline bool phase_reduce(const U& phase, T& xr) noexcept {
+  static_assert(std::is_unsigned<U>::value, "phase must be an unsigned integer");
+  constexpr int bits = std::numeric_limits<U>::digits;
+  constexpr U half = U(1) << (bits - 1);
+  const bool high = phase >= half;
+  const U reduced = high ? static_cast<U>(U(0) - phase) : phase;
+  constexpr T scale = T(0.5) / T(half);
+  xr = constants::twopi<T>() * (scale * T(reduced));
+  return high;
+}
+
+namespace detail {
+
+// When the phase has the same width as T, the lanes of an integer batch line
+// up with those of a floating point batch. Read as a signed integer, the phase
+// is negative exactly in the second half of the orbit, and its magnitude is
+// the reduced phase; the conversion rounds symmetrically, so taking the
+// absolute value afterwards gives the same result as the scalar reduction,
+// including for the most negative integer.
+template <typename A, typename T, typename U>
+inline xs::batch_bool<T, A> phase_reduce(const U* phase, xs::batch<T, A>& xr,
+                                         std::true_type) noexcept {
+  using B = xs::batch<T, A>;
+  using I = xs::as_integer_t<B>;
+  using IT = typename I::value_type;
+  constexpr T scale = T(0.5) / T(U(1) << (std::numeric_limits<U>::digits - 1));
+  auto value = xs::batch_cast<T>(I::load_unaligned(reinterpret_cast<const IT*>(phase)));
+  xr = constants::twopi<B>() * (B(scale) * xs::abs(value));
+  return value < B(T(0.));
+}
+
+// Otherwise the lanes are reduced one at a time
+template <typename A, typename T, typename U>
+inline xs::batch_bool<T, A> phase_reduce(const U* phase, xs::batch<T, A>& xr,
+                                         std::false_type) noexcept {
+  using B = xs::batch<T, A>;
+  alignas(A::alignment()) std::array<T, B::size> val, flag;
+  for (std::size_t n = 0; n < B::size; ++n) {
+    flag[n] = reduction::phase_reduce(phase[n], val[n]) ? T(1.) : T(0.);
+  }
+  xr = B::load_aligned(val.data());
+  return B::load_aligned(flag.data()) != B(0.);
+}
+
+}  // namespace detail
+
+template <typename A, typename T, typename U>
+inline xs::batch_bool<T, A> phase_reduce(const U* phase, xs::batch<T, A>& xr) noexcept {
+  static_assert(std::is_unsigned<U>::value, "phase must be an unsigned integer");
+  return detail::phase_reduce(phase, xr, std::integral_constant<bool, sizeof(U) == sizeof(T)>());
+}
+
 }  // namespace reduction
 }  // namespace kepler
 #endif
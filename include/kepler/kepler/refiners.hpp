@@ -6,6 +6,7 @@
 #include "kepler/kepler/constants.hpp"
 #include "kepler/kepler/householder.hpp"
 #include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/stats.hpp"
 #include "xsimd/xsimd.hpp"
 
 namespace kepler {
@@ -55,11 +56,14 @@ struct iterative : detail::_refiner<T> {
   inline T refine(const T& eccentricity, const T& mean_anomaly,
                   const T& initial_eccentric_anomaly) const {
     T eccentric_anomaly = initial_eccentric_anomaly;
-    for (int i = 0; i < max_iterations; ++i) {
+    int i;
+    for (i = 0; i < max_iterations; ++i) {
       auto state = householder::init(eccentricity, mean_anomaly, eccentric_anomaly);
       if (std::abs(state.f0) < tolerance) break;
+      stats::record_iterations(true);
       eccentric_anomaly += householder::step<order>(state);
     }
+    stats::record_max_iterations(i == max_iterations);
     return eccentric_anomaly;
   }
 
@@ -73,9 +77,12 @@ struct iterative : detail::_refiner<T> {
       auto state = householder::init(eccentricity, mean_anomaly, eccentric_anomaly);
       converged = converged | (xs::abs(state.f0) < B(tolerance));
       if (xs::all(converged)) break;
+      stats::record_iterations(!converged);
+      stats::record_iteration_batch();
       auto delta = householder::step<order>(state);
       eccentric_anomaly = xs::select(converged, eccentric_anomaly, eccentric_anomaly + delta);
     }
+    stats::record_max_iterations(!converged);
     return eccentric_anomaly;
   }
 };
@@ -126,7 +133,9 @@ template <typename T>
 struct brandt : detail::_refiner<T> {
   inline T refine(const T& eccentricity, const T& mean_anomaly,
                   const T& initial_eccentric_anomaly) const {
-    if (eccentricity < T(0.78) || mean_anomaly > T(0.4)) {
+    bool flag = eccentricity < T(0.78) || mean_anomaly > T(0.4);
+    stats::record_brandt(flag);
+    if (flag) {
       return detail::_non_iterative_step<2>(eccentricity, mean_anomaly, initial_eccentric_anomaly);
     } else {
       return detail::_non_iterative_step<3>(eccentricity, mean_anomaly, initial_eccentric_anomaly);
@@ -138,6 +147,7 @@ struct brandt : detail::_refiner<T> {
                                 const xs::batch<T, A>& initial_eccentric_anomaly) const {
     using B = xs::batch<T, A>;
     auto flag = typename B::batch_bool_type(eccentricity < T(0.78)) | (mean_anomaly > B(T(0.4)));
+    stats::record_brandt(flag);
     if (xs::all(flag)) {
       return detail::_non_iterative_step<2>(eccentricity, mean_anomaly, initial_eccentric_anomaly);
     } else if (xs::none(flag)) {
@@ -152,6 +162,36 @@ struct brandt : detail::_refiner<T> {
   }
 };
 
+namespace detail {
+
+// The second and third order steps used by `brandt`, where the sine and cosine
+// of the result are found by rotating the values from the Householder state
+// through the (small) step, rather than being evaluated directly
+template <int order, typename T, typename V>
+inline V brandt_step(const T& eccentricity, const V& mean_anomaly,
+                     const V& initial_eccentric_anomaly, V* sin_eccentric_anomaly,
+                     V* cos_eccentric_anomaly) {
+  static_assert(order == 2 || order == 3, "brandt only uses second and third order steps");
+  auto state = householder::init(eccentricity, mean_anomaly, initial_eccentric_anomaly);
+  auto delta = householder::step<order>(state);
+  V factor1, factor2;
+  if (order == 2) {
+    factor1 = math::fma(V(T(-0.5)) * delta, delta, V(T(1.)));
+    factor2 = delta;
+  } else {
+    auto factor = constants::sixth<V>() * delta * delta;
+    factor1 = math::fnma(V(T(3.)), factor, V(T(1.)));
+    factor2 = math::fnma(delta, factor, delta);
+  }
+  *sin_eccentric_anomaly =
+      math::fma(factor1, state.ecc_sin, factor2 * state.ecc_cos) / V(eccentricity);
+  *cos_eccentric_anomaly =
+      math::fnma(factor2, state.ecc_sin, factor1 * state.ecc_cos) / V(eccentricity);
+  return initial_eccentric_anomaly + delta;
+}
+
+}  // namespace detail
+
 template <typename R>
 struct refine_with_eccentricity : detail::_refiner<typename R::value_type> {
   using T = typename R::value_type;
@@ -179,25 +219,13 @@ struct refine_with_eccentricity<brandt<T>> : detail::_refiner<T> {
       *cos_eccentric_anomaly = sincos.second;
       return initial_eccentric_anomaly;
     } else if (eccentricity < T(0.78) || mean_anomaly > T(0.4)) {
-      auto state = householder::init(eccentricity, mean_anomaly, initial_eccentric_anomaly);
-      auto delta = householder::step<2>(state);
-      auto factor = math::fma(T(-0.5) * delta, delta, T(1.));
-      *sin_eccentric_anomaly =
-          math::fma(factor, state.ecc_sin, delta * state.ecc_cos) / eccentricity;
-      *cos_eccentric_anomaly =
-          math::fnma(delta, state.ecc_sin, factor * state.ecc_cos) / eccentricity;
-      return initial_eccentric_anomaly + delta;
+      stats::record_brandt(true);
+      return detail::brandt_step<2>(eccentricity, mean_anomaly, initial_eccentric_anomaly,
+                                    sin_eccentric_anomaly, cos_eccentric_anomaly);
     } else {
-      auto state = householder::init(eccentricity, mean_anomaly, initial_eccentric_anomaly);
-      auto delta = householder::step<3>(state);
-      auto factor = constants::sixth<T>() * delta * delta;
-      auto factor1 = math::fnma(T(3.), factor, T(1.));
-      auto factor2 = math::fnma(delta, factor, delta);
-      *sin_eccentric_anomaly =
-          math::fma(factor1, state.ecc_sin, factor2 * state.ecc_cos) / eccentricity;
-      *cos_eccentric_anomaly =
-          math::fnma(factor2, state.ecc_sin, factor1 * state.ecc_cos) / eccentricity;
-      return initial_eccentric_anomaly + delta;
+      stats::record_brandt(false);
+      return detail::brandt_step<3>(eccentricity, mean_anomaly, initial_eccentric_anomaly,
+                                    sin_eccentric_anomaly, cos_eccentric_anomaly);
     }
   }
 
@@ -1,14 +1,21 @@
 #ifndef KEPLER_SOLVER_HPP
 #define KEPLER_SOLVER_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <type_traits>
 
 #include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/householder.hpp"
+#include "kepler/kepler/math.hpp"
+#include "kepler/kepler/memory.hpp"
 #include "kepler/kepler/reduction.hpp"
 #include "kepler/kepler/refiners.hpp"
 #include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/stats.hpp"
 #include "xsimd/xsimd.hpp"
 
 namespace kepler {
@@ -23,22 +30,107 @@ struct value_type {
   typedef typename A::value_type type;
 };
 
+namespace detail {
+
+// The kernels below solve Kepler's equation for a reduced mean anomaly in the
+// range [0, pi], returning the reduced eccentric anomaly and setting its sine
+// and cosine. They are templated on the argument type so that the same kernel
+// is used for the SIMD loop and for the scalar tail.
+
 template <typename Starter, typename Refiner>
-inline void solve_one(const typename value_type<Starter, Refiner>::type& eccentricity,
-                      const typename value_type<Starter, Refiner>::type& mean_anomaly,
-                      typename value_type<Starter, Refiner>::type& eccentric_anomaly,
-                      typename value_type<Starter, Refiner>::type& sin_eccentric_anomaly,
-                      typename value_type<Starter, Refiner>::type& cos_eccentric_anomaly,
-                      const Refiner& refiner, const Starter& starter) {
+struct starter_refiner_kernel {
   using T = typename value_type<Starter, Refiner>::type;
+  const T& eccentricity;
+  const Starter& starter;
+  const Refiner& refiner;
+
+  template <typename V>
+  inline V operator()(const V& mean_anomaly, V* sin_eccentric_anomaly,
+                      V* cos_eccentric_anomaly) const {
+    auto ecc_anom = starter.start(mean_anomaly);
+    ecc_anom = refiners::refine_with_eccentricity<Refiner>::refine(
+        refiner, eccentricity, mean_anomaly, ecc_anom, sin_eccentric_anomaly,
+        cos_eccentric_anomaly);
+    stats::record_solution(eccentricity, mean_anomaly, ecc_anom, *sin_eccentric_anomaly,
+                           *cos_eccentric_anomaly);
+    return ecc_anom;
+  }
+};
+
+// For eccentricities below `constants::low_eccentricity`, the series
+//
+//   E = M + e sin(M) + e^2 sin(2M) / 2 + e^3 (3 sin(3M) - sin(M)) / 8
+//
+// is exact to working precision. Since E - M is tiny, the sine and cosine of E
+// are then computed by rotating (sin(M), cos(M)) through that small angle.
+template <typename T>
+struct low_eccentricity_kernel {
+  const T& eccentricity;
+
+  template <typename V>
+  inline V operator()(const V& mean_anomaly, V* sin_eccentric_anomaly,
+                      V* cos_eccentric_anomaly) const {
+    auto sincos = math::sincos(mean_anomaly);
+    auto ecc_anom = evaluate(mean_anomaly, sincos.first, sincos.second, sin_eccentric_anomaly,
+                             cos_eccentric_anomaly);
+    stats::record_solution(eccentricity, mean_anomaly, ecc_anom, *sin_eccentric_anomaly,
+                           *cos_eccentric_anomaly);
+    return ecc_anom;
+  }
+
+  // The same, but for when the sine and cosine of M are already known
+  template <typename V>
+  inline V evaluate(const V& mean_anomaly, const V& s, const V& c, V* sin_eccentric_anomaly,
+                    V* cos_eccentric_anomaly) const {
+    auto e = V(eccentricity);
+    auto factor = math::fma(e, math::fma(e, math::fnma(V(T(1.5)) * s, s, V(T(1.))), c), V(T(1.)));
+    auto delta = e * s * factor;
+    auto cos_delta = math::fnma(V(T(0.5)) * delta, delta, V(T(1.)));
+    auto sin_delta = math::fnma(constants::sixth<V>() * delta * delta, delta, delta);
+    *sin_eccentric_anomaly = math::fma(s, cos_delta, c * sin_delta);
+    *cos_eccentric_anomaly = math::fnma(s, sin_delta, c * cos_delta);
+    return mean_anomaly + delta;
+  }
+};
+
+// Call `func(kernel)` with the kernel for a single eccentricity: the series
+// above for eccentricities below `constants::low_eccentricity`, and the
+// starter and refiner otherwise. The first version takes a starter that has
+// already been set up for `eccentricity`, and the second only constructs one
+// when it is needed.
+template <typename Starter, typename Refiner, typename T, typename Func>
+inline void with_kernel(const T& eccentricity, const Starter& starter, const Refiner& refiner,
+                        Func&& func) {
+  if (eccentricity < constants::low_eccentricity<T>()) {
+    const low_eccentricity_kernel<T> kernel{eccentricity};
+    func(kernel);
+  } else {
+    const starter_refiner_kernel<Starter, Refiner> kernel{eccentricity, starter, refiner};
+    func(kernel);
+  }
+}
+
+template <typename Starter, typename Refiner, typename T, typename Func>
+inline void with_kernel(const T& eccentricity, const Refiner& refiner, Func&& func) {
+  if (eccentricity < constants::low_eccentricity<T>()) {
+    const low_eccentricity_kernel<T> kernel{eccentricity};
+    func(kernel);
+  } else {
+    const Starter starter(eccentricity);
+    const starter_refiner_kernel<Starter, Refiner> kernel{eccentricity, starter, refiner};
+    func(kernel);
+  }
+}
+
+template <typename T, typename Kernel>
+inline void solve_one(const Kernel& kernel, const T& mean_anomaly, T& eccentric_anomaly,
+                      T& sin_eccentric_anomaly, T& cos_eccentric_anomaly) {
   auto abs_mean_anom = std::abs(mean_anomaly);
   auto sgn = std::copysign(T(1.), mean_anomaly);
   T mean_anom_reduc;
   bool high = reduction::range_reduce(abs_mean_anom, mean_anom_reduc);
-  auto ecc_anom_reduc = starter.start(mean_anom_reduc);
   T s, c;
-  ecc_anom_reduc = refiners::refine_with_eccentricity<Refiner>::refine(
-      refiner, eccentricity, mean_anom_reduc, ecc_anom_reduc, &s, &c);
+  auto ecc_anom_reduc = kernel(mean_anom_reduc, &s, &c);
   if (high) {
     eccentric_anomaly = sgn * (constants::twopi<T>() - ecc_anom_reduc);
     sin_eccentric_anomaly = -sgn * s;
@@ -50,6 +142,584 @@ inline void solve_one(const typename value_type<Starter, Refiner>::type& eccentr
   }
 }
 
+template <typename A, typename T, typename Kernel>
+inline void solve_batch(const Kernel& kernel, const xs::batch<T, A>& mean_anomaly,
+                        xs::batch<T, A>& eccentric_anomaly, xs::batch<T, A>& sin_eccentric_anomaly,
+                        xs::batch<T, A>& cos_eccentric_anomaly) {
+  using B = xs::batch<T, A>;
+  auto sgn = xs::copysign(B(1.), mean_anomaly);
+  auto abs_mean_anom = xs::abs(mean_anomaly);
+  B mean_anom_reduc;
+  auto high = reduction::range_reduce(abs_mean_anom, mean_anom_reduc);
+  B s, c;
+  auto ecc_anom_reduc = kernel(mean_anom_reduc, &s, &c);
+  eccentric_anomaly =
+      sgn * xs::select(high, constants::twopi<T>() - ecc_anom_reduc, ecc_anom_reduc);
+  sin_eccentric_anomaly = sgn * s * xs::select(high, B(-1.), B(1.));
+  cos_eccentric_anomaly = c;
+}
+
+template <typename T, typename Kernel>
+inline void solve(const Kernel& kernel, std::size_t size, const T* mean_anomaly,
+                  T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  for (std::size_t i = 0; i < size; ++i) {
+    solve_one(kernel, mean_anomaly[i], eccentric_anomaly[i], sin_eccentric_anomaly[i],
+              cos_eccentric_anomaly[i]);
+  }
+}
+
+// Solve `count` elements, fewer than a full batch, with the batch kernel. The
+// batch is padded with copies of the last element, which are never written
+// out or recorded in the stats.
+template <typename T, typename Kernel>
+inline void solve_partial_batch(const Kernel& kernel, std::size_t count, const T* mean_anomaly,
+                                T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                                T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  using A = typename B::arch_type;
+  constexpr std::size_t simd_size = B::size;
+  if (count == 0) return;
+
+  alignas(A::alignment()) T M[simd_size], E[simd_size], s[simd_size], c[simd_size];
+  for (std::size_t k = 0; k < simd_size; ++k) M[k] = mean_anomaly[std::min(k, count - 1)];
+  B ecc_anom, sin_ecc_anom, cos_ecc_anom;
+  {
+    stats::lanes scope(count);
+    solve_batch(kernel, B::load_aligned(M), ecc_anom, sin_ecc_anom, cos_ecc_anom);
+  }
+  ecc_anom.store_aligned(E);
+  sin_ecc_anom.store_aligned(s);
+  cos_ecc_anom.store_aligned(c);
+  for (std::size_t k = 0; k < count; ++k) {
+    eccentric_anomaly[k] = E[k];
+    sin_eccentric_anomaly[k] = s[k];
+    cos_eccentric_anomaly[k] = c[k];
+  }
+}
+
+// The streaming version of `solve_simd`; see memory.hpp. Non-temporal stores
+// must be aligned, so the elements before the first aligned output are solved
+// as a partial batch. Every element is solved by the same kernel, batch or
+// scalar, as in the default version, so the results don't depend on the mode
+// or on the alignment of the buffers. If the three outputs can't be aligned at
+// the same index, ordinary stores are used, but the mean anomalies are still
+// prefetched.
+template <typename T, typename Kernel>
+inline void solve_simd_streaming(const Kernel& kernel, std::size_t size, const T* mean_anomaly,
+                                 T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                                 T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  using A = typename B::arch_type;
+  constexpr std::size_t simd_size = B::size;
+  constexpr std::size_t alignment = A::alignment();
+  constexpr std::size_t prefetch_ahead = memory::prefetch_distance / sizeof(T);
+  std::size_t vec_size = size - size % simd_size;
+
+  auto offset = [](const T* ptr) { return reinterpret_cast<std::uintptr_t>(ptr) % alignment; };
+  const bool aligned = offset(eccentric_anomaly) % sizeof(T) == 0 &&
+                       offset(sin_eccentric_anomaly) == offset(eccentric_anomaly) &&
+                       offset(cos_eccentric_anomaly) == offset(eccentric_anomaly);
+  std::size_t head = 0;
+  if (aligned) {
+    head = std::min(vec_size, (alignment - offset(eccentric_anomaly)) % alignment / sizeof(T));
+  }
+  std::size_t vec_end = head + (vec_size - head) / simd_size * simd_size;
+
+  solve_partial_batch(kernel, head, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                      cos_eccentric_anomaly);
+
+  for (std::size_t i = head; i < vec_end; i += simd_size) {
+    if (i + prefetch_ahead < size) memory::prefetch(&mean_anomaly[i + prefetch_ahead]);
+    auto mean_anom = B::load_unaligned(&mean_anomaly[i]);
+    B ecc_anom, sin_ecc_anom, cos_ecc_anom;
+    solve_batch(kernel, mean_anom, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    if (aligned) {
+      memory::stream(&eccentric_anomaly[i], ecc_anom);
+      memory::stream(&sin_eccentric_anomaly[i], sin_ecc_anom);
+      memory::stream(&cos_eccentric_anomaly[i], cos_ecc_anom);
+    } else {
+      ecc_anom.store_unaligned(&eccentric_anomaly[i]);
+      sin_ecc_anom.store_unaligned(&sin_eccentric_anomaly[i]);
+      cos_ecc_anom.store_unaligned(&cos_eccentric_anomaly[i]);
+    }
+  }
+  memory::fence();
+
+  solve_partial_batch(kernel, vec_size - vec_end, &mean_anomaly[vec_end],
+                      &eccentric_anomaly[vec_end], &sin_eccentric_anomaly[vec_end],
+                      &cos_eccentric_anomaly[vec_end]);
+
+  for (std::size_t i = vec_size; i < size; ++i) {
+    solve_one(kernel, mean_anomaly[i], eccentric_anomaly[i], sin_eccentric_anomaly[i],
+              cos_eccentric_anomaly[i]);
+  }
+}
+
+template <typename Tag, typename T, typename Kernel>
+inline void solve_simd(const Kernel& kernel, std::size_t size, const T* mean_anomaly,
+                       T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly,
+                       std::true_type) {
+  solve_simd_streaming(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                       cos_eccentric_anomaly);
+}
+
+template <typename Tag, typename T, typename Kernel>
+inline void solve_simd(const Kernel& kernel, std::size_t size, const T* mean_anomaly,
+                       T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly,
+                       std::false_type) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    auto mean_anom = xs::load(&(mean_anomaly[i]), Tag());
+    B ecc_anom, sin_ecc_anom, cos_ecc_anom;
+    solve_batch(kernel, mean_anom, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    ecc_anom.store(&eccentric_anomaly[i], Tag());
+    sin_ecc_anom.store(&sin_eccentric_anomaly[i], Tag());
+    cos_ecc_anom.store(&cos_eccentric_anomaly[i], Tag());
+  }
+
+  for (std::size_t i = vec_size; i < size; ++i) {
+    solve_one(kernel, mean_anomaly[i], eccentric_anomaly[i], sin_eccentric_anomaly[i],
+              cos_eccentric_anomaly[i]);
+  }
+}
+
+// `Tag` is `xs::aligned_mode` or `xs::unaligned_mode` for the loads and stores,
+// or `memory::streaming_mode` for the streaming version above
+template <typename Tag, typename T, typename Kernel>
+inline void solve_simd(const Kernel& kernel, std::size_t size, const T* mean_anomaly,
+                       T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  solve_simd<Tag>(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                  cos_eccentric_anomaly, std::is_same<Tag, memory::streaming_mode>());
+}
+
+// Phase-based solvers for mean anomalies given as a fixed-point fraction of
+// an orbit; see `reduction::phase_reduce`. The eccentric anomaly is returned in
+// the range [0, 2 pi].
+template <typename T, typename U, typename Kernel>
+inline void solve_phase(const Kernel& kernel, std::size_t size, const U* phase,
+                        T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                        T* cos_eccentric_anomaly) {
+  for (std::size_t i = 0; i < size; ++i) {
+    T mean_anom_reduc;
+    bool high = reduction::phase_reduce(phase[i], mean_anom_reduc);
+    T s, c;
+    auto ecc_anom_reduc = kernel(mean_anom_reduc, &s, &c);
+    eccentric_anomaly[i] = high ? constants::twopi<T>() - ecc_anom_reduc : ecc_anom_reduc;
+    sin_eccentric_anomaly[i] = high ? -s : s;
+    cos_eccentric_anomaly[i] = c;
+  }
+}
+
+template <typename Tag, typename T, typename U, typename Kernel>
+inline void solve_phase_simd(const Kernel& kernel, std::size_t size, const U* phase,
+                             T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                             T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    B mean_anom_reduc;
+    auto high = reduction::phase_reduce(&(phase[i]), mean_anom_reduc);
+    B s, c;
+    auto ecc_anom_reduc = kernel(mean_anom_reduc, &s, &c);
+    auto ecc_anom = xs::select(high, constants::twopi<T>() - ecc_anom_reduc, ecc_anom_reduc);
+    auto sin_ecc_anom = xs::select(high, -s, s);
+    ecc_anom.store(&eccentric_anomaly[i], Tag());
+    sin_ecc_anom.store(&sin_eccentric_anomaly[i], Tag());
+    c.store(&cos_eccentric_anomaly[i], Tag());
+  }
+
+  solve_phase(kernel, size - vec_size, &(phase[vec_size]), &(eccentric_anomaly[vec_size]),
+              &(sin_eccentric_anomaly[vec_size]), &(cos_eccentric_anomaly[vec_size]));
+}
+
+// Continuation solvers for slowly varying mean anomalies, such as densely
+// sampled time series. Each eccentric anomaly is predicted from the previous
+// solution with a third order Householder step, reusing the sine and cosine of
+// the previous solution, and the sine and cosine are then rotated through the
+// (small) update without any calls to trig functions. A single Newton
+// correction polishes the result and gives an estimate of the remaining error.
+// If this estimate is too large, or if the update is too large for the small
+// angle rotation, we fall back on the full solver for that point. The full
+// solver is also used every `continuation_resync` points to bound the rounding
+// error that accumulates in the rotated sine and cosine.
+//
+// To avoid losing precision for large mean anomalies, the continuation works
+// in the reduced frame of the most recent full solve (the "anchor"), where the
+// local mean anomaly is `(M - anchor) + local_anchor`.
+constexpr std::size_t continuation_resync = 32;
+
+template <typename T, typename V>
+inline auto continuation_step(const T& eccentricity, const V& mean_anomaly,
+                              const V& prev_eccentric_anomaly, const V& prev_sin,
+                              const V& prev_cos, V& eccentric_anomaly, V& sin_eccentric_anomaly,
+                              V& cos_eccentric_anomaly) -> decltype(mean_anomaly < mean_anomaly) {
+  using std::abs;
+  const V ecc(eccentricity);
+  const householder::detail::state<V> state{
+      prev_eccentric_anomaly - ecc * prev_sin - mean_anomaly, ecc * prev_sin, ecc * prev_cos};
+  auto delta = householder::step<3>(state);
+  auto sincos = math::sincos_small(delta);
+  auto s = math::fma(prev_sin, sincos.second, prev_cos * sincos.first);
+  auto c = math::fnma(prev_sin, sincos.first, prev_cos * sincos.second);
+  auto ecc_anom = prev_eccentric_anomaly + delta;
+
+  auto ome_cos = V(T(1.)) - ecc * c;
+  auto correction = (mean_anomaly - ecc_anom + ecc * s) / ome_cos;
+  eccentric_anomaly = ecc_anom + correction;
+  sin_eccentric_anomaly = math::fma(c, correction, s);
+  cos_eccentric_anomaly = math::fnma(s, correction, c);
+
+  // After the Newton correction, the error is less than e dE^2 / (2 (1 - e cos(E)))
+  auto error = ecc * correction * correction;
+  return (abs(delta) <= constants::pio4<V>()) &
+         (error < V(std::numeric_limits<T>::epsilon()) * ome_cos);
+}
+
+// The anchors are solved in the reduced frame with E in [-pi, pi], rather than
+// being unfolded like in `solve_one`, so that no precision is lost near E = 2 pi
+template <typename T, typename Kernel>
+inline void solve_anchor(const Kernel& kernel, const T& mean_anomaly, T& local_anchor,
+                         T& eccentric_anomaly, T& sin_eccentric_anomaly,
+                         T& cos_eccentric_anomaly) {
+  auto sgn = std::copysign(T(1.), mean_anomaly);
+  T mean_anom_reduc;
+  if (reduction::range_reduce(std::abs(mean_anomaly), mean_anom_reduc)) sgn = -sgn;
+  T s;
+  auto ecc_anom_reduc = kernel(mean_anom_reduc, &s, &cos_eccentric_anomaly);
+  local_anchor = sgn * mean_anom_reduc;
+  eccentric_anomaly = sgn * ecc_anom_reduc;
+  sin_eccentric_anomaly = sgn * s;
+}
+
+template <typename A, typename T, typename Kernel>
+inline void solve_anchor(const Kernel& kernel, const xs::batch<T, A>& mean_anomaly,
+                         xs::batch<T, A>& local_anchor, xs::batch<T, A>& eccentric_anomaly,
+                         xs::batch<T, A>& sin_eccentric_anomaly,
+                         xs::batch<T, A>& cos_eccentric_anomaly) {
+  using B = xs::batch<T, A>;
+  auto sgn = xs::copysign(B(1.), mean_anomaly);
+  B mean_anom_reduc;
+  auto high = reduction::range_reduce(xs::abs(mean_anomaly), mean_anom_reduc);
+  sgn = xs::select(high, -sgn, sgn);
+  B s;
+  auto ecc_anom_reduc = kernel(mean_anom_reduc, &s, &cos_eccentric_anomaly);
+  local_anchor = sgn * mean_anom_reduc;
+  eccentric_anomaly = sgn * ecc_anom_reduc;
+  sin_eccentric_anomaly = sgn * s;
+}
+
+// The eccentric anomaly in the frame of the anchor has the same sign as the
+// local mean anomaly, but it can drift by several orbits from the anchor when
+// the steps are large. Since E and M cross multiples of 2 pi together, the
+// whole orbits can be removed from E directly, and it is then shifted by one
+// more orbit if its sign differs from that of M. This gives the same range as
+// the other solvers: (-2 pi, 2 pi), with the sign of M.
+template <typename T>
+inline T wrap_local(const T& mean_anomaly, const T& local_eccentric_anomaly) {
+  const T turns = std::trunc(local_eccentric_anomaly * constants::oneotwopi<T>());
+  const T ecc_anom = math::fnma(turns, constants::twopi<T>(), local_eccentric_anomaly);
+  if (mean_anomaly >= T(0.) && ecc_anom < T(0.)) {
+    return ecc_anom + constants::twopi<T>();
+  } else if (mean_anomaly < T(0.) && ecc_anom > T(0.)) {
+    return ecc_anom - constants::twopi<T>();
+  }
+  return ecc_anom;
+}
+
+template <typename A, typename T>
+inline xs::batch<T, A> wrap_local(const xs::batch<T, A>& mean_anomaly,
+                                  const xs::batch<T, A>& local_eccentric_anomaly) {
+  using B = xs::batch<T, A>;
+  const auto turns = xs::trunc(local_eccentric_anomaly * constants::oneotwopi<B>());
+  const auto ecc_anom = xs::fnma(turns, constants::twopi<B>(), local_eccentric_anomaly);
+  auto wrap = ((mean_anomaly >= B(T(0.))) & (ecc_anom < B(T(0.)))) |
+              ((mean_anomaly < B(T(0.))) & (ecc_anom > B(T(0.))));
+  return xs::select(wrap, ecc_anom + xs::copysign(constants::twopi<B>(), mean_anomaly),
+                    ecc_anom);
+}
+
+template <typename T, typename Kernel>
+inline void solve_continuation(const Kernel& kernel, const T& eccentricity, std::size_t size,
+                               const T* mean_anomaly, T* eccentric_anomaly,
+                               T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+  T anchor(0.), local_anchor(0.), ecc_anom(0.), sin_ecc_anom(0.), cos_ecc_anom(1.);
+  for (std::size_t i = 0; i < size; ++i) {
+    T next_ecc_anom, next_sin, next_cos;
+    if (i % continuation_resync != 0 &&
+        continuation_step(eccentricity, (mean_anomaly[i] - anchor) + local_anchor, ecc_anom,
+                          sin_ecc_anom, cos_ecc_anom, next_ecc_anom, next_sin, next_cos)) {
+      ecc_anom = next_ecc_anom;
+      sin_ecc_anom = next_sin;
+      cos_ecc_anom = next_cos;
+    } else {
+      anchor = mean_anomaly[i];
+      solve_anchor(kernel, anchor, local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    }
+    eccentric_anomaly[i] = wrap_local(mean_anomaly[i], ecc_anom);
+    sin_eccentric_anomaly[i] = sin_ecc_anom;
+    cos_eccentric_anomaly[i] = cos_ecc_anom;
+  }
+}
+
+// In the SIMD version, each lane works through its own contiguous segment of
+// the input, so that the continuation is along the sequence in every lane
+template <typename T, typename Kernel>
+inline void solve_continuation_simd(const Kernel& kernel, const T& eccentricity,
+                                    std::size_t size, const T* mean_anomaly,
+                                    T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                                    T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  using I = xs::as_integer_t<B>;
+  using IT = typename I::value_type;
+  constexpr std::size_t simd_size = B::size;
+
+  // The lanes are gathered with the integer type of the batch, which only has
+  // 32 bits for float, so longer inputs are solved in independent blocks that
+  // the offsets can address
+  constexpr std::size_t max_block = std::size_t(std::numeric_limits<IT>::max());
+  if (size > max_block) {
+    for (std::size_t i = 0; i < size; i += max_block) {
+      solve_continuation_simd(kernel, eccentricity, std::min(max_block, size - i),
+                              &(mean_anomaly[i]), &(eccentric_anomaly[i]),
+                              &(sin_eccentric_anomaly[i]), &(cos_eccentric_anomaly[i]));
+    }
+    return;
+  }
+
+  std::size_t segment = size / simd_size;
+  alignas(B::arch_type::alignment()) IT offsets[simd_size];
+  for (std::size_t k = 0; k < simd_size; ++k) offsets[k] = IT(k * segment);
+  auto idx = I::load_aligned(offsets);
+
+  B anchor, local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom;
+  for (std::size_t i = 0; i < segment; ++i) {
+    auto mean_anom = B::gather(mean_anomaly, idx);
+    if (i % continuation_resync == 0) {
+      anchor = mean_anom;
+      solve_anchor(kernel, anchor, local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    } else {
+      B next_ecc_anom, next_sin, next_cos;
+      auto accept =
+          continuation_step(eccentricity, (mean_anom - anchor) + local_anchor, ecc_anom,
+                            sin_ecc_anom, cos_ecc_anom, next_ecc_anom, next_sin, next_cos);
+      if (!xs::all(accept)) {
+        B next_local_anchor;
+        solve_anchor(kernel, mean_anom, next_local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+        anchor = xs::select(accept, anchor, mean_anom);
+        local_anchor = xs::select(accept, local_anchor, next_local_anchor);
+        next_ecc_anom = xs::select(accept, next_ecc_anom, ecc_anom);
+        next_sin = xs::select(accept, next_sin, sin_ecc_anom);
+        next_cos = xs::select(accept, next_cos, cos_ecc_anom);
+      }
+      ecc_anom = next_ecc_anom;
+      sin_ecc_anom = next_sin;
+      cos_ecc_anom = next_cos;
+    }
+    wrap_local(mean_anom, ecc_anom).scatter(eccentric_anomaly, idx);
+    sin_ecc_anom.scatter(sin_eccentric_anomaly, idx);
+    cos_ecc_anom.scatter(cos_eccentric_anomaly, idx);
+    idx += I(IT(1));
+  }
+
+  std::size_t vec_size = segment * simd_size;
+  solve_continuation(kernel, eccentricity, size - vec_size, &(mean_anomaly[vec_size]),
+                     &(eccentric_anomaly[vec_size]), &(sin_eccentric_anomaly[vec_size]),
+                     &(cos_eccentric_anomaly[vec_size]));
+}
+
+// Uniform grid solvers, for M = M0 + i dM. The mean anomalies are never
+// stored; they're computed on the fly with an fma, and for most eccentricities
+// the continuation step from above is used to step along the grid. In the SIMD
+// versions, the lanes are interleaved so that the outputs are stored
+// contiguously, and each lane steps by `simd_size * dM`. The lane indices are
+// converted from the integer index for every batch, like in the scalar
+// version, rather than being accumulated in T, which is inexact beyond 2^24
+// points for float.
+template <typename T, typename Kernel>
+inline void solve_uniform(const Kernel& kernel, const T& eccentricity, const T& mean_anomaly_0,
+                          const T& mean_anomaly_step, std::size_t begin, std::size_t end,
+                          T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                          T* cos_eccentric_anomaly) {
+  T anchor(0.), local_anchor(0.), ecc_anom(0.), sin_ecc_anom(0.), cos_ecc_anom(1.);
+  for (std::size_t i = begin; i < end; ++i) {
+    auto mean_anom = math::fma(T(i), mean_anomaly_step, mean_anomaly_0);
+    T next_ecc_anom, next_sin, next_cos;
+    if ((i - begin) % continuation_resync != 0 &&
+        continuation_step(eccentricity, (mean_anom - anchor) + local_anchor, ecc_anom,
+                          sin_ecc_anom, cos_ecc_anom, next_ecc_anom, next_sin, next_cos)) {
+      ecc_anom = next_ecc_anom;
+      sin_ecc_anom = next_sin;
+      cos_ecc_anom = next_cos;
+    } else {
+      anchor = mean_anom;
+      solve_anchor(kernel, anchor, local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    }
+    eccentric_anomaly[i] = wrap_local(mean_anom, ecc_anom);
+    sin_eccentric_anomaly[i] = sin_ecc_anom;
+    cos_eccentric_anomaly[i] = cos_ecc_anom;
+  }
+}
+
+template <typename Tag, typename T, typename Kernel>
+inline void solve_uniform_simd(const Kernel& kernel, const T& eccentricity,
+                               const T& mean_anomaly_0, const T& mean_anomaly_step,
+                               std::size_t size, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                               T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  alignas(B::arch_type::alignment()) T index[simd_size];
+  const B step = B(mean_anomaly_step);
+  const B offset = B(mean_anomaly_0);
+
+  B anchor, local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom;
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    for (std::size_t k = 0; k < simd_size; ++k) index[k] = T(i + k);
+    auto mean_anom = xs::fma(B::load_aligned(index), step, offset);
+    if (i % (continuation_resync * simd_size) == 0) {
+      anchor = mean_anom;
+      solve_anchor(kernel, anchor, local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    } else {
+      B next_ecc_anom, next_sin, next_cos;
+      auto accept =
+          continuation_step(eccentricity, (mean_anom - anchor) + local_anchor, ecc_anom,
+                            sin_ecc_anom, cos_ecc_anom, next_ecc_anom, next_sin, next_cos);
+      if (!xs::all(accept)) {
+        B next_local_anchor;
+        solve_anchor(kernel, mean_anom, next_local_anchor, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+        anchor = xs::select(accept, anchor, mean_anom);
+        local_anchor = xs::select(accept, local_anchor, next_local_anchor);
+        next_ecc_anom = xs::select(accept, next_ecc_anom, ecc_anom);
+        next_sin = xs::select(accept, next_sin, sin_ecc_anom);
+        next_cos = xs::select(accept, next_cos, cos_ecc_anom);
+      }
+      ecc_anom = next_ecc_anom;
+      sin_ecc_anom = next_sin;
+      cos_ecc_anom = next_cos;
+    }
+    wrap_local(mean_anom, ecc_anom).store(&eccentric_anomaly[i], Tag());
+    sin_ecc_anom.store(&sin_eccentric_anomaly[i], Tag());
+    cos_ecc_anom.store(&cos_eccentric_anomaly[i], Tag());
+  }
+
+  solve_uniform(kernel, eccentricity, mean_anomaly_0, mean_anomaly_step, vec_size, size,
+                eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+// The sine and cosine of an arbitrary angle, using the same range reduction as
+// the solvers, since `math::sincos` is only valid in [0, pi]
+template <typename T>
+inline void full_sincos(const T& x, T& s, T& c) {
+  T xr;
+  bool high = reduction::range_reduce(std::abs(x), xr);
+  auto sincos = math::sincos(xr);
+  s = high != std::signbit(x) ? -sincos.first : sincos.first;
+  c = sincos.second;
+}
+
+// The mean anomaly reduced to (-2 pi, 2 pi) with its own sign, so that the
+// series solution below returns E in the same range as the other solvers
+template <typename T>
+inline T wrap_mean_anomaly(const T& x) {
+  T xr;
+  bool high = reduction::range_reduce(std::abs(x), xr);
+  return std::copysign(high ? constants::twopi<T>() - xr : xr, x);
+}
+
+template <typename A, typename T>
+inline xs::batch<T, A> wrap_mean_anomaly(const xs::batch<T, A>& x) {
+  xs::batch<T, A> xr;
+  auto high = reduction::range_reduce(xs::abs(x), xr);
+  return xs::copysign(xs::select(high, constants::twopi<xs::batch<T, A>>() - xr, xr), x);
+}
+
+// At low eccentricity, the series solution only needs the sine and cosine of
+// M, which are generated by rotating through dM at each step, with periodic
+// resynchronization to bound the accumulated rounding error
+template <typename T>
+inline void solve_uniform(const low_eccentricity_kernel<T>& kernel, const T&,
+                          const T& mean_anomaly_0, const T& mean_anomaly_step, std::size_t begin,
+                          std::size_t end, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                          T* cos_eccentric_anomaly) {
+  T sin_step, cos_step, sin_mean(0.), cos_mean(1.);
+  full_sincos(mean_anomaly_step, sin_step, cos_step);
+  for (std::size_t i = begin; i < end; ++i) {
+    auto mean_anom = math::fma(T(i), mean_anomaly_step, mean_anomaly_0);
+    if ((i - begin) % continuation_resync == 0) {
+      full_sincos(mean_anom, sin_mean, cos_mean);
+    } else {
+      auto s = sin_mean;
+      sin_mean = math::fma(s, cos_step, cos_mean * sin_step);
+      cos_mean = math::fnma(s, sin_step, cos_mean * cos_step);
+    }
+    eccentric_anomaly[i] =
+        kernel.evaluate(wrap_mean_anomaly(mean_anom), sin_mean, cos_mean,
+                        &sin_eccentric_anomaly[i], &cos_eccentric_anomaly[i]);
+  }
+}
+
+template <typename Tag, typename T>
+inline void solve_uniform_simd(const low_eccentricity_kernel<T>& kernel, const T& eccentricity,
+                               const T& mean_anomaly_0, const T& mean_anomaly_step,
+                               std::size_t size, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                               T* cos_eccentric_anomaly) {
+  using B = xs::batch<T>;
+  constexpr std::size_t simd_size = B::size;
+  std::size_t vec_size = size - size % simd_size;
+
+  alignas(B::arch_type::alignment()) T index[simd_size];
+  const B step = B(mean_anomaly_step);
+  const B offset = B(mean_anomaly_0);
+
+  T sin_lane_step, cos_lane_step;
+  full_sincos(T(simd_size) * mean_anomaly_step, sin_lane_step, cos_lane_step);
+  const B sin_step(sin_lane_step), cos_step(cos_lane_step);
+
+  B sin_mean, cos_mean;
+  for (std::size_t i = 0; i < vec_size; i += simd_size) {
+    for (std::size_t k = 0; k < simd_size; ++k) index[k] = T(i + k);
+    auto mean_anom = xs::fma(B::load_aligned(index), step, offset);
+    if (i % (continuation_resync * simd_size) == 0) {
+      auto sincos = xs::sincos(mean_anom);
+      sin_mean = sincos.first;
+      cos_mean = sincos.second;
+    } else {
+      auto s = sin_mean;
+      sin_mean = xs::fma(s, cos_step, cos_mean * sin_step);
+      cos_mean = xs::fnma(s, sin_step, cos_mean * cos_step);
+    }
+    B sin_ecc_anom, cos_ecc_anom;
+    auto ecc_anom = kernel.evaluate(wrap_mean_anomaly(mean_anom), sin_mean, cos_mean,
+                                    &sin_ecc_anom, &cos_ecc_anom);
+    ecc_anom.store(&eccentric_anomaly[i], Tag());
+    sin_ecc_anom.store(&sin_eccentric_anomaly[i], Tag());
+    cos_ecc_anom.store(&cos_eccentric_anomaly[i], Tag());
+  }
+
+  solve_uniform(kernel, eccentricity, mean_anomaly_0, mean_anomaly_step, vec_size, size,
+                eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+}  // namespace detail
+
+template <typename Starter, typename Refiner>
+inline void solve_one(const typename value_type<Starter, Refiner>::type& eccentricity,
+                      const typename value_type<Starter, Refiner>::type& mean_anomaly,
+                      typename value_type<Starter, Refiner>::type& eccentric_anomaly,
+                      typename value_type<Starter, Refiner>::type& sin_eccentric_anomaly,
+                      typename value_type<Starter, Refiner>::type& cos_eccentric_anomaly,
+                      const Refiner& refiner, const Starter& starter) {
+  const detail::starter_refiner_kernel<Starter, Refiner> kernel{eccentricity, starter, refiner};
+  detail::solve_one(kernel, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                    cos_eccentric_anomaly);
+}
+
 template <typename Starter, typename Refiner>
 inline void solve(const typename value_type<Starter, Refiner>::type& eccentricity,
                   std::size_t size,
@@ -58,13 +728,15 @@ inline void solve(const typename value_type<Starter, Refiner>::type& eccentricit
                   typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
                   typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
                   const Refiner& refiner = Refiner()) {
-  const Starter starter(eccentricity);
-  for (std::size_t i = 0; i < size; ++i) {
-    solve_one(eccentricity, mean_anomaly[i], eccentric_anomaly[i], sin_eccentric_anomaly[i],
-              cos_eccentric_anomaly[i], refiner, starter);
-  }
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                  cos_eccentric_anomaly);
+  });
 }
 
+// Pass `memory::streaming_mode` as the Tag for batches that are much larger
+// than the last level cache; see memory.hpp
 template <typename Starter, typename Refiner, typename Tag = xs::unaligned_mode>
 inline void solve_simd(const typename value_type<Starter, Refiner>::type& eccentricity,
                        std::size_t size,
@@ -73,37 +745,112 @@ inline void solve_simd(const typename value_type<Starter, Refiner>::type& eccent
                        typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
                        typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
                        const Refiner& refiner = Refiner()) {
-  using T = typename value_type<Starter, Refiner>::type;
-  using B = xs::batch<T>;
-  constexpr std::size_t simd_size = B::size;
-  std::size_t vec_size = size - size % simd_size;
-  const Starter starter(eccentricity);
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve_simd<Tag>(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                            cos_eccentric_anomaly);
+  });
+}
 
-  for (std::size_t i = 0; i < vec_size; i += simd_size) {
-    auto mean_anom = xs::load(&(mean_anomaly[i]), Tag());
-    auto sgn = xs::copysign(B(1.), mean_anom);
-    auto abs_mean_anom = xs::abs(mean_anom);
-    B mean_anom_reduc;
-    auto high = reduction::range_reduce(abs_mean_anom, mean_anom_reduc);
-    auto ecc_anom_reduc = starter.start(mean_anom_reduc);
-    B s, c;
-    ecc_anom_reduc = refiners::refine_with_eccentricity<Refiner>::refine(
-        refiner, eccentricity, mean_anom_reduc, ecc_anom_reduc, &s, &c);
-    auto ecc_anom = sgn * xs::select(high, constants::twopi<T>() - ecc_anom_reduc, ecc_anom_reduc);
-    auto sin_ecc_anom = sgn * s * xs::select(high, B(-1.), B(1.));
-    auto cos_ecc_anom = c;
-    ecc_anom.store(&eccentric_anomaly[i], Tag());
-    sin_ecc_anom.store(&sin_eccentric_anomaly[i], Tag());
-    cos_ecc_anom.store(&cos_eccentric_anomaly[i], Tag());
-  }
+template <typename Starter, typename Refiner, typename U>
+inline void solve_phase(const typename value_type<Starter, Refiner>::type& eccentricity,
+                        std::size_t size, const U* phase,
+                        typename value_type<Starter, Refiner>::type* eccentric_anomaly,
+                        typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+                        typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+                        const Refiner& refiner = Refiner()) {
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve_phase(kernel, size, phase, eccentric_anomaly, sin_eccentric_anomaly,
+                        cos_eccentric_anomaly);
+  });
+}
 
-  for (std::size_t i = vec_size; i < size; ++i) {
-    solve_one(eccentricity, mean_anomaly[i], eccentric_anomaly[i], sin_eccentric_anomaly[i],
-              cos_eccentric_anomaly[i], refiner, starter);
-  }
+template <typename Starter, typename Refiner, typename Tag = xs::unaligned_mode, typename U>
+inline void solve_phase_simd(const typename value_type<Starter, Refiner>::type& eccentricity,
+                             std::size_t size, const U* phase,
+                             typename value_type<Starter, Refiner>::type* eccentric_anomaly,
+                             typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+                             typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+                             const Refiner& refiner = Refiner()) {
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve_phase_simd<Tag>(kernel, size, phase, eccentric_anomaly, sin_eccentric_anomaly,
+                                  cos_eccentric_anomaly);
+  });
+}
+
+// Solve for a sequence of slowly varying mean anomalies, such as a densely
+// sampled time series, using the continuation solver described above. As for
+// the other solvers, the eccentric anomaly is returned in (-2 pi, 2 pi) with
+// the sign of M.
+template <typename Starter, typename Refiner>
+inline void solve_continuation(const typename value_type<Starter, Refiner>::type& eccentricity,
+                               std::size_t size,
+                               const typename value_type<Starter, Refiner>::type* mean_anomaly,
+                               typename value_type<Starter, Refiner>::type* eccentric_anomaly,
+                               typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+                               typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+                               const Refiner& refiner = Refiner()) {
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve_continuation(kernel, eccentricity, size, mean_anomaly, eccentric_anomaly,
+                               sin_eccentric_anomaly, cos_eccentric_anomaly);
+  });
+}
+
+template <typename Starter, typename Refiner>
+inline void solve_continuation_simd(
+    const typename value_type<Starter, Refiner>::type& eccentricity, std::size_t size,
+    const typename value_type<Starter, Refiner>::type* mean_anomaly,
+    typename value_type<Starter, Refiner>::type* eccentric_anomaly,
+    typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+    typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+    const Refiner& refiner = Refiner()) {
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve_continuation_simd(kernel, eccentricity, size, mean_anomaly, eccentric_anomaly,
+                                    sin_eccentric_anomaly, cos_eccentric_anomaly);
+  });
+}
+
+// Solve on a uniform grid of mean anomalies, M = M0 + i dM for i in [0, size),
+// without materializing the grid. The eccentric anomaly is wrapped like it is
+// for the other solvers.
+template <typename Starter, typename Refiner>
+inline void solve_uniform(const typename value_type<Starter, Refiner>::type& eccentricity,
+                          const typename value_type<Starter, Refiner>::type& mean_anomaly_0,
+                          const typename value_type<Starter, Refiner>::type& mean_anomaly_step,
+                          std::size_t size,
+                          typename value_type<Starter, Refiner>::type* eccentric_anomaly,
+                          typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+                          typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+                          const Refiner& refiner = Refiner()) {
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve_uniform(kernel, eccentricity, mean_anomaly_0, mean_anomaly_step, 0, size,
+                          eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+  });
+}
+
+template <typename Starter, typename Refiner, typename Tag = xs::unaligned_mode>
+inline void solve_uniform_simd(
+    const typename value_type<Starter, Refiner>::type& eccentricity,
+    const typename value_type<Starter, Refiner>::type& mean_anomaly_0,
+    const typename value_type<Starter, Refiner>::type& mean_anomaly_step, std::size_t size,
+    typename value_type<Starter, Refiner>::type* eccentric_anomaly,
+    typename value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+    typename value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+    const Refiner& refiner = Refiner()) {
+  stats::record_call(size);
+  detail::with_kernel<Starter>(eccentricity, refiner, [&](const auto& kernel) {
+    detail::solve_uniform_simd<Tag>(kernel, eccentricity, mean_anomaly_0, mean_anomaly_step, size,
+                                    eccentric_anomaly, sin_eccentric_anomaly,
+                                    cos_eccentric_anomaly);
+  });
 }
 
 }  // namespace solver
 }  // namespace kepler
 
-#endif
\ No newline at end of file
+#endif
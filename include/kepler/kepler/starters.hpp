@@ -1,10 +1,14 @@
 #ifndef KEPLER_STARTERS_HPP
 #define KEPLER_STARTERS_HPP
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
 
 #include "kepler/kepler/constants.hpp"
 #include "kepler/kepler/math.hpp"
+#include "kepler/kepler/stats.hpp"
 #include "xsimd/xsimd.hpp"
 
 namespace kepler {
@@ -289,7 +293,9 @@ struct raposo_pulido_brandt {
   }
 
   inline T start(const T& mean_anomaly) const {
-    if ((eccentricity < T(0.78)) || (T(2.) * mean_anomaly + ome > T(0.2))) {
+    bool flag = (eccentricity < T(0.78)) || (T(2.) * mean_anomaly + ome > T(0.2));
+    stats::record_singular(!flag);
+    if (flag) {
       return lookup(mean_anomaly);
     } else {
       return singular(mean_anomaly);
@@ -301,12 +307,344 @@ struct raposo_pulido_brandt {
     using B = xs::batch<T, A>;
     auto flag = (typename B::batch_bool_type(eccentricity < T(0.78))) |
                 (xs::fma(B(T(2.)), mean_anomaly, B(ome)) > B(T(0.2)));
+    stats::record_singular(!flag);
     auto fastpath = lookup(mean_anomaly);
     if (xs::all(flag)) return fastpath;
     return xs::select(flag, fastpath, singular(mean_anomaly));
   }
 };
 
+namespace detail {
+
+// The solution of the cubic (1 - e) E + e E^3 / 6 = M, which approximates
+// Kepler's equation for small E. This is written so that it is stable for all
+// e < 1, including e = 0 where it reduces to E = M.
+template <typename T>
+struct cubic {
+  T chi_factor, factor;
+
+  explicit cubic(T eccentricity)
+      : chi_factor(T(3.) * std::sqrt(eccentricity) /
+                   std::pow(T(2.) * (T(1.) - eccentricity), T(1.5))),
+        factor(T(3.) / (T(1.) - eccentricity)) {}
+
+  inline T operator()(const T& mean_anomaly) const {
+    auto chi = mean_anomaly * chi_factor;
+    auto z = std::cbrt(chi + std::sqrt(chi * chi + T(1.)));
+    z *= z;
+    return mean_anomaly * factor / (z + T(1.) + T(1.) / z);
+  }
+
+  template <typename A>
+  inline xs::batch<T, A> operator()(const xs::batch<T, A>& mean_anomaly) const {
+    using B = xs::batch<T, A>;
+    auto chi = mean_anomaly * chi_factor;
+    auto z = xs::cbrt(chi + xs::sqrt(xs::fma(chi, chi, B(T(1.)))));
+    z *= z;
+    return B(factor) * mean_anomaly / (z + B(T(1.)) + B(T(1.)) / z);
+  }
+};
+
+}  // namespace detail
+
+// Following Fukushima (1997), the eccentric anomaly is discretized uniformly
+// on [0, pi] and the corresponding mean anomalies are tabulated, along with the
+// coefficients of the cubic expansion of Kepler's equation about each node.
+// After locating the segment containing M, the start is a linear interpolation
+// within the segment, polished by a Halley step on the local cubic, so no
+// transcendental functions are evaluated. The first segment, which contains the
+// singular corner, uses the cubic approximation about E = 0 instead.
+//
+// https://ui.adsabs.harvard.edu/abs/1997CeMDA..66..309F/abstract
+template <typename T>
+struct fukushima {
+  typedef T value_type;
+  static constexpr int num_segments = 32;
+  T eccentricity, bounds[num_segments + 1], table[5 * num_segments];
+  detail::cubic<T> corner;
+
+  fukushima(T eccentricity) : eccentricity(eccentricity), corner(eccentricity) {
+    const T step = constants::pi<T>() / T(num_segments);
+    for (int j = 0; j < num_segments; ++j) {
+      auto ecc_anom = T(j) * step;
+      bounds[j] = ecc_anom - eccentricity * std::sin(ecc_anom);
+    }
+    bounds[num_segments] = constants::pi<T>();
+
+    for (int j = 0; j < num_segments; ++j) {
+      auto ecc_anom = T(j) * step;
+      auto ecc_sin = eccentricity * std::sin(ecc_anom);
+      auto ecc_cos = eccentricity * std::cos(ecc_anom);
+      int k = 5 * j;
+      table[k] = ecc_anom;
+      table[k + 1] = step / (bounds[j + 1] - bounds[j]);
+      table[k + 2] = T(1.) - ecc_cos;
+      table[k + 3] = T(0.5) * ecc_sin;
+      table[k + 4] = ecc_cos / T(6.);
+    }
+  }
+
+  inline int segment(const T& mean_anomaly) const {
+    auto j = int(std::upper_bound(bounds + 1, bounds + num_segments, mean_anomaly) - bounds) - 1;
+    return std::max(j, 0);
+  }
+
+  // A Halley step for the root of a1 d + a2 d^2 + a3 d^3 = dM, starting from
+  // the linear interpolation d0
+  template <typename V>
+  static inline V local(const V& delta_mean_anom, const V& scale, const V& a1, const V& a2,
+                        const V& a3) {
+    auto d = scale * delta_mean_anom;
+    auto f = math::fma(d, math::fma(d, math::fma(d, a3, a2), a1), -delta_mean_anom);
+    auto fp = math::fma(d, math::fma(V(T(3.)) * a3, d, V(T(2.)) * a2), a1);
+    auto fpp = math::fma(V(T(6.)) * a3, d, V(T(2.)) * a2);
+    return d - V(T(2.)) * f * fp / math::fnma(f, fpp, V(T(2.)) * fp * fp);
+  }
+
+  inline T start(const T& mean_anomaly) const {
+    if (mean_anomaly <= bounds[1]) return corner(mean_anomaly);
+    auto j = segment(mean_anomaly);
+    auto k = 5 * j;
+    return table[k] + local(mean_anomaly - bounds[j], table[k + 1], table[k + 2], table[k + 3],
+                            table[k + 4]);
+  }
+
+  template <typename A>
+  inline xs::batch<T, A> start(const xs::batch<T, A>& mean_anomaly) const {
+    using B = xs::batch<T, A>;
+    using I = typename xs::as_integer_t<B>;
+    static_assert(B::size == I::size, "integer batch size must match float batch size");
+
+    // As for raposo_pulido_brandt, the segment search is serial
+    alignas(A::alignment()) std::array<typename I::value_type, I::size> idx;
+    alignas(A::alignment()) std::array<typename B::value_type, B::size> val;
+    mean_anomaly.store_aligned(val.data());
+    for (size_t n = 0; n < I::size; ++n) idx[n] = segment(val[n]);
+
+    auto j = xs::load_aligned(idx.data());
+    auto k = I(5) * j;
+    auto ecc_anom = B::gather(table, k) + local(mean_anomaly - B::gather(bounds, j),
+                                                B::gather(table, k + 1),
+                                                B::gather(table, k + 2),
+                                                B::gather(table, k + 3),
+                                                B::gather(table, k + 4));
+    auto flag = mean_anomaly <= B(bounds[1]);
+    if (xs::none(flag)) return ecc_anom;
+    return xs::select(flag, corner(mean_anomaly), ecc_anom);
+  }
+};
+
+// A region-wise starter in the style of Nijenhuis (1991). The range [0, pi] is
+// split into three regions at E = pi/3 and 2 pi/3. Near periapsis, the start
+// is the solution of the cubic approximation to Kepler's equation, and in the
+// other two regions it is a cubic series in M about E = pi/2 or E = pi. In all
+// regions, this is followed by a Halley step where the sine and cosine are
+// evaluated using truncated series about the center of the region, so no
+// transcendental functions are evaluated. Compared to `fukushima`, this needs
+// almost no table but more arithmetic per element.
+//
+// https://ui.adsabs.harvard.edu/abs/1991CeMDA..51..319N/abstract
+template <typename T>
+struct nijenhuis {
+  typedef T value_type;
+  T eccentricity, bounds[2], apo_factor1, apo_factor3, mid_factor2, mid_factor3;
+  detail::cubic<T> corner;
+
+  nijenhuis(T eccentricity)
+      : eccentricity(eccentricity),
+        apo_factor1(T(1.) / (T(1.) + eccentricity)),
+        apo_factor3(eccentricity * apo_factor1 * apo_factor1 * apo_factor1 * apo_factor1 /
+                    T(6.)),
+        mid_factor2(-T(0.5) * eccentricity),
+        mid_factor3(T(0.5) * eccentricity * eccentricity),
+        corner(eccentricity) {
+    auto ecc_sin = eccentricity * std::sqrt(T(3.)) / T(2.);
+    bounds[0] = constants::pio3<T>() - ecc_sin;
+    bounds[1] = constants::twopio3<T>() - ecc_sin;
+  }
+
+  // Truncated series for sin(x) and cos(x), for |x| <= pi/3
+  template <typename V>
+  static inline V sin_series(const V& x) {
+    auto x2 = x * x;
+    return x * math::fnma(x2 / V(T(6.)),
+                          math::fnma(x2 / V(T(20.)), math::fnma(x2, V(T(1.) / T(42.)), V(T(1.))),
+                                     V(T(1.))),
+                          V(T(1.)));
+  }
+
+  template <typename V>
+  static inline V cos_series(const V& x) {
+    auto x2 = x * x;
+    auto y = math::fnma(x2 / V(T(30.)), math::fnma(x2, V(T(1.) / T(56.)), V(T(1.))), V(T(1.)));
+    return math::fnma(x2 / V(T(2.)), math::fnma(x2 / V(T(12.)), y, V(T(1.))), V(T(1.)));
+  }
+
+  // The Halley step from E = center + delta, where the sine and cosine of the
+  // center are given
+  template <typename V>
+  inline V polish(const V& mean_anomaly, const V& center, const V& delta, const V& sin_center,
+                  const V& cos_center) const {
+    auto s = sin_series(delta);
+    auto c = cos_series(delta);
+    auto ecc_sin = V(eccentricity) * math::fma(sin_center, c, cos_center * s);
+    auto ecc_cos = V(eccentricity) * math::fnma(sin_center, s, cos_center * c);
+    auto ecc_anom = center + delta;
+    auto f = ecc_anom - ecc_sin - mean_anomaly;
+    auto fp = V(T(1.)) - ecc_cos;
+    return ecc_anom - V(T(2.)) * f * fp / math::fnma(f, ecc_sin, V(T(2.)) * fp * fp);
+  }
+
+  inline T start(const T& mean_anomaly) const {
+    if (mean_anomaly < bounds[0]) {
+      return polish(mean_anomaly, T(0.), corner(mean_anomaly), T(0.), T(1.));
+    } else if (mean_anomaly < bounds[1]) {
+      auto x = mean_anomaly - (constants::pio2<T>() - eccentricity);
+      auto delta = x * math::fma(x, math::fma(x, mid_factor3, mid_factor2), T(1.));
+      return polish(mean_anomaly, constants::pio2<T>(), delta, T(1.), T(0.));
+    } else {
+      auto x = mean_anomaly - constants::pi<T>();
+      auto delta = x * math::fma(x * x, apo_factor3, apo_factor1);
+      return polish(mean_anomaly, constants::pi<T>(), delta, T(0.), T(-1.));
+    }
+  }
+
+  template <typename A>
+  inline xs::batch<T, A> start(const xs::batch<T, A>& mean_anomaly) const {
+    using B = xs::batch<T, A>;
+    auto low = mean_anomaly < B(bounds[0]);
+    auto mid = mean_anomaly < B(bounds[1]);
+
+    // The series about pi/2 and pi share the same form, so they are evaluated
+    // together with the coefficients selected per lane
+    auto center = xs::select(mid, B(constants::pio2<T>()), B(constants::pi<T>()));
+    auto offset = xs::select(mid, B(constants::pio2<T>() - eccentricity), center);
+    auto factor1 = xs::select(mid, B(T(1.)), B(apo_factor1));
+    auto factor2 = xs::select(mid, B(mid_factor2), B(T(0.)));
+    auto factor3 = xs::select(mid, B(mid_factor3), B(apo_factor3));
+    auto x = mean_anomaly - offset;
+    auto delta = x * xs::fma(x, xs::fma(x, factor3, factor2), factor1);
+    auto sin_center = xs::select(mid, B(T(1.)), B(T(0.)));
+    auto cos_center = xs::select(mid, B(T(0.)), B(T(-1.)));
+
+    if (xs::any(low)) {
+      center = xs::select(low, B(T(0.)), center);
+      delta = xs::select(low, corner(mean_anomaly), delta);
+      sin_center = xs::select(low, B(T(0.)), sin_center);
+      cos_center = xs::select(low, B(T(1.)), cos_center);
+    }
+    return polish(mean_anomaly, center, delta, sin_center, cos_center);
+  }
+};
+
+// The contour integral method of Philcox, Goodman & Slepian (2021). The root of
+// Kepler's equation is the ratio of two contour integrals of 1 / f(z), around a
+// circle centered at M + e/2, evaluated with the trapezoid rule on `NumGrid`
+// points of each half of the circle. All of the transcendental functions of
+// the grid points are tabulated in the constructor, so each element only needs
+// one sine and cosine, for the center, followed by a fixed loop with no
+// data-dependent branches. The root lies in [M, M + e] and touches both ends
+// of that range (at M = 0 or pi, and at E = pi/2), so the radius is slightly
+// larger than the published e/2 to keep the root off the contour. With the
+// `noop` refiner and NumGrid = 16, this is accurate to double precision for
+// e < 0.8, but the error grows near the singular corner, so a refinement step
+// is needed for high e.
+//
+// https://ui.adsabs.harvard.edu/abs/2021MNRAS.506.6111P/abstract
+template <typename T, int NumGrid>
+struct contour {
+  static_assert(NumGrid >= 3, "NumGrid must be at least 3");
+  static constexpr int num_points = NumGrid - 2;
+  typedef T value_type;
+  T eccentricity, offset, radius, ecc_sin_radius, ecc_cos_radius, threshold;
+  T exp2R[num_points], exp2I[num_points], exp4R[num_points], exp4I[num_points],
+      coshI[num_points], sinhI[num_points], ecosR[num_points], esinR[num_points];
+
+  contour(T eccentricity)
+      : eccentricity(eccentricity),
+        offset(T(0.5) * eccentricity),
+        radius(T(0.505) * eccentricity),
+        ecc_sin_radius(eccentricity * std::sin(radius)),
+        ecc_cos_radius(eccentricity * std::cos(radius)),
+        threshold(T(1e4) * std::numeric_limits<T>::epsilon()) {
+    const T step = constants::pi<T>() / T(NumGrid - 1);
+    for (int j = 0; j < num_points; ++j) {
+      auto cf = std::cos(T(j + 1) * step);
+      auto sf = std::sin(T(j + 1) * step);
+      exp2R[j] = cf;
+      exp2I[j] = sf;
+      exp4R[j] = cf * cf - sf * sf;
+      exp4I[j] = T(2.) * cf * sf;
+      coshI[j] = std::cosh(radius * sf);
+      sinhI[j] = std::sinh(radius * sf);
+      ecosR[j] = eccentricity * std::cos(radius * cf);
+      esinR[j] = eccentricity * std::sin(radius * cf);
+    }
+  }
+
+  // The quadrature, given the sine and cosine of the contour center
+  template <typename V>
+  inline V evaluate(const V& mean_anomaly, const V& sin_center, const V& cos_center) const {
+    auto center = mean_anomaly + V(offset);
+
+    // The two real end points of the contour, with a factor of 1/2
+    auto f_right = center + V(radius) -
+                   math::fma(sin_center, V(ecc_cos_radius), cos_center * V(ecc_sin_radius)) -
+                   mean_anomaly;
+    auto f_left = center - V(radius) -
+                  math::fnma(cos_center, V(ecc_sin_radius), sin_center * V(ecc_cos_radius)) -
+                  mean_anomaly;
+    auto inv_right = V(T(0.5)) / f_right;
+    auto inv_left = V(T(0.5)) / f_left;
+    auto ft_gx2 = inv_right + inv_left;
+    auto ft_gx1 = inv_right - inv_left;
+
+    for (int j = 0; j < num_points; ++j) {
+      auto ecc_sin = math::fma(sin_center, V(ecosR[j]), cos_center * V(esinR[j]));
+      auto ecc_cos = math::fnma(sin_center, V(esinR[j]), cos_center * V(ecosR[j]));
+      auto fxR = math::fma(V(radius), V(exp2R[j]), center) -
+                 math::fma(ecc_sin, V(coshI[j]), mean_anomaly);
+      auto fxI = math::fnma(ecc_cos, V(sinhI[j]), V(radius * exp2I[j]));
+      auto inv_norm = V(T(1.)) / math::fma(fxR, fxR, fxI * fxI);
+      fxR *= inv_norm;
+      fxI *= inv_norm;
+      ft_gx2 += math::fma(V(exp4R[j]), fxR, V(exp4I[j]) * fxI);
+      ft_gx1 += math::fma(V(exp2R[j]), fxR, V(exp2I[j]) * fxI);
+    }
+
+    return math::fma(V(radius), ft_gx2 / ft_gx1, center);
+  }
+
+  // The contour shrinks to a point as e -> 0, so small eccentricities use the
+  // second order series E = M + e sin M (1 + e cos M) instead. For float, the
+  // threshold is above constants::low_eccentricity, so this must be accurate.
+  inline T start(const T& mean_anomaly) const {
+    if (eccentricity < threshold) {
+      return math::fma(eccentricity * std::sin(mean_anomaly),
+                       math::fma(eccentricity, std::cos(mean_anomaly), T(1.)), mean_anomaly);
+    }
+    auto center = mean_anomaly + offset;
+    return evaluate(mean_anomaly, std::sin(center), std::cos(center));
+  }
+
+  template <typename A>
+  inline xs::batch<T, A> start(const xs::batch<T, A>& mean_anomaly) const {
+    using B = xs::batch<T, A>;
+    if (eccentricity < threshold) {
+      auto sc = xs::sincos(mean_anomaly);
+      return math::fma(B(eccentricity) * sc.first, math::fma(B(eccentricity), sc.second, B(T(1.))),
+                       mean_anomaly);
+    }
+    auto sc = xs::sincos(mean_anomaly + B(offset));
+    return evaluate(mean_anomaly, sc.first, sc.second);
+  }
+};
+
+// The contour starter with the default grid size, for use where a starter with
+// a single template parameter is expected
+template <typename T>
+using contour16 = contour<T, 16>;
+
 }  // namespace starters
 }  // namespace kepler
 
@@ -0,0 +1,331 @@
+#ifndef KEPLER_STATS_HPP
+#define KEPLER_STATS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "xsimd/xsimd.hpp"
+
+// Opt-in instrumentation of the solvers, for tuning workloads and catching
+// accuracy regressions in production. Defining KEPLER_ENABLE_STATS turns on
+// counters for the number of solves, the iterations of `refiners::iterative`,
+// the branches taken by `starters::raposo_pulido_brandt` and
+// `refiners::brandt`, and a histogram of the final residuals. Without it, the
+// recording functions below are empty and the solvers compile to the same code
+// as before.
+//
+// Each thread records into its own counters, without any locking on the hot
+// path, and `collect` sums the counters over all threads, including threads
+// that have since exited. The counters are cumulative until `reset` is called.
+// Batches that are padded past the end of the input only record their real
+// lanes, as set by `lanes` below, so that every element is counted once.
+
+namespace kepler {
+namespace stats {
+
+namespace xs = xsimd;
+
+#ifdef KEPLER_ENABLE_STATS
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+// The residuals |E - e sin(E) - M| are binned by decade, where bin k counts
+// residuals in [10^(k - 17), 10^(k - 16)). The first bin also counts smaller
+// residuals, including zero, and the last bin counts all larger residuals.
+constexpr int num_residual_bins = 16;
+
+struct convergence {
+  // The number of calls to the array solvers and the number of mean anomalies
+  std::size_t calls = 0;
+  std::size_t elements = 0;
+
+  // The total number of steps taken by `refiners::iterative`, and the number of
+  // elements that were still unconverged after `max_iterations` steps
+  std::size_t iterations = 0;
+  std::size_t max_iterations_reached = 0;
+
+  // The number of steps taken on SIMD batches by `refiners::iterative` and
+  // `compact::solve`. Each one costs a step on every lane, whether or not it
+  // has converged, so comparing this with `iterations` shows the idle lanes.
+  std::size_t iteration_batches = 0;
+
+  // The number of elements started with the singular corner expansion in
+  // `raposo_pulido_brandt`, and the number of SIMD batches where this was mixed
+  // with the table lookup, so that both were evaluated
+  std::size_t singular = 0;
+  std::size_t singular_mixed_batches = 0;
+
+  // The number of elements refined with the second and third order steps in
+  // `brandt`, and the number of SIMD batches that needed both
+  std::size_t brandt_second_order = 0;
+  std::size_t brandt_third_order = 0;
+  std::size_t brandt_mixed_batches = 0;
+
+  // The number of solutions where E, sin(E) or cos(E) is not finite; these are
+  // not included in the residual histogram
+  std::size_t non_finite = 0;
+
+  std::size_t residual_histogram[num_residual_bins] = {};
+};
+
+namespace detail {
+
+enum counter : int {
+  calls,
+  elements,
+  iterations,
+  max_iterations_reached,
+  iteration_batches,
+  singular,
+  singular_mixed_batches,
+  brandt_second_order,
+  brandt_third_order,
+  brandt_mixed_batches,
+  non_finite,
+  residual_histogram,
+  num_counters = residual_histogram + num_residual_bins
+};
+
+struct thread_counters;
+
+struct registry {
+  std::mutex mutex;
+  std::vector<thread_counters*> live;
+  std::size_t retired[num_counters] = {};
+
+  static registry& get() {
+    static registry instance;
+    return instance;
+  }
+};
+
+// The counters are only ever written by their own thread, so the relaxed
+// load and store below is enough to make the reads in `collect` well defined
+struct thread_counters {
+  std::atomic<std::size_t> values[num_counters];
+
+  thread_counters() {
+    for (auto& value : values) value.store(0, std::memory_order_relaxed);
+    auto& reg = registry::get();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.live.push_back(this);
+  }
+
+  ~thread_counters() {
+    auto& reg = registry::get();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (int k = 0; k < num_counters; ++k) {
+      reg.retired[k] += values[k].load(std::memory_order_relaxed);
+    }
+    reg.live.erase(std::find(reg.live.begin(), reg.live.end(), this));
+  }
+
+  inline void add(int k, std::size_t count) {
+    values[k].store(values[k].load(std::memory_order_relaxed) + count,
+                    std::memory_order_relaxed);
+  }
+
+  static thread_counters& local() {
+    static thread_local thread_counters instance;
+    return instance;
+  }
+};
+
+inline void add(int k, std::size_t count) {
+  if (enabled && count) thread_counters::local().add(k, count);
+}
+
+// The number of leading lanes in each batch that hold real elements
+inline std::size_t& active_lanes() {
+  static thread_local std::size_t count = std::numeric_limits<std::size_t>::max();
+  return count;
+}
+
+inline std::size_t size(bool) { return 1; }
+
+template <typename T, typename A>
+inline std::size_t size(const xs::batch_bool<T, A>&) {
+  return std::min(xs::batch_bool<T, A>::size, active_lanes());
+}
+
+inline std::size_t count(bool flag) { return flag; }
+
+template <typename T, typename A>
+inline std::size_t count(const xs::batch_bool<T, A>& flag) {
+  std::uint64_t mask = flag.mask();
+  std::size_t lanes = active_lanes();
+  if (lanes < 64) mask &= (std::uint64_t(1) << lanes) - 1;
+  std::size_t result = 0;
+  for (; mask; mask &= mask - 1) ++result;
+  return result;
+}
+
+template <typename T>
+inline void record_solution(const T& eccentricity, const T& mean_anomaly,
+                            const T& eccentric_anomaly, const T& sin_eccentric_anomaly,
+                            const T& cos_eccentric_anomaly) {
+  if (!std::isfinite(eccentric_anomaly) || !std::isfinite(sin_eccentric_anomaly) ||
+      !std::isfinite(cos_eccentric_anomaly)) {
+    add(non_finite, 1);
+    return;
+  }
+  auto residual =
+      std::abs(eccentric_anomaly - eccentricity * sin_eccentric_anomaly - mean_anomaly);
+  int bin = 0;
+  if (residual > T(0.)) {
+    bin = std::min(std::max(int(std::floor(std::log10(residual))) + 17, 0),
+                   num_residual_bins - 1);
+  }
+  add(residual_histogram + bin, 1);
+}
+
+}  // namespace detail
+
+// While in scope, only record the first `count` lanes of each batch on this
+// thread, for a batch that is padded with copies of its last element
+class lanes {
+ public:
+  explicit lanes(std::size_t count) : previous_(0) {
+    if (enabled) {
+      previous_ = detail::active_lanes();
+      detail::active_lanes() = count;
+    }
+  }
+
+  ~lanes() {
+    if (enabled) detail::active_lanes() = previous_;
+  }
+
+  lanes(const lanes&) = delete;
+  lanes& operator=(const lanes&) = delete;
+
+ private:
+  std::size_t previous_;
+};
+
+// Record a call to one of the array solvers
+inline void record_call(std::size_t size) {
+  detail::add(detail::calls, 1);
+  detail::add(detail::elements, size);
+}
+
+// Record a step of an iterative refiner for the elements where `stepped` is set
+template <typename Flag>
+inline void record_iterations(const Flag& stepped) {
+  if (enabled) detail::add(detail::iterations, detail::count(stepped));
+}
+
+// Record a step of an iterative refiner on a whole SIMD batch
+inline void record_iteration_batch() { detail::add(detail::iteration_batches, 1); }
+
+template <typename Flag>
+inline void record_max_iterations(const Flag& unconverged) {
+  if (enabled) detail::add(detail::max_iterations_reached, detail::count(unconverged));
+}
+
+// Record the branches taken by `raposo_pulido_brandt::start`
+template <typename Flag>
+inline void record_singular(const Flag& singular) {
+  if (!enabled) return;
+  auto count = detail::count(singular);
+  detail::add(detail::singular, count);
+  if (count && count < detail::size(singular)) detail::add(detail::singular_mixed_batches, 1);
+}
+
+// Record the branches taken by `brandt::refine`
+template <typename Flag>
+inline void record_brandt(const Flag& second_order) {
+  if (!enabled) return;
+  auto count = detail::count(second_order);
+  auto size = detail::size(second_order);
+  detail::add(detail::brandt_second_order, count);
+  detail::add(detail::brandt_third_order, size - count);
+  if (count && count < size) detail::add(detail::brandt_mixed_batches, 1);
+}
+
+// Record the final solution of the reduced problem, for the residual histogram
+template <typename T>
+inline void record_solution(const T& eccentricity, const T& mean_anomaly,
+                            const T& eccentric_anomaly, const T& sin_eccentric_anomaly,
+                            const T& cos_eccentric_anomaly) {
+  if (enabled) {
+    detail::record_solution(eccentricity, mean_anomaly, eccentric_anomaly,
+                            sin_eccentric_anomaly, cos_eccentric_anomaly);
+  }
+}
+
+template <typename T, typename A>
+inline void record_solution(const T& eccentricity, const xs::batch<T, A>& mean_anomaly,
+                            const xs::batch<T, A>& eccentric_anomaly,
+                            const xs::batch<T, A>& sin_eccentric_anomaly,
+                            const xs::batch<T, A>& cos_eccentric_anomaly) {
+  if (!enabled) return;
+  constexpr std::size_t simd_size = xs::batch<T, A>::size;
+  alignas(A::alignment()) T M[simd_size], E[simd_size], s[simd_size], c[simd_size];
+  mean_anomaly.store_aligned(M);
+  eccentric_anomaly.store_aligned(E);
+  sin_eccentric_anomaly.store_aligned(s);
+  cos_eccentric_anomaly.store_aligned(c);
+  std::size_t count = std::min(simd_size, detail::active_lanes());
+  for (std::size_t k = 0; k < count; ++k) {
+    detail::record_solution(eccentricity, M[k], E[k], s[k], c[k]);
+  }
+}
+
+// Sum the counters over all threads. This can be called while other threads
+// are solving, in which case their most recent updates may be missing.
+inline convergence collect() {
+  std::size_t values[detail::num_counters] = {};
+  if (enabled) {
+    auto& reg = detail::registry::get();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (int k = 0; k < detail::num_counters; ++k) values[k] = reg.retired[k];
+    for (auto* counters : reg.live) {
+      for (int k = 0; k < detail::num_counters; ++k) {
+        values[k] += counters->values[k].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  convergence result;
+  result.calls = values[detail::calls];
+  result.elements = values[detail::elements];
+  result.iterations = values[detail::iterations];
+  result.max_iterations_reached = values[detail::max_iterations_reached];
+  result.iteration_batches = values[detail::iteration_batches];
+  result.singular = values[detail::singular];
+  result.singular_mixed_batches = values[detail::singular_mixed_batches];
+  result.brandt_second_order = values[detail::brandt_second_order];
+  result.brandt_third_order = values[detail::brandt_third_order];
+  result.brandt_mixed_batches = values[detail::brandt_mixed_batches];
+  result.non_finite = values[detail::non_finite];
+  for (int k = 0; k < num_residual_bins; ++k) {
+    result.residual_histogram[k] = values[detail::residual_histogram + k];
+  }
+  return result;
+}
+
+// Zero the counters for all threads. This should not be called while other
+// threads are solving, since their concurrent updates may be lost.
+inline void reset() {
+  if (!enabled) return;
+  auto& reg = detail::registry::get();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (auto& value : reg.retired) value = 0;
+  for (auto* counters : reg.live) {
+    for (auto& value : counters->values) value.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace stats
+}  // namespace kepler
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef KEPLER_STREAM_HPP
+#define KEPLER_STREAM_HPP
+
+#include <cstddef>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/stats.hpp"
+#include "xsimd/xsimd.hpp"
+
+namespace kepler {
+
+namespace xs = xsimd;
+
+struct solver_stats {
+  // The number of calls to `push` and the total number of mean anomalies solved
+  std::size_t chunks = 0;
+  std::size_t elements = 0;
+
+  // The number of SIMD batches evaluated, including the padded tail of each chunk
+  std::size_t batches = 0;
+};
+
+// A solver for a fixed eccentricity that can be fed mean anomalies in chunks.
+// The starter is constructed once, when the eccentricity is set, and the
+// partial SIMD batch at the end of each chunk is padded and solved as a full
+// batch, rather than falling back on the scalar solver.
+template <typename T, typename Starter = starters::raposo_pulido_brandt<T>,
+          typename Refiner = refiners::brandt<T>>
+class Solver {
+ public:
+  typedef T value_type;
+  typedef Starter starter_type;
+  typedef Refiner refiner_type;
+
+  explicit Solver(const T& eccentricity, const Refiner& refiner = Refiner())
+      : eccentricity_(eccentricity), starter_(eccentricity), refiner_(refiner) {}
+
+  // Update the eccentricity, rebuilding the starter and resetting the stats
+  void reset(const T& eccentricity) {
+    eccentricity_ = eccentricity;
+    starter_ = Starter(eccentricity);
+    stats_ = solver_stats();
+  }
+
+  template <typename Tag = xs::unaligned_mode>
+  void push(std::size_t size, const T* mean_anomaly, T* eccentric_anomaly,
+            T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+    stats::record_call(size);
+    solver::detail::with_kernel(eccentricity_, starter_, refiner_, [&](const auto& kernel) {
+      push_impl<Tag>(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                     cos_eccentric_anomaly);
+    });
+  }
+
+  const T& eccentricity() const { return eccentricity_; }
+  const Starter& starter() const { return starter_; }
+  const solver_stats& stats() const { return stats_; }
+
+ private:
+  using B = xs::batch<T>;
+  static constexpr std::size_t simd_size = B::size;
+
+  T eccentricity_;
+  Starter starter_;
+  Refiner refiner_;
+  solver_stats stats_;
+
+  template <typename Tag, typename Kernel>
+  void push_impl(const Kernel& kernel, std::size_t size, const T* mean_anomaly,
+                 T* eccentric_anomaly, T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) {
+    std::size_t vec_size = size - size % simd_size;
+    solver::detail::solve_simd<Tag>(kernel, vec_size, mean_anomaly, eccentric_anomaly,
+                                    sin_eccentric_anomaly, cos_eccentric_anomaly);
+    stats_.chunks += 1;
+    stats_.elements += size;
+    stats_.batches += vec_size / simd_size;
+    if (vec_size == size) return;
+
+    solver::detail::solve_partial_batch(kernel, size - vec_size, mean_anomaly + vec_size,
+                                        eccentric_anomaly + vec_size,
+                                        sin_eccentric_anomaly + vec_size,
+                                        cos_eccentric_anomaly + vec_size);
+    stats_.batches += 1;
+  }
+};
+
+}  // namespace kepler
+
+#endif
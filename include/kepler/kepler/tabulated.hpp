@@ -0,0 +1,545 @@
+#ifndef KEPLER_TABULATED_HPP
+#define KEPLER_TABULATED_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define KEPLER_TABULATED_MMAP
+#endif
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/math.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "xsimd/xsimd.hpp"
+
+// A single precision solver that reads E from a precomputed two dimensional
+// table, with no refinement. The range [0, max_eccentricity] x [0, pi] of
+// eccentricity and reduced mean anomaly is split into a grid of cells, and
+// each cell stores a tensor product polynomial in both variables, fit by
+// interpolation at Chebyshev nodes. When the solver is called for an
+// eccentricity, the row of cells containing it is collapsed into one
+// polynomial in M per cell, so only that row of the table is ever read, and
+// each element then costs a segment lookup, a Horner evaluation and a sincos.
+//
+// The default grid is accurate to a few 1e-7 for e <= 0.9, which is the
+// rounding error of a float near pi. The grid is bounded away from e = 1
+// because the singular corner at M = 0 needs ever smaller cells, and larger
+// eccentricities fall back on `raposo_pulido_brandt` with `brandt`.
+//
+// Tables are generated by `table::generate` (or the `kepler-table` tool) and
+// saved in a versioned binary format: a fixed `header` followed, at
+// `header::data_offset`, by the coefficients as native-endian floats indexed
+// by [ecc cell][anom cell][ecc power][anom power]. `table::load` maps the file
+// read-only where the platform supports it, so processes loading the same
+// file share its pages and startup doesn't construct anything.
+
+namespace kepler {
+namespace tabulated {
+
+namespace xs = xsimd;
+
+// Bump this whenever the layout of the header or the coefficients changes
+constexpr std::uint32_t format_version = 1;
+
+constexpr char magic[8] = {'K', 'E', 'P', 'L', 'T', 'A', 'B', '\0'};
+
+// Written as a native-endian integer, so that a table generated on a machine
+// with a different byte order is rejected
+constexpr std::uint32_t byte_order_mark = 0x01020304;
+
+// The alignment of the coefficients within the file
+constexpr std::size_t data_alignment = 64;
+
+constexpr std::uint32_t max_degree = 7;
+
+struct header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t num_ecc, num_anom;
+  std::uint32_t ecc_degree, anom_degree;
+  double max_eccentricity;
+
+  // The largest error in E found by `table::generate` when sampling between
+  // the interpolation nodes
+  double max_error;
+
+  std::uint64_t data_offset, data_size;
+};
+
+static_assert(sizeof(header) == 64, "the table header must be 64 bytes");
+
+enum status : int {
+  ok = 0,
+  io_error,
+  bad_magic,
+  bad_version,
+  bad_byte_order,
+  bad_header,
+};
+
+inline const char* describe(status s) {
+  switch (s) {
+    case ok:
+      return "ok";
+    case io_error:
+      return "unable to read or write the table file";
+    case bad_magic:
+      return "not a table file";
+    case bad_version:
+      return "unsupported table format version";
+    case bad_byte_order:
+      return "table was generated with a different byte order";
+    case bad_header:
+      return "invalid table header";
+  }
+  return "unknown error";
+}
+
+// The shape of a generated table. The default is 1.25 MiB, which fits in a
+// typical L2 cache, but only num_anom * (ecc_degree + 1) * (anom_degree + 1)
+// floats, 20 KiB here, are read per eccentricity.
+struct config {
+  std::uint32_t num_ecc = 64;
+  std::uint32_t num_anom = 256;
+  std::uint32_t ecc_degree = 3;
+  std::uint32_t anom_degree = 4;
+  double max_eccentricity = 0.9;
+
+  std::size_t cell_size() const { return (ecc_degree + 1) * (anom_degree + 1); }
+  std::size_t data_size() const {
+    return std::size_t(num_ecc) * num_anom * cell_size() * sizeof(float);
+  }
+
+  // Whether `data_size` overflows; num_anom must be nonzero
+  bool data_size_overflows() const {
+    const std::size_t max_cells =
+        std::numeric_limits<std::size_t>::max() / (cell_size() * sizeof(float));
+    return num_ecc > max_cells / num_anom;
+  }
+};
+
+namespace detail {
+
+inline double chebyshev_node(std::uint32_t k, std::uint32_t degree) {
+  return 0.5 - 0.5 * std::cos(constants::pi<double>() * (k + 0.5) / (degree + 1));
+}
+
+// The inverse of the Vandermonde matrix of the Chebyshev nodes on [0, 1], so
+// that the monomial coefficients of the interpolant are this matrix times the
+// values at the nodes
+inline std::vector<double> interpolation_matrix(std::uint32_t degree) {
+  const std::uint32_t n = degree + 1;
+  std::vector<double> a(n * n), inv(n * n, 0.);
+  for (std::uint32_t k = 0; k < n; ++k) {
+    const double x = chebyshev_node(k, degree);
+    double xp = 1.;
+    for (std::uint32_t p = 0; p < n; ++p, xp *= x) a[k * n + p] = xp;
+    inv[k * n + k] = 1.;
+  }
+
+  // Gauss-Jordan elimination with partial pivoting
+  for (std::uint32_t col = 0; col < n; ++col) {
+    std::uint32_t pivot = col;
+    for (std::uint32_t r = col + 1; r < n; ++r) {
+      if (std::abs(a[r * n + col]) > std::abs(a[pivot * n + col])) pivot = r;
+    }
+    for (std::uint32_t p = 0; p < n; ++p) {
+      std::swap(a[col * n + p], a[pivot * n + p]);
+      std::swap(inv[col * n + p], inv[pivot * n + p]);
+    }
+    const double scale = 1. / a[col * n + col];
+    for (std::uint32_t p = 0; p < n; ++p) {
+      a[col * n + p] *= scale;
+      inv[col * n + p] *= scale;
+    }
+    for (std::uint32_t r = 0; r < n; ++r) {
+      if (r == col) continue;
+      const double factor = a[r * n + col];
+      for (std::uint32_t p = 0; p < n; ++p) {
+        a[r * n + p] -= factor * a[col * n + p];
+        inv[r * n + p] -= factor * inv[col * n + p];
+      }
+    }
+  }
+  return inv;
+}
+
+// Solve for the reduced eccentric anomaly to double precision
+inline void reference_solve(double eccentricity, const std::vector<double>& mean_anomaly,
+                            std::vector<double>& eccentric_anomaly) {
+  std::vector<double> s(mean_anomaly.size()), c(mean_anomaly.size());
+  eccentric_anomaly.resize(mean_anomaly.size());
+  solver::solve<starters::raposo_pulido_brandt<double>, refiners::brandt<double>>(
+      eccentricity, mean_anomaly.size(), mean_anomaly.data(), eccentric_anomaly.data(), s.data(),
+      c.data());
+}
+
+}  // namespace detail
+
+// A validated table, either generated in memory or mapped from a file
+class table {
+ public:
+  table() = default;
+  table(const table&) = delete;
+  table& operator=(const table&) = delete;
+
+  table(table&& other) noexcept { *this = std::move(other); }
+
+  table& operator=(table&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      storage_ = std::move(other.storage_);
+      mapping_ = other.mapping_;
+      mapping_size_ = other.mapping_size_;
+      data_ = mapping_ ? static_cast<const unsigned char*>(mapping_) : storage_.data();
+      size_ = other.size_;
+      if (!size_) data_ = nullptr;
+      other.mapping_ = nullptr;
+      other.mapping_size_ = 0;
+      other.data_ = nullptr;
+      other.size_ = 0;
+    }
+    return *this;
+  }
+
+  ~table() { unmap(); }
+
+  bool valid() const { return data_ != nullptr; }
+  const header& info() const { return *reinterpret_cast<const header*>(data_); }
+  const float* coefficients() const {
+    return reinterpret_cast<const float*>(data_ + info().data_offset);
+  }
+
+  // The full contents of the table file
+  const unsigned char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+  // Check that `size` bytes at `data` hold a table that this version can read
+  static status validate(const void* data, std::size_t size) {
+    if (size < sizeof(header)) return bad_header;
+    header h;
+    std::memcpy(&h, data, sizeof(header));
+    if (std::memcmp(h.magic, magic, sizeof(magic)) != 0) return bad_magic;
+    if (h.byte_order != byte_order_mark) return bad_byte_order;
+    if (h.version != format_version) return bad_version;
+    if (h.num_ecc == 0 || h.num_anom == 0 || h.ecc_degree > max_degree ||
+        h.anom_degree > max_degree || !(h.max_eccentricity > 0.) ||
+        !(h.max_eccentricity < 1.)) {
+      return bad_header;
+    }
+    const config shape{h.num_ecc, h.num_anom, h.ecc_degree, h.anom_degree, h.max_eccentricity};
+    if (shape.data_size_overflows()) return bad_header;
+    if (h.data_offset < sizeof(header) || h.data_offset % data_alignment != 0 ||
+        h.data_size != shape.data_size() || h.data_offset > size ||
+        h.data_size > size - h.data_offset) {
+      return bad_header;
+    }
+    return ok;
+  }
+
+  // Fit a table with the given shape. This solves Kepler's equation at
+  // (ecc_degree + 1) * (anom_degree + 1) nodes per cell, and then samples the
+  // fit between the nodes to estimate its error.
+  static table generate(const config& shape = config()) {
+    table result;
+    if (shape.num_ecc == 0 || shape.num_anom == 0 || shape.ecc_degree > max_degree ||
+        shape.anom_degree > max_degree || !(shape.max_eccentricity > 0.) ||
+        !(shape.max_eccentricity < 1.) || shape.data_size_overflows()) {
+      return result;
+    }
+
+    header h;
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = format_version;
+    h.byte_order = byte_order_mark;
+    h.num_ecc = shape.num_ecc;
+    h.num_anom = shape.num_anom;
+    h.ecc_degree = shape.ecc_degree;
+    h.anom_degree = shape.anom_degree;
+    h.max_eccentricity = shape.max_eccentricity;
+    h.max_error = 0.;
+    h.data_offset = (sizeof(header) + data_alignment - 1) / data_alignment * data_alignment;
+    h.data_size = shape.data_size();
+
+    result.storage_.assign(h.data_offset + h.data_size, 0);
+    float* coeffs = reinterpret_cast<float*>(result.storage_.data() + h.data_offset);
+
+    const std::uint32_t ne = h.ecc_degree + 1, nm = h.anom_degree + 1;
+    const std::size_t cell_size = shape.cell_size();
+    const double ecc_step = h.max_eccentricity / h.num_ecc;
+    const double anom_step = constants::pi<double>() / h.num_anom;
+    const auto ecc_matrix = detail::interpolation_matrix(h.ecc_degree);
+    const auto anom_matrix = detail::interpolation_matrix(h.anom_degree);
+
+    // The values of E at the nodes in M for a row of cells, at each node in e
+    std::vector<double> mean_anom(std::size_t(h.num_anom) * nm), values(ne * mean_anom.size()),
+        ecc_anom;
+    for (std::uint32_t j = 0; j < h.num_anom; ++j) {
+      for (std::uint32_t p = 0; p < nm; ++p) {
+        mean_anom[j * nm + p] = (j + detail::chebyshev_node(p, h.anom_degree)) * anom_step;
+      }
+    }
+
+    std::vector<double> fit(cell_size);
+    for (std::uint32_t i = 0; i < h.num_ecc; ++i) {
+      for (std::uint32_t q = 0; q < ne; ++q) {
+        detail::reference_solve((i + detail::chebyshev_node(q, h.ecc_degree)) * ecc_step,
+                                mean_anom, ecc_anom);
+        std::copy(ecc_anom.begin(), ecc_anom.end(), values.begin() + q * mean_anom.size());
+      }
+
+      for (std::uint32_t j = 0; j < h.num_anom; ++j) {
+        // fit = ecc_matrix * values * anom_matrix^T for this cell
+        for (std::uint32_t q = 0; q < ne; ++q) {
+          for (std::uint32_t p = 0; p < nm; ++p) {
+            double sum = 0.;
+            for (std::uint32_t a = 0; a < ne; ++a) {
+              for (std::uint32_t b = 0; b < nm; ++b) {
+                sum += ecc_matrix[q * ne + a] * anom_matrix[p * nm + b] *
+                       values[a * mean_anom.size() + j * nm + b];
+              }
+            }
+            fit[q * nm + p] = sum;
+          }
+        }
+        float* cell = coeffs + (std::size_t(i) * h.num_anom + j) * cell_size;
+        for (std::size_t k = 0; k < cell_size; ++k) cell[k] = float(fit[k]);
+      }
+    }
+    std::memcpy(result.storage_.data(), &h, sizeof(header));
+    result.data_ = result.storage_.data();
+    result.size_ = result.storage_.size();
+
+    // Sample midway between the nodes, and at the upper edge of each row of
+    // cells, using the float coefficients
+    const double ecc_samples[] = {0.5, 1.};
+    std::vector<double> sample_anom(std::size_t(h.num_anom) * 2), expected;
+    for (std::uint32_t j = 0; j < h.num_anom; ++j) {
+      sample_anom[2 * j] = (j + 0.25) * anom_step;
+      sample_anom[2 * j + 1] = (j + 0.75) * anom_step;
+    }
+    for (std::uint32_t i = 0; i < h.num_ecc; ++i) {
+      for (const auto u : ecc_samples) {
+        const double eccentricity = (i + u) * ecc_step;
+        detail::reference_solve(eccentricity, sample_anom, expected);
+        const auto row = result.row(float(eccentricity));
+        for (std::size_t k = 0; k < sample_anom.size(); ++k) {
+          const double error =
+              std::abs(double(row.evaluate(float(sample_anom[k]))) - expected[k]);
+          if (error > h.max_error) h.max_error = error;
+        }
+      }
+    }
+    std::memcpy(result.storage_.data(), &h, sizeof(header));
+    return result;
+  }
+
+  // Map (or read) the table in the file at `path`, replacing the current table
+  status load(const char* path) {
+    *this = table();
+#ifdef KEPLER_TABULATED_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return io_error;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return io_error;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    if (size < sizeof(header)) {
+      close(fd);
+      return bad_header;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return io_error;
+    status s = validate(mapping, size);
+    if (s != ok) {
+      munmap(mapping, size);
+      return s;
+    }
+    madvise(mapping, size, MADV_RANDOM);
+    mapping_ = mapping;
+    mapping_size_ = size;
+    data_ = static_cast<const unsigned char*>(mapping);
+    size_ = size;
+#else
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return io_error;
+    std::vector<unsigned char> contents;
+    unsigned char buffer[1 << 16];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+      contents.insert(contents.end(), buffer, buffer + n);
+    }
+    bool failed = std::ferror(file);
+    std::fclose(file);
+    if (failed) return io_error;
+    status s = validate(contents.data(), contents.size());
+    if (s != ok) return s;
+    storage_ = std::move(contents);
+    data_ = storage_.data();
+    size_ = storage_.size();
+#endif
+    return ok;
+  }
+
+  status save(const char* path) const {
+    if (!valid()) return bad_header;
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) return io_error;
+    bool failed = std::fwrite(data_, 1, size_, file) != size_;
+    failed = std::fclose(file) != 0 || failed;
+    return failed ? io_error : ok;
+  }
+
+  // The row of the table for one eccentricity, collapsed to a polynomial in
+  // the local coordinate t in [0, 1] for each segment of M
+  struct row_type {
+    std::vector<float> coefficients;
+    std::uint32_t num_anom = 0, degree = 0;
+    float scale = 0.f;
+
+    // A kernel for `solver::detail::solve` and `solver::detail::solve_simd`,
+    // for reduced mean anomalies in [0, pi]
+    template <typename V>
+    inline V operator()(const V& mean_anomaly, V* sin_eccentric_anomaly,
+                        V* cos_eccentric_anomaly) const {
+      auto ecc_anom = evaluate(mean_anomaly);
+      auto sincos = math::sincos(ecc_anom);
+      *sin_eccentric_anomaly = sincos.first;
+      *cos_eccentric_anomaly = sincos.second;
+      return ecc_anom;
+    }
+
+    inline float evaluate(const float& mean_anomaly) const {
+      // Written so that NaN ends up in the last segment rather than indexing
+      // out of bounds
+      const float x = mean_anomaly * scale;
+      const float last = float(num_anom - 1);
+      const int j = int(x < last ? x : last);
+      const float t = x - float(j);
+      const float* c = &coefficients[std::size_t(j) * (degree + 1)];
+      float result = c[degree];
+      for (int p = int(degree) - 1; p >= 0; --p) result = math::fma(result, t, c[p]);
+      return result;
+    }
+
+    template <typename A>
+    inline xs::batch<float, A> evaluate(const xs::batch<float, A>& mean_anomaly) const {
+      using B = xs::batch<float, A>;
+      using I = typename xs::as_integer_t<B>;
+      static_assert(B::size == I::size, "integer batch size must match float batch size");
+      const auto x = mean_anomaly * B(scale);
+      const B last(float(num_anom - 1));
+      const auto j = xs::to_int(xs::select(x < last, x, last));
+      const auto t = x - xs::batch_cast<float>(j);
+      const auto k = j * I(int(degree + 1));
+      auto result = B::gather(coefficients.data(), k + I(int(degree)));
+      for (int p = int(degree) - 1; p >= 0; --p) {
+        result = xs::fma(result, t, B::gather(coefficients.data(), k + I(p)));
+      }
+      return result;
+    }
+  };
+
+  // Requires a valid table and 0 <= eccentricity <= max_eccentricity
+  row_type row(const float& eccentricity) const {
+    const header& h = info();
+    const std::uint32_t ne = h.ecc_degree + 1, nm = h.anom_degree + 1;
+    const double x = double(eccentricity) * h.num_ecc / h.max_eccentricity;
+    const std::uint32_t i = std::min(std::uint32_t(x), h.num_ecc - 1);
+    const double u = x - i;
+
+    row_type r;
+    r.num_anom = h.num_anom;
+    r.degree = h.anom_degree;
+    r.scale = float(h.num_anom / constants::pi<double>());
+    r.coefficients.resize(std::size_t(h.num_anom) * nm);
+    const float* cells = coefficients() + std::size_t(i) * h.num_anom * ne * nm;
+    for (std::uint32_t j = 0; j < h.num_anom; ++j) {
+      const float* cell = cells + std::size_t(j) * ne * nm;
+      for (std::uint32_t p = 0; p < nm; ++p) {
+        double value = cell[h.ecc_degree * nm + p];
+        for (int q = int(h.ecc_degree) - 1; q >= 0; --q) value = value * u + cell[q * nm + p];
+        r.coefficients[std::size_t(j) * nm + p] = float(value);
+      }
+    }
+    return r;
+  }
+
+ private:
+  std::vector<unsigned char> storage_;
+  void* mapping_ = nullptr;
+  std::size_t mapping_size_ = 0;
+  const unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+
+  void unmap() {
+#ifdef KEPLER_TABULATED_MMAP
+    if (mapping_) munmap(mapping_, mapping_size_);
+#endif
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+};
+
+namespace detail {
+
+inline bool in_range(const table& t, const float& eccentricity) {
+  return t.valid() && eccentricity >= 0.f && eccentricity <= t.info().max_eccentricity;
+}
+
+}  // namespace detail
+
+// Solve Kepler's equation using the table `t`. Eccentricities outside of the
+// table, or an invalid table, fall back on `raposo_pulido_brandt` with `brandt`.
+inline void solve(const table& t, const float& eccentricity, std::size_t size,
+                  const float* mean_anomaly, float* eccentric_anomaly,
+                  float* sin_eccentric_anomaly, float* cos_eccentric_anomaly) {
+  if (!detail::in_range(t, eccentricity)) {
+    solver::solve<starters::raposo_pulido_brandt<float>, refiners::brandt<float>>(
+        eccentricity, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+        cos_eccentric_anomaly);
+    return;
+  }
+  const auto kernel = t.row(eccentricity);
+  solver::detail::solve(kernel, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                        cos_eccentric_anomaly);
+}
+
+template <typename Tag = xs::unaligned_mode>
+inline void solve_simd(const table& t, const float& eccentricity, std::size_t size,
+                       const float* mean_anomaly, float* eccentric_anomaly,
+                       float* sin_eccentric_anomaly, float* cos_eccentric_anomaly) {
+  if (!detail::in_range(t, eccentricity)) {
+    solver::solve_simd<starters::raposo_pulido_brandt<float>, refiners::brandt<float>, Tag>(
+        eccentricity, size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+        cos_eccentric_anomaly);
+    return;
+  }
+  const auto kernel = t.row(eccentricity);
+  solver::detail::solve_simd<Tag>(kernel, size, mean_anomaly, eccentric_anomaly,
+                                  sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+}  // namespace tabulated
+}  // namespace kepler
+
+#undef KEPLER_TABULATED_MMAP
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef KEPLER_TRANSIT_HPP
+#define KEPLER_TRANSIT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "xsimd/xsimd.hpp"
+
+namespace kepler {
+namespace transit {
+
+namespace xs = xsimd;
+
+// The elements of an orbit, in the conventions of batman: the semi-major axis
+// is in units of the stellar radius, the angles are in radians, and the
+// planet transits when the true anomaly is pi/2 - omega.
+template <typename T>
+struct orbit {
+  T period;
+  T time_of_periastron;
+  T eccentricity;
+  T omega;
+  T semimajor_axis;
+  T inclination;
+
+  // Construct an orbit from the time of transit (inferior conjunction) rather
+  // than the time of periastron
+  static orbit from_transit(const T& period, const T& time_of_transit, const T& eccentricity,
+                            const T& omega, const T& semimajor_axis, const T& inclination) {
+    const T true_anom = constants::pio2<T>() - omega;
+    const T ecc_anom =
+        T(2) * std::atan(std::sqrt((T(1) - eccentricity) / (T(1) + eccentricity)) *
+                         std::tan(T(0.5) * true_anom));
+    const T mean_anom = ecc_anom - eccentricity * std::sin(ecc_anom);
+    return {period,
+            time_of_transit - period * mean_anom / constants::twopi<T>(),
+            eccentricity,
+            omega,
+            semimajor_axis,
+            inclination};
+  }
+};
+
+// The sky projection of an orbit, with the trigonometric factors precomputed
+template <typename T>
+class projection {
+ public:
+  explicit projection(const orbit<T>& orb)
+      : eccentricity_(orb.eccentricity),
+        semimajor_axis_(orb.semimajor_axis),
+        semiminor_axis_(orb.semimajor_axis *
+                        std::sqrt((T(1) - orb.eccentricity) * (T(1) + orb.eccentricity))),
+        cos_omega_(std::cos(orb.omega)),
+        sin_omega_(std::sin(orb.omega)),
+        cos_incl_(std::cos(orb.inclination)),
+        // The orbital speed is largest at periastron, where it is
+        // n a sqrt((1 + e) / (1 - e)). Projection onto the sky can only make it
+        // smaller, so this is a Lipschitz constant for the projected separation
+        // as a function of the mean anomaly.
+        max_speed_(orb.semimajor_axis *
+                   std::sqrt((T(1) + orb.eccentricity) / (T(1) - orb.eccentricity))) {}
+
+  // The projected separation between the centers of the star and planet, in
+  // units of the stellar radius
+  T separation(const T& sin_eccentric_anomaly, const T& cos_eccentric_anomaly) const {
+    const T x = semimajor_axis_ * (cos_eccentric_anomaly - eccentricity_);
+    const T y = semiminor_axis_ * sin_eccentric_anomaly;
+    const T u = x * cos_omega_ - y * sin_omega_;
+    const T v = (x * sin_omega_ + y * cos_omega_) * cos_incl_;
+    return std::sqrt(u * u + v * v);
+  }
+
+  // The largest rate of change of the projected separation with respect to
+  // the mean anomaly
+  const T& max_speed() const { return max_speed_; }
+
+ private:
+  T eccentricity_, semimajor_axis_, semiminor_axis_, cos_omega_, sin_omega_, cos_incl_,
+      max_speed_;
+};
+
+namespace detail {
+
+// Cull the times in blocks of `block_size`: the eccentric anomaly is computed
+// at the center of each block and, if the projected separation there is
+// further from the star than the planet can move within the block, none of
+// the block can be in transit. The indices of the remaining times are
+// compacted into `index`, and their mean anomalies are staged in
+// `eccentric_anomaly` so that they can be solved in place.
+template <typename T, typename Kernel>
+inline std::size_t cull(const Kernel& kernel, const orbit<T>& orb, const T& radius,
+                        std::size_t size, const T* time, std::size_t* index,
+                        T* eccentric_anomaly, std::size_t block_size) {
+  const projection<T> proj(orb);
+  const T mean_motion = constants::twopi<T>() / orb.period;
+  block_size = std::max<std::size_t>(block_size, 1);
+
+  std::size_t count = 0;
+  for (std::size_t begin = 0; begin < size; begin += block_size) {
+    const std::size_t end = std::min(size, begin + block_size);
+    const auto range = std::minmax_element(time + begin, time + end);
+    const T t_min = *range.first, t_max = *range.second;
+
+    const T mean_anom = mean_motion * (T(0.5) * (t_min + t_max) - orb.time_of_periastron);
+    const T half_width = T(0.5) * mean_motion * (t_max - t_min);
+    T ecc_anom, sin_ecc_anom, cos_ecc_anom;
+    solver::detail::solve_one(kernel, mean_anom, ecc_anom, sin_ecc_anom, cos_ecc_anom);
+    if (proj.separation(sin_ecc_anom, cos_ecc_anom) - proj.max_speed() * half_width > radius) {
+      continue;
+    }
+
+    for (std::size_t n = begin; n < end; ++n) {
+      index[count] = n;
+      eccentric_anomaly[count] = mean_motion * (time[n] - orb.time_of_periastron);
+      ++count;
+    }
+  }
+  return count;
+}
+
+}  // namespace detail
+
+// Solve Kepler's equation only for the times that could be in transit, that is,
+// where the projected separation might be less than `radius` (in units of the
+// stellar radius, so 1 + the radius ratio for the full transit). The culling is
+// conservative: every time in transit is solved, but so are some nearby times
+// and, since only the projected separation is bounded, times near secondary
+// eclipse.
+//
+// The indices of the solved times are written to `index`, and their eccentric
+// anomalies to the first elements of the output arrays, in the same order; the
+// number of solved times is returned. All of the outputs must have room for
+// `size` elements. The cost of the culling is one scalar solve per block, so
+// `block_size` should be small compared to the number of times in a transit,
+// but large compared to the SIMD width. The times in a block don't need to be
+// sorted, but the culling is only effective if they're close together.
+template <typename Starter, typename Refiner, typename Tag = xs::unaligned_mode>
+inline std::size_t solve(
+    const orbit<typename solver::value_type<Starter, Refiner>::type>& orb,
+    const typename solver::value_type<Starter, Refiner>::type& radius, std::size_t size,
+    const typename solver::value_type<Starter, Refiner>::type* time, std::size_t* index,
+    typename solver::value_type<Starter, Refiner>::type* eccentric_anomaly,
+    typename solver::value_type<Starter, Refiner>::type* sin_eccentric_anomaly,
+    typename solver::value_type<Starter, Refiner>::type* cos_eccentric_anomaly,
+    std::size_t block_size = 64, const Refiner& refiner = Refiner()) {
+  std::size_t count = 0;
+  solver::detail::with_kernel<Starter>(orb.eccentricity, refiner, [&](const auto& kernel) {
+    count = detail::cull(kernel, orb, radius, size, time, index, eccentric_anomaly, block_size);
+    solver::detail::solve_simd<Tag>(kernel, count, eccentric_anomaly, eccentric_anomaly,
+                                    sin_eccentric_anomaly, cos_eccentric_anomaly);
+  });
+  return count;
+}
+
+// The same, using the default starter and refiner of `kepler::solve`
+template <typename T>
+inline std::size_t solve(const orbit<T>& orb, const T& radius, std::size_t size, const T* time,
+                         std::size_t* index, T* eccentric_anomaly, T* sin_eccentric_anomaly,
+                         T* cos_eccentric_anomaly, std::size_t block_size = 64) {
+  return solve<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+      orb, radius, size, time, index, eccentric_anomaly, sin_eccentric_anomaly,
+      cos_eccentric_anomaly, block_size);
+}
+
+}  // namespace transit
+}  // namespace kepler
+
+#endif
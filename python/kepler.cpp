@@ -0,0 +1,228 @@
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "kepler/kepler.h"
+#include "kepler/kepler.hpp"
+
+namespace py = pybind11;
+
+namespace {
+
+// Strided inputs and outputs are copied through a scratch buffer in chunks of
+// this many elements, so that the solver itself always sees contiguous data
+constexpr std::size_t chunk_size = 4096;
+
+// Arrays are only accepted if they already have the right dtype, since any
+// conversion would be a copy
+template <typename T>
+using array = py::array_t<T, 0>;
+
+template <typename T>
+struct strided {
+  char* data;
+  py::ssize_t stride;
+
+  bool contiguous() const { return stride == py::ssize_t(sizeof(T)); }
+  T* ptr() const { return reinterpret_cast<T*>(data); }
+  T& operator[](std::size_t i) const { return *reinterpret_cast<T*>(data + i * stride); }
+};
+
+template <typename T>
+strided<T> view(const py::array& x, const void* ptr, py::ssize_t size, const char* name) {
+  // The input is only ever read through this pointer
+  char* data = static_cast<char*>(const_cast<void*>(ptr));
+  if (x.size() != size) {
+    throw py::value_error(std::string(name) + " must have the same size as mean_anomaly");
+  }
+  if (x.flags() & py::array::c_style) return {data, py::ssize_t(sizeof(T))};
+  if (x.ndim() != 1) {
+    throw py::value_error(std::string(name) + " must be one dimensional or C contiguous");
+  }
+  return {data, x.strides(0)};
+}
+
+template <typename T>
+array<T> output(const py::object& obj, const array<T>& mean_anomaly, const char* name) {
+  if (obj.is_none()) {
+    return array<T>(std::vector<py::ssize_t>(mean_anomaly.shape(),
+                                             mean_anomaly.shape() + mean_anomaly.ndim()));
+  }
+  if (!array<T>::check_(obj)) {
+    throw py::type_error(std::string(name) + " must be an array with the same dtype as "
+                         "mean_anomaly");
+  }
+  return py::reinterpret_borrow<array<T>>(obj);
+}
+
+// Solve for every element of `mean_anomaly` using `solve(size, M, E, sin, cos)`
+// on contiguous data, writing into the (optional) output arrays, and return the
+// eccentric anomaly. The GIL is released while solving.
+template <typename T, typename Solve>
+array<T> solve_array(const Solve& solve, const array<T>& mean_anomaly,
+                      const py::object& eccentric_anomaly_obj,
+                      const py::object& sin_eccentric_anomaly_obj,
+                      const py::object& cos_eccentric_anomaly_obj) {
+  auto eccentric_anomaly = output(eccentric_anomaly_obj, mean_anomaly, "eccentric_anomaly");
+  auto sin_eccentric_anomaly =
+      output(sin_eccentric_anomaly_obj, mean_anomaly, "sin_eccentric_anomaly");
+  auto cos_eccentric_anomaly =
+      output(cos_eccentric_anomaly_obj, mean_anomaly, "cos_eccentric_anomaly");
+
+  const py::ssize_t size = mean_anomaly.size();
+  auto M = view<T>(mean_anomaly, mean_anomaly.data(), size, "mean_anomaly");
+  auto E = view<T>(eccentric_anomaly, eccentric_anomaly.mutable_data(), size,
+                   "eccentric_anomaly");
+  auto s = view<T>(sin_eccentric_anomaly, sin_eccentric_anomaly.mutable_data(), size,
+                   "sin_eccentric_anomaly");
+  auto c = view<T>(cos_eccentric_anomaly, cos_eccentric_anomaly.mutable_data(), size,
+                   "cos_eccentric_anomaly");
+
+  {
+    py::gil_scoped_release release;
+    if (M.contiguous() && E.contiguous() && s.contiguous() && c.contiguous()) {
+      solve(std::size_t(size), M.ptr(), E.ptr(), s.ptr(), c.ptr());
+    } else {
+      std::vector<T> scratch(4 * chunk_size);
+      T* m_ = scratch.data();
+      T* E_ = m_ + chunk_size;
+      T* s_ = E_ + chunk_size;
+      T* c_ = s_ + chunk_size;
+      for (std::size_t begin = 0; begin < std::size_t(size); begin += chunk_size) {
+        std::size_t count = std::min(chunk_size, std::size_t(size) - begin);
+        for (std::size_t i = 0; i < count; ++i) m_[i] = M[begin + i];
+        solve(count, m_, E_, s_, c_);
+        for (std::size_t i = 0; i < count; ++i) {
+          E[begin + i] = E_[i];
+          s[begin + i] = s_[i];
+          c[begin + i] = c_[i];
+        }
+      }
+    }
+  }
+
+  return eccentric_anomaly;
+}
+
+template <typename T>
+array<T> solve(const array<T>& mean_anomaly, T eccentricity,
+               const py::object& eccentric_anomaly, const py::object& sin_eccentric_anomaly,
+               const py::object& cos_eccentric_anomaly) {
+  auto impl = [eccentricity](std::size_t size, const T* M, T* E, T* s, T* c) {
+    kepler::solve<T>(1, &eccentricity, size, M, E, s, c);
+  };
+  return solve_array<T>(impl, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                        cos_eccentric_anomaly);
+}
+
+// A thin owner of a `kepler_plan`, exposing the runtime algorithm selection of
+// the C API
+class plan {
+ public:
+  plan(const std::string& starter, const std::string& refiner, int order,
+       const std::string& dtype, double tolerance, std::size_t num_threads) {
+    static const std::map<std::string, kepler_starter> starters = {
+        {"noop", KEPLER_STARTER_NOOP},
+        {"basic", KEPLER_STARTER_BASIC},
+        {"mikkola", KEPLER_STARTER_MIKKOLA},
+        {"markley", KEPLER_STARTER_MARKLEY},
+        {"raposo_pulido_brandt", KEPLER_STARTER_RAPOSO_PULIDO_BRANDT},
+        {"fukushima", KEPLER_STARTER_FUKUSHIMA},
+        {"nijenhuis", KEPLER_STARTER_NIJENHUIS},
+        {"contour", KEPLER_STARTER_CONTOUR}};
+    static const std::map<std::string, kepler_refiner> refiners = {
+        {"noop", KEPLER_REFINER_NOOP},
+        {"iterative", KEPLER_REFINER_ITERATIVE},
+        {"non_iterative", KEPLER_REFINER_NON_ITERATIVE},
+        {"brandt", KEPLER_REFINER_BRANDT}};
+    static const std::map<std::string, kepler_precision> precisions = {
+        {"float64", KEPLER_PRECISION_DOUBLE}, {"float32", KEPLER_PRECISION_FLOAT}};
+
+    auto s = starters.find(starter);
+    if (s == starters.end()) throw py::value_error("unknown starter: " + starter);
+    auto r = refiners.find(refiner);
+    if (r == refiners.end()) throw py::value_error("unknown refiner: " + refiner);
+    auto p = precisions.find(dtype);
+    if (p == precisions.end()) throw py::value_error("dtype must be float64 or float32");
+
+    plan_ = kepler_plan_create(s->second, r->second, order, p->second, tolerance, num_threads);
+    if (plan_ == nullptr) throw py::value_error("invalid plan configuration");
+  }
+
+  ~plan() { kepler_plan_destroy(plan_); }
+
+  plan(const plan&) = delete;
+  plan& operator=(const plan&) = delete;
+
+  template <typename T>
+  array<T> solve(const array<T>& mean_anomaly, T eccentricity,
+                 const py::object& eccentric_anomaly, const py::object& sin_eccentric_anomaly,
+                  const py::object& cos_eccentric_anomaly) const {
+    kepler_status status = KEPLER_SUCCESS;
+    auto impl = [this, eccentricity, &status](std::size_t size, const T* M, T* E, T* s, T* c) {
+      if (status == KEPLER_SUCCESS) status = execute(size, &eccentricity, M, E, s, c);
+    };
+    auto result = solve_array<T>(impl, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+                                 cos_eccentric_anomaly);
+    if (status == KEPLER_ERROR_WRONG_PRECISION) {
+      throw py::type_error("mean_anomaly dtype doesn't match the plan");
+    } else if (status != KEPLER_SUCCESS) {
+      throw py::value_error("invalid arguments");
+    }
+    return result;
+  }
+
+ private:
+  kepler_plan* plan_;
+
+  kepler_status execute(std::size_t size, const double* e, const double* M, double* E,
+                        double* s, double* c) const {
+    return kepler_plan_execute(plan_, 1, e, size, M, E, s, c);
+  }
+
+  kepler_status execute(std::size_t size, const float* e, const float* M, float* E, float* s,
+                        float* c) const {
+    return kepler_plan_executef(plan_, 1, e, size, M, E, s, c);
+  }
+};
+
+}  // namespace
+
+PYBIND11_MODULE(kepler, m) {
+  m.doc() = "A tuned and hardware-accelerated solver for Kepler's equation";
+
+  const char* solve_doc =
+      "Solve Kepler's equation for a single eccentricity\n\n"
+      "The arrays must have dtype float64 or float32 and are never copied as a whole; strided "
+      "arrays are processed in chunks. If the outputs aren't provided, they are allocated. The "
+      "GIL is released while solving.\n\n"
+      "Returns the eccentric anomaly. Its sine and cosine are only returned through the "
+      "optional output arrays.";
+  m.def("solve", &solve<double>, py::arg("mean_anomaly").noconvert(), py::arg("eccentricity"),
+        py::arg("eccentric_anomaly") = py::none(), py::arg("sin_eccentric_anomaly") = py::none(),
+        py::arg("cos_eccentric_anomaly") = py::none(), solve_doc);
+  m.def("solve", &solve<float>, py::arg("mean_anomaly").noconvert(), py::arg("eccentricity"),
+        py::arg("eccentric_anomaly") = py::none(), py::arg("sin_eccentric_anomaly") = py::none(),
+        py::arg("cos_eccentric_anomaly") = py::none(), solve_doc);
+
+  py::class_<plan>(m, "Plan",
+                   "A solver with the algorithm selected at runtime; see kepler_plan_create")
+      .def(py::init<const std::string&, const std::string&, int, const std::string&, double,
+                    std::size_t>(),
+           py::arg("starter") = "raposo_pulido_brandt", py::arg("refiner") = "brandt",
+           py::arg("order") = 2, py::arg("dtype") = "float64", py::arg("tolerance") = 0.0,
+           py::arg("num_threads") = 1)
+      .def("solve", &plan::solve<double>, py::arg("mean_anomaly").noconvert(),
+           py::arg("eccentricity"), py::arg("eccentric_anomaly") = py::none(),
+           py::arg("sin_eccentric_anomaly") = py::none(),
+           py::arg("cos_eccentric_anomaly") = py::none())
+      .def("solve", &plan::solve<float>, py::arg("mean_anomaly").noconvert(),
+           py::arg("eccentricity"), py::arg("eccentric_anomaly") = py::none(),
+           py::arg("sin_eccentric_anomaly") = py::none(),
+           py::arg("cos_eccentric_anomaly") = py::none());
+}
@@ -0,0 +1,270 @@
+// kepler-batch: solve Kepler's equation for a flat binary file of records
+//
+// Usage: kepler-batch [--float] [--chunk-size N] [--time] input output
+//
+// The input is a sequence of (eccentricity, mean anomaly) records and the
+// output is a sequence of (E, sin E, cos E) records, both native-endian double
+// (or float with --float). Both files are memory mapped and streamed through a
+// three stage pipeline: one thread deinterleaves a chunk of the input, one
+// solves it, and one interleaves the results into the output, so that reading,
+// solving and writing overlap. Pages are released as soon as each stage is done
+// with them, so the memory use doesn't depend on the file size. With --time,
+// the wall time and the throughput, counting the bytes read and written, are
+// printed to stderr so that they can be compared with the disk bandwidth.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kepler/kepler.hpp"
+
+namespace {
+
+// The number of records per chunk. The default keeps the five working arrays
+// of a chunk within a typical L2 cache.
+constexpr std::size_t default_chunk_size = 1 << 14;
+
+// The number of chunks in flight, one per stage
+constexpr std::size_t num_slots = 3;
+
+constexpr std::size_t done = static_cast<std::size_t>(-1);
+
+// A blocking queue of slot indices, used to hand chunks between the stages
+class channel {
+ public:
+  void push(std::size_t value) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(value);
+    }
+    ready_.notify_one();
+  }
+
+  std::size_t pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return !queue_.empty(); });
+    std::size_t value = queue_.front();
+    queue_.pop_front();
+    return value;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::size_t> queue_;
+};
+
+template <typename T>
+struct slot {
+  std::size_t begin = 0, size = 0;
+  std::vector<T> eccentricity, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+      cos_eccentric_anomaly;
+
+  explicit slot(std::size_t chunk_size)
+      : eccentricity(chunk_size),
+        mean_anomaly(chunk_size),
+        eccentric_anomaly(chunk_size),
+        sin_eccentric_anomaly(chunk_size),
+        cos_eccentric_anomaly(chunk_size) {}
+};
+
+// A memory mapped file that is unmapped and closed on destruction
+struct mapping {
+  int fd = -1;
+  void* data = MAP_FAILED;
+  std::size_t size = 0;
+
+  ~mapping() {
+    if (data != MAP_FAILED) munmap(data, size);
+    if (fd >= 0) close(fd);
+  }
+};
+
+int fail(const std::string& message) {
+  std::fprintf(stderr, "kepler-batch: %s: %s\n", message.c_str(), std::strerror(errno));
+  return 1;
+}
+
+std::size_t page_size() {
+  static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+// Hint that the byte range [begin, end) of a mapping will be needed soon
+void prefetch(void* base, std::size_t begin, std::size_t end) {
+  begin -= begin % page_size();
+  if (end > begin) madvise(static_cast<char*>(base) + begin, end - begin, MADV_WILLNEED);
+}
+
+// Release the pages of a mapping that are entirely before the byte offset
+// `end`, starting from the page containing `begin`. Dirty pages of a shared
+// mapping stay in the page cache until they are written back, and the partial
+// page at `end` is released along with the next chunk.
+void release(void* base, std::size_t begin, std::size_t end, bool sync) {
+  begin -= begin % page_size();
+  end -= end % page_size();
+  if (end <= begin) return;
+  char* ptr = static_cast<char*>(base) + begin;
+  if (sync) msync(ptr, end - begin, MS_ASYNC);
+  madvise(ptr, end - begin, MADV_DONTNEED);
+}
+
+template <typename T>
+int run(const char* input_path, const char* output_path, std::size_t chunk_size, bool time) {
+  const auto start = std::chrono::steady_clock::now();
+  mapping input, output;
+
+  input.fd = open(input_path, O_RDONLY);
+  if (input.fd < 0) return fail(std::string("unable to open ") + input_path);
+  struct stat st;
+  if (fstat(input.fd, &st) != 0) return fail(std::string("unable to stat ") + input_path);
+  input.size = static_cast<std::size_t>(st.st_size);
+  if (input.size % (2 * sizeof(T)) != 0) {
+    std::fprintf(stderr, "kepler-batch: %s is not a whole number of records\n", input_path);
+    return 1;
+  }
+  const std::size_t num_records = input.size / (2 * sizeof(T));
+
+  output.fd = open(output_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (output.fd < 0) return fail(std::string("unable to open ") + output_path);
+  output.size = num_records * 3 * sizeof(T);
+  if (ftruncate(output.fd, static_cast<off_t>(output.size)) != 0) {
+    return fail(std::string("unable to resize ") + output_path);
+  }
+  if (num_records == 0) return 0;
+
+  input.data = mmap(nullptr, input.size, PROT_READ, MAP_SHARED, input.fd, 0);
+  if (input.data == MAP_FAILED) return fail(std::string("unable to map ") + input_path);
+  output.data = mmap(nullptr, output.size, PROT_READ | PROT_WRITE, MAP_SHARED, output.fd, 0);
+  if (output.data == MAP_FAILED) return fail(std::string("unable to map ") + output_path);
+  madvise(input.data, input.size, MADV_SEQUENTIAL);
+  madvise(output.data, output.size, MADV_SEQUENTIAL);
+
+  const T* in = static_cast<const T*>(input.data);
+  T* out = static_cast<T*>(output.data);
+
+  std::vector<slot<T>> slots(num_slots, slot<T>(chunk_size));
+  channel free_slots, to_solve, to_write;
+  for (std::size_t n = 0; n < num_slots; ++n) free_slots.push(n);
+
+  std::thread reader([&] {
+    for (std::size_t begin = 0; begin < num_records; begin += chunk_size) {
+      slot<T>& s = slots[free_slots.pop()];
+      s.begin = begin;
+      s.size = std::min(chunk_size, num_records - begin);
+
+      // Start paging in the next chunk while this one is copied
+      std::size_t end = begin + s.size;
+      prefetch(input.data, 2 * sizeof(T) * end,
+               2 * sizeof(T) * std::min(num_records, end + chunk_size));
+
+      const T* record = in + 2 * begin;
+      for (std::size_t i = 0; i < s.size; ++i) {
+        s.eccentricity[i] = record[2 * i];
+        s.mean_anomaly[i] = record[2 * i + 1];
+      }
+      release(input.data, 2 * sizeof(T) * begin, 2 * sizeof(T) * end, false);
+      to_solve.push(static_cast<std::size_t>(&s - slots.data()));
+    }
+    to_solve.push(done);
+  });
+
+  std::thread writer([&] {
+    for (std::size_t n = to_write.pop(); n != done; n = to_write.pop()) {
+      slot<T>& s = slots[n];
+      T* record = out + 3 * s.begin;
+      for (std::size_t i = 0; i < s.size; ++i) {
+        record[3 * i] = s.eccentric_anomaly[i];
+        record[3 * i + 1] = s.sin_eccentric_anomaly[i];
+        record[3 * i + 2] = s.cos_eccentric_anomaly[i];
+      }
+
+      release(output.data, 3 * sizeof(T) * s.begin, 3 * sizeof(T) * (s.begin + s.size), true);
+      free_slots.push(n);
+    }
+  });
+
+  // Solve on this thread. Consecutive records with the same eccentricity are
+  // solved together so that the starter is only set up once per run.
+  for (std::size_t n = to_solve.pop(); n != done; n = to_solve.pop()) {
+    slot<T>& s = slots[n];
+    for (std::size_t begin = 0, end = 0; begin < s.size; begin = end) {
+      end = begin + 1;
+      while (end < s.size && s.eccentricity[end] == s.eccentricity[begin]) ++end;
+      kepler::solve<T>(1, &(s.eccentricity[begin]), end - begin, &(s.mean_anomaly[begin]),
+                       &(s.eccentric_anomaly[begin]), &(s.sin_eccentric_anomaly[begin]),
+                       &(s.cos_eccentric_anomaly[begin]));
+    }
+    to_write.push(n);
+  }
+  to_write.push(done);
+
+  reader.join();
+  writer.join();
+
+  if (msync(output.data, output.size, MS_SYNC) != 0) {
+    return fail(std::string("unable to write ") + output_path);
+  }
+
+  if (time) {
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "kepler-batch: %zu records in %.3f s, %.1f MB/s\n", num_records,
+                 elapsed, 1e-6 * double(input.size + output.size) / elapsed);
+  }
+  return 0;
+}
+
+void usage() {
+  std::fprintf(stderr, "usage: kepler-batch [--float] [--chunk-size N] [--time] input output\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool use_float = false, time = false;
+  std::size_t chunk_size = default_chunk_size;
+  std::vector<const char*> paths;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--float") {
+      use_float = true;
+    } else if (arg == "--time") {
+      time = true;
+    } else if (arg == "--chunk-size" && i + 1 < argc) {
+      char* end;
+      chunk_size = std::strtoull(argv[++i], &end, 10);
+      if (*end != '\0' || chunk_size == 0) {
+        usage();
+        return 1;
+      }
+    } else if (arg == "-h" || arg == "--help") {
+      usage();
+      return 0;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.size() != 2) {
+    usage();
+    return 1;
+  }
+
+  if (use_float) return run<float>(paths[0], paths[1], chunk_size, time);
+  return run<double>(paths[0], paths[1], chunk_size, time);
+}
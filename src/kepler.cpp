@@ -2,6 +2,31 @@
 
 #include "kepler/kepler.h"
 
+#include <new>
+
+struct kepler_solver : kepler::Solver<double> {
+  using kepler::Solver<double>::Solver;
+};
+
+struct kepler_solverf : kepler::Solver<float> {
+  using kepler::Solver<float>::Solver;
+};
+
+namespace {
+
+template <typename S>
+inline void get_stats(const S* solver, kepler_solver_stats* stats) {
+  const auto& s = solver->stats();
+  stats->chunks = s.chunks;
+  stats->elements = s.elements;
+  stats->batches = s.batches;
+}
+
+static_assert(KEPLER_NUM_RESIDUAL_BINS == kepler::stats::num_residual_bins,
+              "the number of residual bins must match");
+
+}  // namespace
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -20,6 +45,70 @@ void kepler_solvef(size_t size, const float* eccentricity, size_t batch_size,
                        sin_eccentric_anomaly, cos_eccentric_anomaly);
 }
 
+kepler_solver* kepler_solver_create(double eccentricity) {
+  return new (std::nothrow) kepler_solver(eccentricity);
+}
+
+void kepler_solver_reset(kepler_solver* solver, double eccentricity) {
+  solver->reset(eccentricity);
+}
+
+void kepler_solver_push(kepler_solver* solver, size_t size, const double* mean_anomaly,
+                        double* eccentric_anomaly, double* sin_eccentric_anomaly,
+                        double* cos_eccentric_anomaly) {
+  solver->push(size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+               cos_eccentric_anomaly);
+}
+
+void kepler_solver_get_stats(const kepler_solver* solver, kepler_solver_stats* stats) {
+  get_stats(solver, stats);
+}
+
+void kepler_solver_destroy(kepler_solver* solver) { delete solver; }
+
+kepler_solverf* kepler_solverf_create(float eccentricity) {
+  return new (std::nothrow) kepler_solverf(eccentricity);
+}
+
+void kepler_solverf_reset(kepler_solverf* solver, float eccentricity) {
+  solver->reset(eccentricity);
+}
+
+void kepler_solverf_push(kepler_solverf* solver, size_t size, const float* mean_anomaly,
+                         float* eccentric_anomaly, float* sin_eccentric_anomaly,
+                         float* cos_eccentric_anomaly) {
+  solver->push(size, mean_anomaly, eccentric_anomaly, sin_eccentric_anomaly,
+               cos_eccentric_anomaly);
+}
+
+void kepler_solverf_get_stats(const kepler_solverf* solver, kepler_solver_stats* stats) {
+  get_stats(solver, stats);
+}
+
+void kepler_solverf_destroy(kepler_solverf* solver) { delete solver; }
+
+int kepler_stats_enabled(void) { return kepler::stats::enabled; }
+
+void kepler_stats_get(kepler_convergence_stats* stats) {
+  const auto s = kepler::stats::collect();
+  stats->calls = s.calls;
+  stats->elements = s.elements;
+  stats->iterations = s.iterations;
+  stats->max_iterations_reached = s.max_iterations_reached;
+  stats->iteration_batches = s.iteration_batches;
+  stats->singular = s.singular;
+  stats->singular_mixed_batches = s.singular_mixed_batches;
+  stats->brandt_second_order = s.brandt_second_order;
+  stats->brandt_third_order = s.brandt_third_order;
+  stats->brandt_mixed_batches = s.brandt_mixed_batches;
+  stats->non_finite = s.non_finite;
+  for (int k = 0; k < KEPLER_NUM_RESIDUAL_BINS; ++k) {
+    stats->residual_histogram[k] = s.residual_histogram[k];
+  }
+}
+
+void kepler_stats_reset(void) { kepler::stats::reset(); }
+
 #ifdef __cplusplus
 }
 #endif
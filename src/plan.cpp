@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include "./thread_pool.hpp"
+#include "kepler/kepler.h"
+#include "kepler/kepler.hpp"
+
+namespace {
+
+using namespace kepler;
+
+struct plan_config {
+  double tolerance;
+};
+
+// The type-erased entry point for a single eccentricity, stored in the plan
+template <typename T>
+using solve_fn = void (*)(const plan_config&, T, std::size_t, const T*, T*, T*, T*);
+
+template <typename R>
+struct refiner_factory {
+  static R make(const plan_config&) { return R(); }
+};
+
+template <int order, typename T>
+struct refiner_factory<refiners::iterative<order, T>> {
+  static refiners::iterative<order, T> make(const plan_config& config) {
+    if (config.tolerance > 0) return refiners::iterative<order, T>(T(config.tolerance));
+    return refiners::iterative<order, T>();
+  }
+};
+
+template <typename Starter, typename Refiner>
+void solve_impl(const plan_config& config, typename Starter::value_type eccentricity,
+                std::size_t size, const typename Starter::value_type* mean_anomaly,
+                typename Starter::value_type* eccentric_anomaly,
+                typename Starter::value_type* sin_eccentric_anomaly,
+                typename Starter::value_type* cos_eccentric_anomaly) {
+  solver::solve_simd<Starter, Refiner>(eccentricity, size, mean_anomaly, eccentric_anomaly,
+                                       sin_eccentric_anomaly, cos_eccentric_anomaly,
+                                       refiner_factory<Refiner>::make(config));
+}
+
+template <typename T, template <typename> class Starter>
+solve_fn<T> select_refiner(kepler_refiner refiner, int order) {
+  switch (refiner) {
+    case KEPLER_REFINER_NOOP:
+      return &solve_impl<Starter<T>, refiners::noop<T>>;
+    case KEPLER_REFINER_ITERATIVE:
+      switch (order) {
+        case 1:
+          return &solve_impl<Starter<T>, refiners::iterative<1, T>>;
+        case 2:
+          return &solve_impl<Starter<T>, refiners::iterative<2, T>>;
+        case 3:
+          return &solve_impl<Starter<T>, refiners::iterative<3, T>>;
+        default:
+          return nullptr;
+      }
+    case KEPLER_REFINER_NON_ITERATIVE:
+      switch (order) {
+        case 1:
+          return &solve_impl<Starter<T>, refiners::non_iterative<1, T>>;
+        case 2:
+          return &solve_impl<Starter<T>, refiners::non_iterative<2, T>>;
+        case 3:
+          return &solve_impl<Starter<T>, refiners::non_iterative<3, T>>;
+        default:
+          return nullptr;
+      }
+    case KEPLER_REFINER_BRANDT:
+      return &solve_impl<Starter<T>, refiners::brandt<T>>;
+  }
+  return nullptr;
+}
+
+template <typename T>
+solve_fn<T> select(kepler_starter starter, kepler_refiner refiner, int order) {
+  switch (starter) {
+    case KEPLER_STARTER_NOOP:
+      return select_refiner<T, starters::noop>(refiner, order);
+    case KEPLER_STARTER_BASIC:
+      return select_refiner<T, starters::basic>(refiner, order);
+    case KEPLER_STARTER_MIKKOLA:
+      return select_refiner<T, starters::mikkola>(refiner, order);
+    case KEPLER_STARTER_MARKLEY:
+      return select_refiner<T, starters::markley>(refiner, order);
+    case KEPLER_STARTER_RAPOSO_PULIDO_BRANDT:
+      return select_refiner<T, starters::raposo_pulido_brandt>(refiner, order);
+    case KEPLER_STARTER_FUKUSHIMA:
+      return select_refiner<T, starters::fukushima>(refiner, order);
+    case KEPLER_STARTER_NIJENHUIS:
+      return select_refiner<T, starters::nijenhuis>(refiner, order);
+    case KEPLER_STARTER_CONTOUR:
+      return select_refiner<T, starters::contour16>(refiner, order);
+  }
+  return nullptr;
+}
+
+// Below this many elements per task, splitting a batch across threads costs
+// more than it saves
+constexpr std::size_t min_chunk_size = 1024;
+
+}  // namespace
+
+struct kepler_plan {
+  plan_config config;
+  solve_fn<double> solve_double;
+  solve_fn<float> solve_float;
+  std::unique_ptr<kepler::detail::thread_pool> pool;
+
+  template <typename T>
+  kepler_status execute(solve_fn<T> solve, std::size_t size, const T* eccentricity,
+                        std::size_t batch_size, const T* mean_anomaly, T* eccentric_anomaly,
+                        T* sin_eccentric_anomaly, T* cos_eccentric_anomaly) const {
+    if (solve == nullptr) return KEPLER_ERROR_WRONG_PRECISION;
+    if (size == 0 || batch_size == 0) return KEPLER_SUCCESS;
+    if (eccentricity == nullptr || mean_anomaly == nullptr || eccentric_anomaly == nullptr ||
+        sin_eccentric_anomaly == nullptr || cos_eccentric_anomaly == nullptr) {
+      return KEPLER_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Each task solves a contiguous chunk of one batch. Batches are only split
+    // when there are too few of them to keep every thread busy.
+    std::size_t chunk_size = batch_size;
+    std::size_t num_threads = pool->size();
+    if (size < num_threads) {
+      std::size_t target = (size * batch_size + num_threads - 1) / num_threads;
+      chunk_size = std::min(batch_size, std::max(min_chunk_size, target));
+    }
+    std::size_t chunks_per_batch = (batch_size + chunk_size - 1) / chunk_size;
+
+    const plan_config& config = this->config;
+    pool->run(size * chunks_per_batch, [&](std::size_t task) {
+      std::size_t n = task / chunks_per_batch;
+      std::size_t begin = (task % chunks_per_batch) * chunk_size;
+      std::size_t offset = n * batch_size + begin;
+      solve(config, eccentricity[n], std::min(chunk_size, batch_size - begin),
+            &(mean_anomaly[offset]), &(eccentric_anomaly[offset]),
+            &(sin_eccentric_anomaly[offset]), &(cos_eccentric_anomaly[offset]));
+    });
+    return KEPLER_SUCCESS;
+  }
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+kepler_plan* kepler_plan_create(kepler_starter starter, kepler_refiner refiner, int order,
+                                kepler_precision precision, double tolerance,
+                                size_t num_threads) {
+  solve_fn<double> solve_double = nullptr;
+  solve_fn<float> solve_float = nullptr;
+  if (precision == KEPLER_PRECISION_DOUBLE) {
+    solve_double = select<double>(starter, refiner, order);
+    if (solve_double == nullptr) return nullptr;
+  } else if (precision == KEPLER_PRECISION_FLOAT) {
+    solve_float = select<float>(starter, refiner, order);
+    if (solve_float == nullptr) return nullptr;
+  } else {
+    return nullptr;
+  }
+
+  if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+  try {
+    std::unique_ptr<kepler_plan> plan(
+        new kepler_plan{{tolerance}, solve_double, solve_float, nullptr});
+    plan->pool.reset(new kepler::detail::thread_pool(num_threads));
+    return plan.release();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+kepler_status kepler_plan_execute(const kepler_plan* plan, size_t size,
+                                  const double* eccentricity, size_t batch_size,
+                                  const double* mean_anomaly, double* eccentric_anomaly,
+                                  double* sin_eccentric_anomaly, double* cos_eccentric_anomaly) {
+  if (plan == nullptr) return KEPLER_ERROR_INVALID_ARGUMENT;
+  return plan->execute(plan->solve_double, size, eccentricity, batch_size, mean_anomaly,
+                       eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+kepler_status kepler_plan_executef(const kepler_plan* plan, size_t size,
+                                   const float* eccentricity, size_t batch_size,
+                                   const float* mean_anomaly, float* eccentric_anomaly,
+                                   float* sin_eccentric_anomaly, float* cos_eccentric_anomaly) {
+  if (plan == nullptr) return KEPLER_ERROR_INVALID_ARGUMENT;
+  return plan->execute(plan->solve_float, size, eccentricity, batch_size, mean_anomaly,
+                       eccentric_anomaly, sin_eccentric_anomaly, cos_eccentric_anomaly);
+}
+
+void kepler_plan_destroy(kepler_plan* plan) { delete plan; }
+
+#ifdef __cplusplus
+}
+#endif
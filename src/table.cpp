@@ -0,0 +1,94 @@
+// kepler-table: generate a table file for the tabulated solver
+//
+// Usage: kepler-table [--ecc-cells N] [--anom-cells N] [--ecc-degree N]
+//                     [--anom-degree N] [--max-eccentricity E] output
+//
+// The table is fit with `kepler::tabulated::table::generate` and written in the
+// format described in include/kepler/kepler/tabulated.hpp, which can then be
+// mapped by any number of processes using `kepler::tabulated::table::load`.
+// The defaults match `kepler::tabulated::config`. The size of the table and
+// the largest error found when sampling it are printed.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "kepler/kepler/tabulated.hpp"
+
+namespace {
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: kepler-table [--ecc-cells N] [--anom-cells N] [--ecc-degree N]\n"
+               "                    [--anom-degree N] [--max-eccentricity E] output\n");
+}
+
+bool parse(const char* arg, std::uint32_t& value) {
+  char* end;
+  unsigned long long parsed = std::strtoull(arg, &end, 10);
+  if (*end != '\0' || parsed > 0xffffffffull) return false;
+  value = static_cast<std::uint32_t>(parsed);
+  return true;
+}
+
+bool parse(const char* arg, double& value) {
+  char* end;
+  value = std::strtod(arg, &end);
+  return *end == '\0';
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  kepler::tabulated::config shape;
+  const char* output = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool valid = true;
+    if (arg == "--ecc-cells" && i + 1 < argc) {
+      valid = parse(argv[++i], shape.num_ecc);
+    } else if (arg == "--anom-cells" && i + 1 < argc) {
+      valid = parse(argv[++i], shape.num_anom);
+    } else if (arg == "--ecc-degree" && i + 1 < argc) {
+      valid = parse(argv[++i], shape.ecc_degree);
+    } else if (arg == "--anom-degree" && i + 1 < argc) {
+      valid = parse(argv[++i], shape.anom_degree);
+    } else if (arg == "--max-eccentricity" && i + 1 < argc) {
+      valid = parse(argv[++i], shape.max_eccentricity);
+    } else if (arg == "-h" || arg == "--help") {
+      usage();
+      return 0;
+    } else if (output == nullptr) {
+      output = argv[i];
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      usage();
+      return 1;
+    }
+  }
+  if (output == nullptr) {
+    usage();
+    return 1;
+  }
+
+  const auto table = kepler::tabulated::table::generate(shape);
+  if (!table.valid()) {
+    std::fprintf(stderr,
+                 "kepler-table: the cell counts must be positive, the degrees at most %u, and "
+                 "the maximum eccentricity in (0, 1)\n",
+                 kepler::tabulated::max_degree);
+    return 1;
+  }
+  auto status = table.save(output);
+  if (status != kepler::tabulated::ok) {
+    std::fprintf(stderr, "kepler-table: %s: %s\n", output, kepler::tabulated::describe(status));
+    return 1;
+  }
+  std::printf("%s: %zu bytes, %zu read per eccentricity, max error %.3g for e <= %g\n", output,
+              table.size(), std::size_t(shape.num_anom) * shape.cell_size() * sizeof(float),
+              table.info().max_error, shape.max_eccentricity);
+  return 0;
+}
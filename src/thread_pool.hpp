@@ -0,0 +1,101 @@
+#ifndef KEPLER_SRC_THREAD_POOL_HPP
+#define KEPLER_SRC_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kepler {
+namespace detail {
+
+// A minimal persistent thread pool for the C plan API. The workers are started
+// when the pool is constructed, and each call to `run` hands out the task
+// indices [0, num_tasks) to the workers and the calling thread, blocking until
+// they are all done. Calls to `run` from different threads are serialized.
+class thread_pool {
+ public:
+  explicit thread_pool(std::size_t num_threads) {
+    try {
+      for (std::size_t i = 1; i < num_threads; ++i) {
+        workers_.emplace_back([this] { work(); });
+      }
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  ~thread_pool() { stop(); }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  std::size_t size() const { return workers_.size() + 1; }
+
+  void run(std::size_t num_tasks, const std::function<void(std::size_t)>& task) {
+    std::lock_guard<std::mutex> serial(run_mutex_);
+    if (workers_.empty() || num_tasks <= 1) {
+      for (std::size_t i = 0; i < num_tasks; ++i) task(i);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = &task;
+      num_tasks_ = num_tasks;
+      next_ = 0;
+      active_ = workers_.size();
+      ++generation_;
+    }
+    start_.notify_all();
+    drain();
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+  }
+
+ private:
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& worker : workers_) worker.join();
+  }
+
+  void drain() {
+    for (std::size_t i = next_++; i < num_tasks_; i = next_++) (*task_)(i);
+  }
+
+  void work() {
+    std::uint64_t generation = 0;
+    for (;;) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] { return stop_ || generation_ != generation; });
+      if (stop_) return;
+      generation = generation_;
+      lock.unlock();
+      drain();
+      lock.lock();
+      if (--active_ == 0) done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex run_mutex_, mutex_;
+  std::condition_variable start_, done_;
+  const std::function<void(std::size_t)>* task_ = nullptr;
+  std::size_t num_tasks_ = 0, active_ = 0;
+  std::atomic<std::size_t> next_{0};
+  std::uint64_t generation_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace detail
+}  // namespace kepler
+
+#endif
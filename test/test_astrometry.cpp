@@ -0,0 +1,68 @@
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/astrometry.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+TEMPLATE_PRODUCT_TEST_CASE("Astrometric offsets", "[astrometry][simd]", SolveTestCase,
+                           ((refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
+                            (refiners::brandt<double>, starters::raposo_pulido_brandt<double>),
+                            (refiners::non_iterative<3, double>, starters::markley<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const T abs_tol = tolerance<TestType>::abs;
+  const std::size_t num_orbits = 7, num_epochs = 103, size = num_orbits * num_epochs;
+  std::vector<T> eccentricity(num_orbits), A(num_orbits), B(num_orbits), F(num_orbits),
+      G(num_orbits), parallax(num_orbits), mean_anomaly(size), x(size), y(size), delta(size),
+      sin_scan_angle(num_epochs), cos_scan_angle(num_epochs);
+  for (std::size_t n = 0; n < num_orbits; ++n) {
+    eccentricity[n] = T(0.999) * n / T(num_orbits - 1);
+    A[n] = T(1.3) - T(0.1) * n;
+    B[n] = T(0.2) * n - T(0.4);
+    F[n] = T(0.7);
+    G[n] = T(0.9) - T(0.05) * n;
+    parallax[n] = T(0.1) * (n + 1);
+  }
+  for (std::size_t m = 0; m < num_epochs; ++m) {
+    sin_scan_angle[m] = std::sin(T(0.3) * m);
+    cos_scan_angle[m] = std::cos(T(0.3) * m);
+  }
+  for (std::size_t k = 0; k < size; ++k) {
+    mean_anomaly[k] = T(100.) * k / T(size - 1) - T(50.);
+  }
+
+  const astrometry::thiele_innes<T> elements{A.data(), B.data(), F.data(), G.data()};
+  astrometry::solve<T, starter_type, refiner_type>(num_orbits, eccentricity.data(), elements,
+                                                   num_epochs, mean_anomaly.data(), x.data(),
+                                                   y.data());
+  astrometry::solve_along_scan<T, starter_type, refiner_type>(
+      num_orbits, eccentricity.data(), elements, parallax.data(), num_epochs,
+      mean_anomaly.data(), sin_scan_angle.data(), cos_scan_angle.data(), delta.data());
+
+  std::vector<T> ecc_anom(num_epochs), sin_ecc_anom(num_epochs), cos_ecc_anom(num_epochs);
+  for (std::size_t n = 0; n < num_orbits; ++n) {
+    const T e = eccentricity[n];
+    solver::solve_simd<starter_type, refiner_type>(e, num_epochs, &mean_anomaly[n * num_epochs],
+                                                   ecc_anom.data(), sin_ecc_anom.data(),
+                                                   cos_ecc_anom.data());
+    for (std::size_t m = 0; m < num_epochs; ++m) {
+      const std::size_t k = n * num_epochs + m;
+      const T X = cos_ecc_anom[m] - e;
+      const T Y = std::sqrt(1 - e * e) * sin_ecc_anom[m];
+      const T expect_x = A[n] * X + F[n] * Y;
+      const T expect_y = B[n] * X + G[n] * Y;
+      REQUIRE_THAT(x[k], WithinAbs(expect_x, abs_tol));
+      REQUIRE_THAT(y[k], WithinAbs(expect_y, abs_tol));
+      REQUIRE_THAT(delta[k], WithinAbs(parallax[n] * (expect_x * sin_scan_angle[m] +
+                                                      expect_y * cos_scan_angle[m]),
+                                       abs_tol));
+    }
+  }
+}
@@ -0,0 +1,103 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+// KEPLER_BATCH is the path to the kepler-batch executable
+
+namespace {
+
+template <typename T>
+void write_file(const char* path, const std::vector<T>& data) {
+  std::FILE* file = std::fopen(path, "wb");
+  REQUIRE(file != nullptr);
+  REQUIRE(std::fwrite(data.data(), sizeof(T), data.size(), file) == data.size());
+  std::fclose(file);
+}
+
+template <typename T>
+std::vector<T> read_file(const char* path) {
+  std::FILE* file = std::fopen(path, "rb");
+  REQUIRE(file != nullptr);
+  std::vector<T> data;
+  T value;
+  while (std::fread(&value, sizeof(T), 1, file) == 1) data.push_back(value);
+  std::fclose(file);
+  return data;
+}
+
+int run_batch(const std::string& args) {
+  return std::system((std::string(KEPLER_BATCH) + " " + args).c_str());
+}
+
+}  // namespace
+
+TEMPLATE_TEST_CASE("Batch tool", "[batch]", float, double) {
+  using T = TestType;
+  const T abs_tol = default_abs<T>::value;
+  const char* input_path = "test_batch_input.bin";
+  const char* output_path = "test_batch_output.bin";
+  const std::string flags = sizeof(T) == sizeof(float) ? "--float " : "";
+  const std::string paths = std::string(input_path) + " " + output_path;
+
+  // Runs of records share an eccentricity, and are solved together by the
+  // tool, so make sure that they straddle the chunk boundaries
+  const T eccentricities[] = {T(0.), T(0.3), T(0.999), T(0.5), T(0.9)};
+  const std::size_t run_sizes[] = {1000, 1, 37, 2500, 13};
+  std::vector<T> records, expect;
+  for (std::size_t n = 0; n < 5; ++n) {
+    const std::size_t size = run_sizes[n];
+    std::vector<T> mean_anomaly(size), ecc_anom(size), sin_ecc_anom(size), cos_ecc_anom(size);
+    for (std::size_t m = 0; m < size; ++m) {
+      mean_anomaly[m] = T(100.) * m / T(size) - T(50.);
+      records.push_back(eccentricities[n]);
+      records.push_back(mean_anomaly[m]);
+    }
+    solver::solve_simd<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+        eccentricities[n], size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+        cos_ecc_anom.data());
+    for (std::size_t m = 0; m < size; ++m) {
+      expect.push_back(ecc_anom[m]);
+      expect.push_back(sin_ecc_anom[m]);
+      expect.push_back(cos_ecc_anom[m]);
+    }
+  }
+  write_file(input_path, records);
+
+  for (const char* chunk_size :
+       {"", "--chunk-size 1 ", "--chunk-size 7 ", "--chunk-size 1000 "}) {
+    REQUIRE(run_batch(flags + chunk_size + paths) == 0);
+    std::vector<T> output = read_file<T>(output_path);
+    REQUIRE(output.size() == expect.size());
+    for (std::size_t i = 0; i < expect.size(); ++i) {
+      REQUIRE_THAT(output[i], WithinAbs(expect[i], abs_tol));
+    }
+  }
+
+  // Timing only adds a report on stderr
+  REQUIRE(run_batch(flags + "--time " + paths) == 0);
+  REQUIRE(read_file<T>(output_path).size() == expect.size());
+
+  // An empty input gives an empty output
+  write_file(input_path, std::vector<T>());
+  REQUIRE(run_batch(flags + paths) == 0);
+  REQUIRE(read_file<T>(output_path).empty());
+
+  // Partial records, bad arguments and missing files are rejected
+  write_file(input_path, std::vector<T>(3, T(0.5)));
+  REQUIRE(run_batch(flags + paths) != 0);
+  REQUIRE(run_batch(flags + "--chunk-size 0 " + paths) != 0);
+  REQUIRE(run_batch(flags + input_path) != 0);
+  REQUIRE(run_batch(flags + "does_not_exist.bin " + output_path) != 0);
+
+  std::remove(input_path);
+  std::remove(output_path);
+}
@@ -0,0 +1,247 @@
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler.h"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+namespace {
+
+// The streaming handles for each precision, so that the tests can be shared
+template <typename T>
+struct c_solver;
+
+template <>
+struct c_solver<double> {
+  typedef kepler_solver handle;
+  static handle* create(double e) { return kepler_solver_create(e); }
+  static void reset(handle* s, double e) { kepler_solver_reset(s, e); }
+  static void push(handle* s, std::size_t size, const double* M, double* E, double* sinE,
+                   double* cosE) {
+    kepler_solver_push(s, size, M, E, sinE, cosE);
+  }
+  static kepler_solver_stats stats(const handle* s) {
+    kepler_solver_stats result;
+    kepler_solver_get_stats(s, &result);
+    return result;
+  }
+  static void destroy(handle* s) { kepler_solver_destroy(s); }
+};
+
+template <>
+struct c_solver<float> {
+  typedef kepler_solverf handle;
+  static handle* create(float e) { return kepler_solverf_create(e); }
+  static void reset(handle* s, float e) { kepler_solverf_reset(s, e); }
+  static void push(handle* s, std::size_t size, const float* M, float* E, float* sinE,
+                   float* cosE) {
+    kepler_solverf_push(s, size, M, E, sinE, cosE);
+  }
+  static kepler_solver_stats stats(const handle* s) {
+    kepler_solver_stats result;
+    kepler_solverf_get_stats(s, &result);
+    return result;
+  }
+  static void destroy(handle* s) { kepler_solverf_destroy(s); }
+};
+
+// The plan entry points for each precision
+template <typename T>
+struct c_plan;
+
+template <>
+struct c_plan<double> {
+  static constexpr kepler_precision precision = KEPLER_PRECISION_DOUBLE;
+  static constexpr kepler_precision other = KEPLER_PRECISION_FLOAT;
+  static kepler_status execute(const kepler_plan* plan, std::size_t size, const double* e,
+                               std::size_t batch_size, const double* M, double* E, double* sinE,
+                               double* cosE) {
+    return kepler_plan_execute(plan, size, e, batch_size, M, E, sinE, cosE);
+  }
+};
+
+template <>
+struct c_plan<float> {
+  static constexpr kepler_precision precision = KEPLER_PRECISION_FLOAT;
+  static constexpr kepler_precision other = KEPLER_PRECISION_DOUBLE;
+  static kepler_status execute(const kepler_plan* plan, std::size_t size, const float* e,
+                               std::size_t batch_size, const float* M, float* E, float* sinE,
+                               float* cosE) {
+    return kepler_plan_executef(plan, size, e, batch_size, M, E, sinE, cosE);
+  }
+};
+
+// Solve `num_ecc` batches with a plan, and compare them with solving each
+// batch directly with the given starter and refiner
+template <typename Starter, typename Refiner>
+void check_plan(kepler_starter starter, kepler_refiner refiner, int order,
+                std::size_t num_threads, std::size_t num_ecc, std::size_t batch_size) {
+  using T = typename Starter::value_type;
+  using api = c_plan<T>;
+  const T abs_tol = default_abs<T>::value;
+  const std::size_t size = num_ecc * batch_size;
+  std::vector<T> eccentricity(num_ecc), mean_anomaly(size), ecc_anom(size), sin_ecc_anom(size),
+      cos_ecc_anom(size), expect_ecc_anom(size), expect_sin_ecc_anom(size),
+      expect_cos_ecc_anom(size);
+  for (std::size_t n = 0; n < num_ecc; ++n) eccentricity[n] = T(0.95) * n / T(num_ecc);
+  for (std::size_t m = 0; m < size; ++m) {
+    mean_anomaly[m] = T(100.) * (m % batch_size) / T(batch_size) - T(50.);
+  }
+
+  kepler_plan* plan = kepler_plan_create(starter, refiner, order, api::precision, 0.,
+                                         num_threads);
+  REQUIRE(plan != nullptr);
+  REQUIRE(api::execute(plan, num_ecc, eccentricity.data(), batch_size, mean_anomaly.data(),
+                       ecc_anom.data(), sin_ecc_anom.data(),
+                       cos_ecc_anom.data()) == KEPLER_SUCCESS);
+  kepler_plan_destroy(plan);
+
+  for (std::size_t n = 0; n < num_ecc; ++n) {
+    const std::size_t offset = n * batch_size;
+    solver::solve_simd<Starter, Refiner>(eccentricity[n], batch_size, &mean_anomaly[offset],
+                                         &expect_ecc_anom[offset], &expect_sin_ecc_anom[offset],
+                                         &expect_cos_ecc_anom[offset]);
+  }
+  for (std::size_t m = 0; m < size; ++m) {
+    REQUIRE_THAT(ecc_anom[m], WithinAbs(expect_ecc_anom[m], abs_tol));
+    REQUIRE_THAT(sin_ecc_anom[m], WithinAbs(expect_sin_ecc_anom[m], abs_tol));
+    REQUIRE_THAT(cos_ecc_anom[m], WithinAbs(expect_cos_ecc_anom[m], abs_tol));
+  }
+}
+
+}  // namespace
+
+TEMPLATE_TEST_CASE("C streaming solver", "[c_api][stream]", float, double) {
+  using T = TestType;
+  using api = c_solver<T>;
+  const T abs_tol = default_abs<T>::value;
+  const std::size_t anom_size = 1003;
+
+  // Uneven chunks, including an empty one, so that most chunks end in a
+  // partial batch whatever the SIMD width of the library
+  const std::size_t chunk_sizes[] = {1, 7, 0, 64, 3, 100, 828};
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), ecc_anom_c(anom_size), sin_ecc_anom_c(anom_size),
+      cos_ecc_anom_c(anom_size);
+  for (std::size_t m = 0; m < anom_size; ++m) {
+    mean_anomaly[m] = T(100.) * m / T(anom_size - 1) - T(50.);
+  }
+
+  auto* solver = api::create(T(0.));
+  REQUIRE(solver != nullptr);
+  auto stats = api::stats(solver);
+  REQUIRE(stats.chunks == 0);
+  REQUIRE(stats.elements == 0);
+  REQUIRE(stats.batches == 0);
+
+  for (T eccentricity : {T(0.), T(1e-5), T(0.3), T(0.9), T(0.999)}) {
+    api::reset(solver, eccentricity);
+    REQUIRE(api::stats(solver).chunks == 0);
+    solver::solve_simd<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+        eccentricity, anom_size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+        cos_ecc_anom.data());
+
+    // The batch size depends on how the library was built, so each chunk is
+    // only checked to take between one batch per 16 elements and one per
+    // element, rounded up
+    std::size_t offset = 0, num_chunks = 0;
+    for (std::size_t chunk : chunk_sizes) {
+      const auto before = api::stats(solver);
+      api::push(solver, chunk, &mean_anomaly[offset], &ecc_anom_c[offset],
+                &sin_ecc_anom_c[offset], &cos_ecc_anom_c[offset]);
+      const auto after = api::stats(solver);
+      REQUIRE(after.batches - before.batches >= (chunk + 15) / 16);
+      REQUIRE(after.batches - before.batches <= chunk);
+      offset += chunk;
+      num_chunks += 1;
+    }
+    REQUIRE(offset == anom_size);
+    stats = api::stats(solver);
+    REQUIRE(stats.chunks == num_chunks);
+    REQUIRE(stats.elements == anom_size);
+
+    for (std::size_t m = 0; m < anom_size; ++m) {
+      REQUIRE_THAT(ecc_anom_c[m], WithinAbs(ecc_anom[m], abs_tol));
+      REQUIRE_THAT(sin_ecc_anom_c[m], WithinAbs(sin_ecc_anom[m], abs_tol));
+      REQUIRE_THAT(cos_ecc_anom_c[m], WithinAbs(cos_ecc_anom[m], abs_tol));
+    }
+  }
+
+  api::destroy(solver);
+}
+
+TEMPLATE_TEST_CASE("C plan", "[c_api][plan]", float, double) {
+  using T = TestType;
+
+  // A single thread, and more threads than batches, so that the batches are
+  // split into chunks, and fewer threads than batches
+  for (std::size_t num_threads : {1, 4}) {
+    check_plan<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+        KEPLER_STARTER_RAPOSO_PULIDO_BRANDT, KEPLER_REFINER_BRANDT, 0, num_threads, 2, 5003);
+    check_plan<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+        KEPLER_STARTER_RAPOSO_PULIDO_BRANDT, KEPLER_REFINER_BRANDT, 0, num_threads, 13, 101);
+    check_plan<starters::markley<T>, refiners::non_iterative<3, T>>(
+        KEPLER_STARTER_MARKLEY, KEPLER_REFINER_NON_ITERATIVE, 3, num_threads, 5, 1003);
+    check_plan<starters::basic<T>, refiners::iterative<3, T>>(
+        KEPLER_STARTER_BASIC, KEPLER_REFINER_ITERATIVE, 3, num_threads, 5, 1003);
+  }
+}
+
+TEMPLATE_TEST_CASE("C plan errors", "[c_api][plan]", float, double) {
+  using T = TestType;
+  using api = c_plan<T>;
+  const std::size_t size = 17;
+  const T eccentricity = T(0.5);
+  std::vector<T> mean_anomaly(size, T(1.)), ecc_anom(size), sin_ecc_anom(size),
+      cos_ecc_anom(size);
+
+  // Invalid configurations are rejected when the plan is created
+  const kepler_starter bad_starter = static_cast<kepler_starter>(99);
+  const kepler_refiner bad_refiner = static_cast<kepler_refiner>(99);
+  const kepler_precision bad_precision = static_cast<kepler_precision>(99);
+  REQUIRE(kepler_plan_create(bad_starter, KEPLER_REFINER_BRANDT, 0, api::precision, 0., 1) ==
+          nullptr);
+  REQUIRE(kepler_plan_create(KEPLER_STARTER_BASIC, bad_refiner, 0, api::precision, 0., 1) ==
+          nullptr);
+  REQUIRE(kepler_plan_create(KEPLER_STARTER_BASIC, KEPLER_REFINER_BRANDT, 0, bad_precision, 0.,
+                             1) == nullptr);
+  for (int order : {0, 4}) {
+    REQUIRE(kepler_plan_create(KEPLER_STARTER_BASIC, KEPLER_REFINER_ITERATIVE, order,
+                               api::precision, 0., 1) == nullptr);
+    REQUIRE(kepler_plan_create(KEPLER_STARTER_BASIC, KEPLER_REFINER_NON_ITERATIVE, order,
+                               api::precision, 0., 1) == nullptr);
+  }
+
+  // A plan can only be executed with its own precision
+  kepler_plan* other = kepler_plan_create(KEPLER_STARTER_RAPOSO_PULIDO_BRANDT,
+                                          KEPLER_REFINER_BRANDT, 0, api::other, 0., 1);
+  REQUIRE(other != nullptr);
+  REQUIRE(api::execute(other, 1, &eccentricity, size, mean_anomaly.data(), ecc_anom.data(),
+                       sin_ecc_anom.data(),
+                       cos_ecc_anom.data()) == KEPLER_ERROR_WRONG_PRECISION);
+  kepler_plan_destroy(other);
+
+  kepler_plan* plan = kepler_plan_create(KEPLER_STARTER_RAPOSO_PULIDO_BRANDT,
+                                         KEPLER_REFINER_BRANDT, 0, api::precision, 0., 1);
+  REQUIRE(plan != nullptr);
+  REQUIRE(api::execute(nullptr, 1, &eccentricity, size, mean_anomaly.data(), ecc_anom.data(),
+                       sin_ecc_anom.data(),
+                       cos_ecc_anom.data()) == KEPLER_ERROR_INVALID_ARGUMENT);
+  REQUIRE(api::execute(plan, 1, &eccentricity, size, mean_anomaly.data(), nullptr,
+                       sin_ecc_anom.data(),
+                       cos_ecc_anom.data()) == KEPLER_ERROR_INVALID_ARGUMENT);
+  REQUIRE(api::execute(plan, 1, nullptr, size, mean_anomaly.data(), ecc_anom.data(),
+                       sin_ecc_anom.data(),
+                       cos_ecc_anom.data()) == KEPLER_ERROR_INVALID_ARGUMENT);
+
+  // Empty inputs are never read
+  REQUIRE(api::execute(plan, 0, nullptr, size, nullptr, nullptr, nullptr, nullptr) ==
+          KEPLER_SUCCESS);
+  REQUIRE(api::execute(plan, 1, &eccentricity, size, mean_anomaly.data(), ecc_anom.data(),
+                       sin_ecc_anom.data(), cos_ecc_anom.data()) == KEPLER_SUCCESS);
+  kepler_plan_destroy(plan);
+}
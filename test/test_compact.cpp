@@ -0,0 +1,55 @@
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/compact.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+TEMPLATE_PRODUCT_TEST_CASE("Compacting solver", "[compact][simd]", SolveTestCase,
+                           ((refiners::iterative<3, float>, starters::basic<float>),
+                            (refiners::iterative<3, double>, starters::basic<double>),
+                            (refiners::iterative<3, float>, starters::markley<float>),
+                            (refiners::iterative<3, double>, starters::markley<double>),
+                            (refiners::iterative<3, double>,
+                             starters::raposo_pulido_brandt<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const T abs_tol = default_abs<T>::value;
+  const std::size_t ecc_size = 11;
+  const std::size_t anom_sizes[] = {1, 7, 1003};
+
+  // A zero tolerance never converges, so the capped refiner takes exactly the
+  // same steps in both solvers
+  const refiner_type refiners[] = {refiner_type(), refiner_type(3, T(0.))};
+
+  for (const auto anom_size : anom_sizes) {
+    std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+        cos_ecc_anom(anom_size), expect_ecc_anom(anom_size), expect_sin_ecc_anom(anom_size),
+        expect_cos_ecc_anom(anom_size);
+    for (std::size_t m = 0; m < anom_size; ++m) {
+      mean_anomaly[m] = T(100.) * m / T(anom_size) - T(50.);
+    }
+
+    for (const auto& refiner : refiners) {
+      for (std::size_t n = 0; n < ecc_size; ++n) {
+        const T eccentricity = T(0.999) * n / T(ecc_size - 1);
+        compact::solve<starter_type, refiner_type>(eccentricity, anom_size, mean_anomaly.data(),
+                                                   ecc_anom.data(), sin_ecc_anom.data(),
+                                                   cos_ecc_anom.data(), refiner);
+        solver::solve_simd<starter_type, refiner_type>(
+            eccentricity, anom_size, mean_anomaly.data(), expect_ecc_anom.data(),
+            expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data(), refiner);
+        for (std::size_t m = 0; m < anom_size; ++m) {
+          REQUIRE_THAT(ecc_anom[m], WithinAbs(expect_ecc_anom[m], abs_tol));
+          REQUIRE_THAT(sin_ecc_anom[m], WithinAbs(expect_sin_ecc_anom[m], abs_tol));
+          REQUIRE_THAT(cos_ecc_anom[m], WithinAbs(expect_cos_ecc_anom[m], abs_tol));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,77 @@
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/cordic.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+TEMPLATE_TEST_CASE("CORDIC solver", "[cordic][simd]", float, double) {
+  using T = TestType;
+  const T abs_tol = default_abs<T>::value;
+  const std::size_t ecc_size = 11;
+  const std::size_t anom_size = 1003;
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), ecc_anom_simd(anom_size), sin_ecc_anom_simd(anom_size),
+      cos_ecc_anom_simd(anom_size), expect_ecc_anom(anom_size), expect_sin_ecc_anom(anom_size),
+      expect_cos_ecc_anom(anom_size);
+  for (std::size_t m = 0; m < anom_size; ++m) {
+    mean_anomaly[m] = T(100.) * m / T(anom_size - 1) - T(50.);
+  }
+
+  for (std::size_t n = 0; n < ecc_size; ++n) {
+    const T eccentricity = T(0.999) * n / T(ecc_size - 1);
+
+    cordic::solve(eccentricity, anom_size, mean_anomaly.data(), ecc_anom.data(),
+                  sin_ecc_anom.data(), cos_ecc_anom.data());
+    cordic::solve_simd(eccentricity, anom_size, mean_anomaly.data(), ecc_anom_simd.data(),
+                       sin_ecc_anom_simd.data(), cos_ecc_anom_simd.data());
+    solver::solve_simd<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+        eccentricity, anom_size, mean_anomaly.data(), expect_ecc_anom.data(),
+        expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data());
+
+    for (std::size_t m = 0; m < anom_size; ++m) {
+      REQUIRE_THAT(ecc_anom_simd[m], WithinAbs(ecc_anom[m], abs_tol));
+      REQUIRE_THAT(sin_ecc_anom_simd[m], WithinAbs(sin_ecc_anom[m], abs_tol));
+      REQUIRE_THAT(cos_ecc_anom_simd[m], WithinAbs(cos_ecc_anom[m], abs_tol));
+
+      // Near e = 1 and M = 0, E itself is poorly conditioned, so compare the
+      // residual there instead
+      const T residual = ecc_anom[m] - eccentricity * sin_ecc_anom[m] - mean_anomaly[m];
+      REQUIRE_THAT(std::remainder(residual, constants::twopi<T>()), WithinAbs(T(0), abs_tol));
+      REQUIRE_THAT(sin_ecc_anom[m], WithinAbs(expect_sin_ecc_anom[m], T(10) * abs_tol));
+      REQUIRE_THAT(cos_ecc_anom[m], WithinAbs(expect_cos_ecc_anom[m], T(10) * abs_tol));
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("CORDIC iterations", "[cordic]", float, double) {
+  using T = TestType;
+  const std::size_t anom_size = 1003;
+  const T eccentricity = T(0.3);
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), expect_ecc_anom(anom_size), expect_sin_ecc_anom(anom_size),
+      expect_cos_ecc_anom(anom_size);
+  for (std::size_t m = 0; m < anom_size; ++m) {
+    mean_anomaly[m] = constants::pi<T>() * m / T(anom_size);
+  }
+
+  // With fewer iterations, the error is bounded by the last rotation angle
+  constexpr int num_iterations = 12;
+  cordic::solve<T, num_iterations>(eccentricity, anom_size, mean_anomaly.data(), ecc_anom.data(),
+                                   sin_ecc_anom.data(), cos_ecc_anom.data());
+  solver::solve<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+      eccentricity, anom_size, mean_anomaly.data(), expect_ecc_anom.data(),
+      expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data());
+  const T bound = std::ldexp(constants::pi<T>(), -(num_iterations + 1)) + default_abs<T>::value;
+  for (std::size_t m = 0; m < anom_size; ++m) {
+    REQUIRE_THAT(ecc_anom[m], WithinAbs(expect_ecc_anom[m], bound));
+    REQUIRE_THAT(sin_ecc_anom[m], WithinAbs(std::sin(ecc_anom[m]), default_abs<T>::value));
+    REQUIRE_THAT(cos_ecc_anom[m], WithinAbs(std::cos(ecc_anom[m]), default_abs<T>::value));
+  }
+}
@@ -0,0 +1,103 @@
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/double_double.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+namespace {
+
+using dd_type = dd::value<double>;
+
+double to_double(const dd_type& x) { return x.hi + x.lo; }
+
+}  // namespace
+
+TEST_CASE("Double-double arithmetic", "[double_double]") {
+  const double abs_tol = 1e-31;
+  const dd_type third = dd_type(1.) / dd_type(3.);
+  REQUIRE(third.lo != 0.);
+  REQUIRE_THAT(to_double(third * dd_type(3.) - dd_type(1.)), WithinAbs(0., abs_tol));
+  REQUIRE_THAT(to_double((third + third + third) - dd_type(1.)), WithinAbs(0., abs_tol));
+
+  const dd_type x = dd_type(2.) / dd_type(7.);
+  REQUIRE_THAT(to_double((x * x) / x - x), WithinAbs(0., abs_tol));
+  REQUIRE_THAT(to_double(x * 7. - dd_type(2.)), WithinAbs(0., abs_tol));
+}
+
+TEST_CASE("Double-double sincos", "[double_double]") {
+  const double abs_tol = 1e-31;
+  const std::size_t size = 1003;
+  for (std::size_t n = 0; n < size; ++n) {
+    const dd_type x = dd_type(constants::pi<double>() * n) / dd_type(double(size - 1));
+    dd_type s, c, s2, c2;
+    dd::sincos(x, s, c);
+    REQUIRE_THAT(s.hi, WithinAbs(std::sin(x.hi), 1e-15));
+    REQUIRE_THAT(c.hi, WithinAbs(std::cos(x.hi), 1e-15));
+    REQUIRE_THAT(to_double(s * s + c * c - dd_type(1.)), WithinAbs(0., abs_tol));
+
+    // The double angle formulas test the low parts
+    dd::sincos(x * 0.5, s2, c2);
+    REQUIRE_THAT(to_double(s2 * c2 * 2. - s), WithinAbs(0., abs_tol));
+    REQUIRE_THAT(to_double(c2 * c2 - s2 * s2 - c), WithinAbs(0., abs_tol));
+  }
+}
+
+TEST_CASE("Double-double solver", "[double_double][simd]") {
+  const std::size_t size = 1003;
+  std::vector<double> mean_anomaly_hi(size), mean_anomaly_lo(size), ecc_anom_hi(size),
+      ecc_anom_lo(size), sin_hi(size), sin_lo(size), cos_hi(size), cos_lo(size),
+      ecc_anom_simd_hi(size), ecc_anom_simd_lo(size), sin_simd_hi(size), sin_simd_lo(size),
+      cos_simd_hi(size), cos_simd_lo(size), ecc_anom(size), sin_ecc_anom(size),
+      cos_ecc_anom(size);
+  for (std::size_t m = 0; m < size; ++m) {
+    const dd_type mean_anom = dd_type(100. * m - 50. * (size - 1)) / dd_type(double(size - 1));
+    mean_anomaly_hi[m] = mean_anom.hi;
+    mean_anomaly_lo[m] = mean_anom.lo;
+  }
+  const dd::const_array mean_anomaly{mean_anomaly_hi.data(), mean_anomaly_lo.data()};
+
+  const double eccentricities[] = {0., 1e-6, 0.1, 0.5, 0.9, 0.99, 0.999999};
+  for (double eccentricity : eccentricities) {
+    dd::solve(eccentricity, size, mean_anomaly, {ecc_anom_hi.data(), ecc_anom_lo.data()},
+              {sin_hi.data(), sin_lo.data()}, {cos_hi.data(), cos_lo.data()});
+    dd::solve_simd(eccentricity, size, mean_anomaly,
+                   {ecc_anom_simd_hi.data(), ecc_anom_simd_lo.data()},
+                   {sin_simd_hi.data(), sin_simd_lo.data()},
+                   {cos_simd_hi.data(), cos_simd_lo.data()});
+    solver::solve_simd<starters::raposo_pulido_brandt<double>, refiners::brandt<double>>(
+        eccentricity, size, mean_anomaly_hi.data(), ecc_anom.data(), sin_ecc_anom.data(),
+        cos_ecc_anom.data());
+
+    for (std::size_t m = 0; m < size; ++m) {
+      const dd_type M(mean_anomaly_hi[m], mean_anomaly_lo[m]);
+      const dd_type E(ecc_anom_hi[m], ecc_anom_lo[m]);
+      const dd_type s(sin_hi[m], sin_lo[m]), c(cos_hi[m], cos_lo[m]);
+
+      // The residual is computed in double-double, up to multiples of 2 pi
+      dd_type residual, reduced_ecc_anom, expect_sin, expect_cos;
+      dd::range_reduce(E - s * eccentricity - M, residual);
+      REQUIRE_THAT(to_double(residual), WithinAbs(0., 1e-30));
+
+      const bool reflected = dd::range_reduce(E, reduced_ecc_anom);
+      dd::sincos(reduced_ecc_anom, expect_sin, expect_cos);
+      REQUIRE_THAT(to_double(s - (reflected ? -expect_sin : expect_sin)), WithinAbs(0., 1e-30));
+      REQUIRE_THAT(to_double(c - expect_cos), WithinAbs(0., 1e-30));
+
+      REQUIRE_THAT(ecc_anom_hi[m], WithinAbs(ecc_anom[m], 1e-13));
+      REQUIRE_THAT(sin_hi[m], WithinAbs(sin_ecc_anom[m], 1e-13));
+      REQUIRE_THAT(cos_hi[m], WithinAbs(cos_ecc_anom[m], 1e-13));
+
+      const dd_type E_simd(ecc_anom_simd_hi[m], ecc_anom_simd_lo[m]);
+      const dd_type s_simd(sin_simd_hi[m], sin_simd_lo[m]), c_simd(cos_simd_hi[m], cos_simd_lo[m]);
+      REQUIRE_THAT(to_double(E_simd - E), WithinAbs(0., 1e-30));
+      REQUIRE_THAT(to_double(s_simd - s), WithinAbs(0., 1e-30));
+      REQUIRE_THAT(to_double(c_simd - c), WithinAbs(0., 1e-30));
+    }
+  }
+}
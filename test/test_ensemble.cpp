@@ -0,0 +1,80 @@
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/ensemble.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+TEMPLATE_PRODUCT_TEST_CASE("Ensemble solver", "[ensemble][simd]", SolveTestCase,
+                           ((refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
+                            (refiners::brandt<double>, starters::raposo_pulido_brandt<double>),
+                            (refiners::non_iterative<3, double>, starters::mikkola<double>),
+                            (refiners::non_iterative<3, float>, starters::markley<float>),
+                            (refiners::non_iterative<3, double>, starters::markley<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const T abs_tol = tolerance<TestType>::abs;
+
+  // Exercise both the vectorization over times and, for the Markley starter, over
+  // samples; the first sample has e = 0, so it takes the low eccentricity series
+  const std::size_t shapes[][2] = {{5, 1003}, {1003, 5}, {37, 600}, {600, 37}};
+  for (const auto& shape : shapes) {
+    const std::size_t num_samples = shape[0], num_times = shape[1];
+    const std::size_t size = num_samples * num_times;
+    std::vector<T> period(num_samples), time_of_periastron(num_samples),
+        eccentricity(num_samples), time(num_times), ecc_anom(size), sin_ecc_anom(size),
+        cos_ecc_anom(size), mean_anomaly(num_times), expect_ecc_anom(num_times),
+        expect_sin_ecc_anom(num_times), expect_cos_ecc_anom(num_times);
+    for (std::size_t n = 0; n < num_samples; ++n) {
+      period[n] = T(1.5) + T(0.37) * n;
+      time_of_periastron[n] = T(0.1) * n - T(2.);
+      eccentricity[n] = T(0.999) * n / T(num_samples);
+    }
+    for (std::size_t j = 0; j < num_times; ++j) {
+      time[j] = T(20.) * j / T(num_times) - T(7.);
+    }
+    const ensemble::samples<T> params{period.data(), time_of_periastron.data(),
+                                      eccentricity.data()};
+
+    ensemble::solve<T, starter_type, refiner_type>(num_samples, params, num_times, time.data(),
+                                                   ecc_anom.data(), sin_ecc_anom.data(),
+                                                   cos_ecc_anom.data());
+
+    for (std::size_t n = 0; n < num_samples; ++n) {
+      for (std::size_t j = 0; j < num_times; ++j) {
+        mean_anomaly[j] = constants::twopi<T>() / period[n] * (time[j] - time_of_periastron[n]);
+      }
+      solver::solve_simd<starter_type, refiner_type>(
+          eccentricity[n], num_times, mean_anomaly.data(), expect_ecc_anom.data(),
+          expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data());
+      for (std::size_t j = 0; j < num_times; ++j) {
+        const std::size_t k = n * num_times + j;
+        REQUIRE_THAT(ecc_anom[k], WithinAbs(expect_ecc_anom[j], abs_tol));
+        REQUIRE_THAT(sin_ecc_anom[k], WithinAbs(expect_sin_ecc_anom[j], abs_tol));
+        REQUIRE_THAT(cos_ecc_anom[k], WithinAbs(expect_cos_ecc_anom[j], abs_tol));
+      }
+    }
+
+    // The reduction sees every element exactly once, with the same values
+    std::vector<int> seen(size, 0);
+    ensemble::reduce<T, starter_type, refiner_type>(
+        num_samples, params, num_times, time.data(),
+        [&](std::size_t n, std::size_t j0, std::size_t count, const T* E, const T* s,
+            const T* c) {
+          for (std::size_t j = 0; j < count; ++j) {
+            const std::size_t k = n * num_times + j0 + j;
+            seen[k] += 1;
+            REQUIRE(E[j] == ecc_anom[k]);
+            REQUIRE(s[j] == sin_ecc_anom[k]);
+            REQUIRE(c[j] == cos_ecc_anom[k]);
+          }
+        });
+    for (std::size_t k = 0; k < size; ++k) REQUIRE(seen[k] == 1);
+  }
+}
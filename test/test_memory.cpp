@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/memory.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+TEMPLATE_TEST_CASE("Large batch solver", "[memory][simd]", float, double) {
+  using T = TestType;
+  using starter_type = starters::raposo_pulido_brandt<T>;
+  using refiner_type = refiners::brandt<T>;
+  const std::size_t max_size = 1003, padding = 8;
+  const std::size_t sizes[] = {1, 7, 10, 37, max_size};
+  const T eccentricities[] = {T(0.), T(0.5), T(0.9)};
+
+  std::vector<T> mean_anomaly(max_size + padding), expect_ecc_anom(max_size),
+      expect_sin_ecc_anom(max_size), expect_cos_ecc_anom(max_size);
+  std::vector<T, memory::huge_page_allocator<T>> ecc_anom(max_size + padding),
+      sin_ecc_anom(max_size + padding), cos_ecc_anom(max_size + padding);
+  for (std::size_t m = 0; m < mean_anomaly.size(); ++m) {
+    mean_anomaly[m] = T(100.) * m / T(mean_anomaly.size()) - T(50.);
+  }
+
+  // Offsets where the outputs share an alignment, and where they don't, in
+  // which case ordinary stores are used. Either way, every element is solved
+  // by the same kernel as in the default mode, so the results are identical.
+  const std::size_t offsets[][4] = {{0, 0, 0, 0}, {1, 3, 3, 3}, {0, 1, 2, 3}};
+
+  for (const auto size : sizes) {
+    for (const auto eccentricity : eccentricities) {
+      for (const auto& offset : offsets) {
+        solver::solve_simd<starter_type, refiner_type>(
+            eccentricity, size, mean_anomaly.data() + offset[0], expect_ecc_anom.data(),
+            expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data());
+        solver::solve_simd<starter_type, refiner_type, memory::streaming_mode>(
+            eccentricity, size, mean_anomaly.data() + offset[0], ecc_anom.data() + offset[1],
+            sin_ecc_anom.data() + offset[2], cos_ecc_anom.data() + offset[3]);
+
+        for (std::size_t m = 0; m < size; ++m) {
+          REQUIRE(ecc_anom[m + offset[1]] == expect_ecc_anom[m]);
+          REQUIRE(sin_ecc_anom[m + offset[2]] == expect_sin_ecc_anom[m]);
+          REQUIRE(cos_ecc_anom[m + offset[3]] == expect_cos_ecc_anom[m]);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Large batch threshold", "[memory]") {
+  const std::size_t threshold = memory::large_batch_threshold();
+  REQUIRE(threshold > 0);
+  REQUIRE(!memory::is_large_batch(threshold));
+  REQUIRE(memory::is_large_batch(threshold + 1));
+  memory::set_large_batch_threshold(0);
+  REQUIRE(memory::is_large_batch(1));
+  memory::set_large_batch_threshold(threshold);
+}
+
+TEST_CASE("Huge page allocator", "[memory]") {
+  // Large enough to be backed by huge pages where they are available
+  const std::size_t size = 3 * memory::huge_page_size / sizeof(double) + 5;
+  std::vector<double, memory::huge_page_allocator<double>> data(size, 1.);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(data.data()) % 64 == 0);
+  for (std::size_t n = 0; n < size; ++n) data[n] = double(n);
+  double sum = 0.;
+  for (const auto value : data) sum += value;
+  REQUIRE(sum == 0.5 * double(size) * double(size - 1));
+
+  std::vector<float, memory::huge_page_allocator<float>> small(17, 2.f);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(small.data()) % 64 == 0);
+  REQUIRE(small[16] == 2.f);
+}
@@ -0,0 +1,41 @@
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/partition.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+
+using namespace kepler;
+
+TEMPLATE_TEST_CASE("Regime-partitioned solver", "[partition][simd]", float, double) {
+  using T = TestType;
+  const T abs_tol = default_abs<T>::value;
+  const T eccentricities[] = {T(0.), T(0.5), T(0.78), T(0.9), T(0.99), T(0.999)};
+  const std::size_t anom_size = 1003;
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), expect_ecc_anom(anom_size), expect_sin_ecc_anom(anom_size),
+      expect_cos_ecc_anom(anom_size);
+
+  // Sample the full range, and densely near M = 0 where the regimes change
+  for (int dense = 0; dense < 2; ++dense) {
+    const T range = dense ? T(1.) : T(50.);
+    for (std::size_t m = 0; m < anom_size; ++m) {
+      mean_anomaly[m] = T(2.) * range * m / T(anom_size - 1) - range;
+    }
+
+    for (const auto eccentricity : eccentricities) {
+      partition::solve(eccentricity, anom_size, mean_anomaly.data(), ecc_anom.data(),
+                       sin_ecc_anom.data(), cos_ecc_anom.data());
+      solver::solve<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+          eccentricity, anom_size, mean_anomaly.data(), expect_ecc_anom.data(),
+          expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data());
+      for (std::size_t m = 0; m < anom_size; ++m) {
+        REQUIRE_THAT(ecc_anom[m], WithinAbs(expect_ecc_anom[m], abs_tol));
+        REQUIRE_THAT(sin_ecc_anom[m], WithinAbs(expect_sin_ecc_anom[m], abs_tol));
+        REQUIRE_THAT(cos_ecc_anom[m], WithinAbs(expect_cos_ecc_anom[m], abs_tol));
+      }
+    }
+  }
+}
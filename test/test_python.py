@@ -0,0 +1,149 @@
+import threading
+
+import numpy as np
+import pytest
+
+import kepler
+
+
+def tolerance(dtype):
+    return 1e-12 if np.dtype(dtype) == np.float64 else 5e-5
+
+
+def check_solution(mean_anomaly, eccentricity, E, sinE=None, cosE=None):
+    tol = tolerance(mean_anomaly.dtype)
+    M = mean_anomaly.astype(np.float64)
+    E = E.astype(np.float64)
+    residual = np.remainder(E - eccentricity * np.sin(E) - M + np.pi, 2 * np.pi) - np.pi
+    np.testing.assert_allclose(residual, 0.0, atol=tol)
+    if sinE is not None:
+        np.testing.assert_allclose(sinE, np.sin(E), atol=tol)
+    if cosE is not None:
+        np.testing.assert_allclose(cosE, np.cos(E), atol=tol)
+
+
+@pytest.mark.parametrize("dtype", [np.float64, np.float32])
+@pytest.mark.parametrize("eccentricity", [0.0, 0.3, 0.9, 0.999])
+def test_solve(dtype, eccentricity):
+    M = np.linspace(-10, 10, 1003, dtype=dtype)
+    E = kepler.solve(M, eccentricity)
+    assert E.dtype == dtype
+    assert E.shape == M.shape
+    check_solution(M, eccentricity, E)
+
+
+@pytest.mark.parametrize("dtype", [np.float64, np.float32])
+def test_outputs_are_not_copied(dtype):
+    M = np.linspace(-10, 10, 1003, dtype=dtype).reshape(17, 59)
+    E = np.empty_like(M)
+    sinE = np.empty_like(M)
+    cosE = np.empty_like(M)
+    result = kepler.solve(
+        M, 0.5, eccentric_anomaly=E, sin_eccentric_anomaly=sinE, cos_eccentric_anomaly=cosE
+    )
+    assert np.shares_memory(result, E)
+    check_solution(M, 0.5, E, sinE, cosE)
+
+
+@pytest.mark.parametrize("dtype", [np.float64, np.float32])
+def test_strided(dtype):
+    # Longer than a chunk, so that the strided path is processed in pieces
+    M = np.linspace(-10, 10, 2 * 10007, dtype=dtype)
+    E = np.full(3 * 10007, np.nan, dtype=dtype)
+    sinE = np.empty_like(E)
+    cosE = np.empty_like(E)
+    result = kepler.solve(
+        M[::2],
+        0.7,
+        eccentric_anomaly=E[::3],
+        sin_eccentric_anomaly=sinE[::3],
+        cos_eccentric_anomaly=cosE[::3],
+    )
+    assert np.shares_memory(result, E)
+    expect = kepler.solve(np.ascontiguousarray(M[::2]), 0.7)
+    np.testing.assert_allclose(E[::3], expect, rtol=0, atol=tolerance(dtype))
+    assert np.all(np.isnan(E[1::3]))
+    check_solution(M[::2], 0.7, E[::3], sinE[::3], cosE[::3])
+
+
+def test_dtype_checks():
+    M = np.linspace(-10, 10, 100)
+    with pytest.raises(TypeError):
+        kepler.solve(M.astype(np.int64), 0.5)
+    with pytest.raises(TypeError):
+        kepler.solve(M, 0.5, eccentric_anomaly=np.empty(100, dtype=np.float32))
+    with pytest.raises(TypeError):
+        kepler.solve(M, 0.5, eccentric_anomaly=list(range(100)))
+
+
+def test_shape_checks():
+    M = np.linspace(-10, 10, 100)
+    with pytest.raises(ValueError):
+        kepler.solve(M, 0.5, eccentric_anomaly=np.empty(99))
+    with pytest.raises(ValueError):
+        E = np.empty((10, 10))[:, ::2]
+        kepler.solve(M.reshape(10, 10)[:, ::2].copy(), 0.5, eccentric_anomaly=E)
+    with pytest.raises(ValueError):
+        kepler.solve(M.reshape(10, 10)[:, ::2], 0.5)
+
+
+def test_gil_is_released():
+    M = np.linspace(-10, 10, 2_000_000)
+    started = threading.Event()
+
+    def worker():
+        started.set()
+        kepler.solve(M, 0.5)
+
+    thread = threading.Thread(target=worker)
+    thread.start()
+    started.wait()
+    count = 0
+    while thread.is_alive():
+        count += 1
+    thread.join()
+
+    # If the GIL were held, this thread would only run before and after the
+    # solve, for a handful of iterations
+    assert count > 1000
+
+
+@pytest.mark.parametrize("dtype", ["float64", "float32"])
+@pytest.mark.parametrize("num_threads", [1, 4])
+def test_plan(dtype, num_threads):
+    plan = kepler.Plan(dtype=dtype, num_threads=num_threads)
+    M = np.linspace(-10, 10, 1003, dtype=dtype)
+    E = plan.solve(M, 0.5)
+    assert E.dtype == np.dtype(dtype)
+    np.testing.assert_allclose(E, kepler.solve(M, 0.5), rtol=0, atol=tolerance(dtype))
+    check_solution(M, 0.5, E)
+
+
+@pytest.mark.parametrize(
+    "starter, refiner, order",
+    [
+        ("basic", "iterative", 3),
+        ("markley", "non_iterative", 3),
+        ("contour", "noop", 0),
+    ],
+)
+def test_plan_algorithms(starter, refiner, order):
+    plan = kepler.Plan(starter=starter, refiner=refiner, order=order)
+    M = np.linspace(-10, 10, 1003)
+    E = plan.solve(M, 0.5)
+    check_solution(M, 0.5, E)
+
+
+def test_plan_errors():
+    with pytest.raises(ValueError, match="unknown starter"):
+        kepler.Plan(starter="bogus")
+    with pytest.raises(ValueError, match="unknown refiner"):
+        kepler.Plan(refiner="bogus")
+    with pytest.raises(ValueError, match="dtype"):
+        kepler.Plan(dtype="float16")
+    with pytest.raises(ValueError, match="invalid plan configuration"):
+        kepler.Plan(refiner="iterative", order=4)
+
+    plan = kepler.Plan(dtype="float32")
+    with pytest.raises(TypeError, match="doesn't match the plan"):
+        plan.solve(np.linspace(-10, 10, 100), 0.5)
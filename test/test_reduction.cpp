@@ -1,3 +1,7 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
 #include "./test_utils.hpp"
 #include "kepler/kepler/constants.hpp"
 #include "kepler/kepler/reduction.hpp"
@@ -42,6 +46,129 @@ TEST_CASE("Range reduction (SIMD)", "[reduction][simd]") {
   REQUIRE_THAT(xr.get(0), WithinAbs(1e-8, abs_tol));
 }
 
+TEST_CASE("Large argument reduction", "[reduction]") {
+  const double abs_tol = 1e-15;
+  for (int exponent = 21; exponent < 1024; exponent += 7) {
+    for (double mantissa : {1.0, 1.2345678901234567, 1.5, 1.9999999999999998}) {
+      double x = std::ldexp(mantissa, exponent);
+      double expect[2];
+      std::int32_t n = xsimd::detail::__ieee754_rem_pio2(x, expect);
+      double xr;
+      REQUIRE(reduction::detail::payne_hanek(x, xr) == double(n & 3));
+      REQUIRE_THAT(xr, WithinAbs(expect[0], abs_tol));
+    }
+  }
+
+  // A notoriously close approach of a double to a multiple of pi/2
+  double x = std::ldexp(6381956970095103.0, 797);
+  double expect[2];
+  xsimd::detail::__ieee754_rem_pio2(x, expect);
+  double xr;
+  reduction::detail::payne_hanek(x, xr);
+  REQUIRE_THAT(xr, WithinRel(expect[0], 1e-15));
+
+  reduction::detail::trig_reduce(std::numeric_limits<double>::infinity(), xr);
+  REQUIRE(std::isnan(xr));
+}
+
+TEST_CASE("Large argument reduction (SIMD)", "[reduction][simd]") {
+  typedef double T;
+  using B = xs::batch<T>;
+  constexpr std::size_t size = B::size;
+  const T abs_tol = 1e-15;
+
+  // Mix large and small lanes, so that both reductions are exercised. The
+  // mantissas stay below 2 so that every lane is finite.
+  for (int exponent = 21; exponent < 1024; exponent += 11) {
+    alignas(B::arch_type::alignment()) T x[size];
+    for (std::size_t i = 0; i < size; ++i) {
+      x[i] = (i % 2) ? std::ldexp(1.2345678901234567 + T(i) / T(size), exponent) : T(0.1) + T(i);
+    }
+    B xr;
+    auto high = reduction::range_reduce(B::load_aligned(x), xr);
+    for (std::size_t i = 0; i < size; ++i) {
+      T expect;
+      REQUIRE(high.get(i) == reduction::range_reduce(x[i], expect));
+      REQUIRE_THAT(xr.get(i), WithinAbs(expect, abs_tol));
+    }
+  }
+}
+
+// The float reduction is checked against the double reduction of the same
+// argument, which is exact to well beyond float precision
+TEST_CASE("Large argument reduction (float)", "[reduction]") {
+  const float abs_tol = 1e-7f;
+  for (int exponent = 7; exponent < 128; exponent += 3) {
+    for (float mantissa : {1.0f, 1.2345678f, 1.5f, 1.9999999f}) {
+      float x = std::ldexp(mantissa, exponent), xr;
+      double expect;
+      double n = reduction::detail::trig_reduce(double(x), expect);
+      REQUIRE(reduction::detail::trig_reduce(x, xr) == float(n));
+      REQUIRE_THAT(xr, WithinAbs(float(expect), abs_tol));
+    }
+  }
+
+  float xr;
+  reduction::detail::trig_reduce(std::numeric_limits<float>::infinity(), xr);
+  REQUIRE(std::isnan(xr));
+}
+
+TEST_CASE("Large argument reduction (float SIMD)", "[reduction][simd]") {
+  typedef float T;
+  using B = xs::batch<T>;
+  constexpr std::size_t size = B::size;
+  const T abs_tol = 1e-7f;
+
+  // Mix large and small lanes, so that both reductions are exercised
+  for (int exponent = 7; exponent < 128; exponent += 5) {
+    alignas(B::arch_type::alignment()) T x[size];
+    for (std::size_t i = 0; i < size; ++i) {
+      x[i] = (i % 2) ? std::ldexp(T(1.) + T(i) / T(size), exponent) : T(0.1) + T(i);
+    }
+    B xr;
+    auto n = reduction::detail::trig_reduce(B::load_aligned(x), xr);
+    for (std::size_t i = 0; i < size; ++i) {
+      double expect;
+      double expect_n = reduction::detail::trig_reduce(double(x[i]), expect);
+      REQUIRE(n.get(i) == T(expect_n));
+      REQUIRE_THAT(xr.get(i), WithinAbs(T(expect), abs_tol));
+    }
+  }
+}
+
+template <typename T, typename U>
+void check_phase_reduce() {
+  using B = xs::batch<T>;
+  constexpr std::size_t size = B::size;
+  constexpr U half = U(1) << (std::numeric_limits<U>::digits - 1);
+  const U edges[] = {U(0), U(1), U(half - 1), half, U(half + 1), U(U(0) - 2), U(U(0) - 1)};
+  const std::size_t num_edges = sizeof(edges) / sizeof(edges[0]);
+
+  // The batch reduction must match the scalar one exactly, whether or not
+  // the phase is as wide as T
+  U phase[size + num_edges];
+  for (std::size_t i = 0; i < num_edges; ++i) phase[i] = edges[i];
+  for (std::size_t i = num_edges; i < size + num_edges; ++i) {
+    phase[i] = U(i * (std::numeric_limits<U>::max() / U(size + num_edges)));
+  }
+  for (std::size_t offset = 0; offset < num_edges; ++offset) {
+    B xr;
+    auto high = reduction::phase_reduce(static_cast<const U*>(phase) + offset, xr);
+    for (std::size_t i = 0; i < size; ++i) {
+      T expect;
+      REQUIRE(high.get(i) == reduction::phase_reduce(phase[offset + i], expect));
+      REQUIRE(xr.get(i) == expect);
+    }
+  }
+}
+
+TEST_CASE("Fixed-point phase reduction (SIMD)", "[reduction][simd]") {
+  check_phase_reduce<float, std::uint32_t>();
+  check_phase_reduce<float, std::uint64_t>();
+  check_phase_reduce<double, std::uint32_t>();
+  check_phase_reduce<double, std::uint64_t>();
+}
+
 // https://stackoverflow.com/questions/42792939/implementation-of-sinpi-and-cospi-using-standard-c-math-library/42792940#42792940
 template <typename T>
 struct int_type {};
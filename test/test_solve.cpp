@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
 #include <vector>
 
 #include "./test_utils.hpp"
@@ -6,6 +10,7 @@
 #include "kepler/kepler/refiners.hpp"
 #include "kepler/kepler/solver.hpp"
 #include "kepler/kepler/starters.hpp"
+#include "reference/radvel.hpp"
 
 using namespace kepler;
 
@@ -17,6 +22,8 @@ TEMPLATE_PRODUCT_TEST_CASE("SIMD comparison", "[refiners][simd]", SolveTestCase,
                             (refiners::iterative<7, double>),
                             (refiners::non_iterative<3, double>, starters::markley<double>),
                             (refiners::non_iterative<3, float>, starters::markley<float>),
+                            (refiners::noop<double>, starters::contour16<double>),
+                            (refiners::noop<float>, starters::contour16<float>),
                             (refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
                             (refiners::brandt<double>, starters::raposo_pulido_brandt<double>))) {
   using T = typename TestType::value_type;
@@ -31,9 +38,12 @@ TEMPLATE_PRODUCT_TEST_CASE("SIMD comparison", "[refiners][simd]", SolveTestCase,
     mean_anomaly[m] = T(100.) * m / T(anom_size - 1) - T(50.);
   }
 
-  for (size_t n = 0; n < ecc_size; ++n) {
-    const T eccentricity = n / T(ecc_size);
+  // Including small eccentricities just above the low eccentricity threshold,
+  // where the starters handle the limit e -> 0 themselves
+  std::vector<T> eccentricities = {T(1e-3), T(1.1e-3), T(1.2e-3)};
+  for (size_t n = 0; n < ecc_size; ++n) eccentricities.push_back(n / T(ecc_size));
 
+  for (auto eccentricity : eccentricities) {
     solver::solve<typename TestType::starter_type, typename TestType::refiner_type>(
         eccentricity, anom_size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
         cos_ecc_anom.data(), refiner);
@@ -48,3 +58,210 @@ TEMPLATE_PRODUCT_TEST_CASE("SIMD comparison", "[refiners][simd]", SolveTestCase,
     }
   }
 }
+
+TEMPLATE_PRODUCT_TEST_CASE("Low eccentricity", "[solve][simd]", SolveTestCase,
+                           ((refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
+                            (refiners::brandt<double>, starters::raposo_pulido_brandt<double>),
+                            (refiners::iterative<3, double>, starters::markley<double>))) {
+  using T = typename TestType::value_type;
+  const T abs_tol = tolerance<TestType>::abs;
+  const size_t anom_size = 1003;
+
+  // Up to just below the threshold for the series, which depends on precision
+  const T low = constants::low_eccentricity<T>();
+  const std::vector<T> eccentricities = {T(0.), T(1e-10), T(1e-7), T(1e-5), T(0.5) * low,
+                                         T(0.99) * low};
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size);
+  for (size_t m = 0; m < anom_size; ++m) {
+    mean_anomaly[m] = T(100.) * m / T(anom_size - 1) - T(50.);
+  }
+
+  reference::radvel reference(100, 1e-15);
+  for (auto eccentricity : eccentricities) {
+    solver::solve_simd<typename TestType::starter_type, typename TestType::refiner_type>(
+        eccentricity, anom_size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+        cos_ecc_anom.data());
+
+    reference.setup(eccentricity);
+    for (size_t m = 0; m < anom_size; ++m) {
+      auto expect = reference.solve(mean_anomaly[m]);
+      REQUIRE_THAT(std::sin(ecc_anom[m]), WithinAbs(std::sin(expect), abs_tol));
+      REQUIRE_THAT(std::cos(ecc_anom[m]), WithinAbs(std::cos(expect), abs_tol));
+      REQUIRE_THAT(sin_ecc_anom[m], WithinAbs(std::sin(expect), abs_tol));
+      REQUIRE_THAT(cos_ecc_anom[m], WithinAbs(std::cos(expect), abs_tol));
+    }
+  }
+}
+
+template <typename T, typename U>
+struct PhaseTestCase {
+  typedef T value_type;
+  typedef U phase_type;
+};
+
+TEMPLATE_TEST_CASE("Fixed-point phase", "[solve][phase]", (PhaseTestCase<double, std::uint32_t>),
+                   (PhaseTestCase<double, std::uint64_t>), (PhaseTestCase<float, std::uint32_t>),
+                   (PhaseTestCase<float, std::uint64_t>)) {
+  using T = typename TestType::value_type;
+  using U = typename TestType::phase_type;
+  using Starter = starters::raposo_pulido_brandt<T>;
+  using Refiner = refiners::brandt<T>;
+  const T abs_tol = default_abs<T>::value;
+  const size_t ecc_size = 10;
+  const size_t anom_size = 1003;
+  const int bits = std::numeric_limits<U>::digits;
+  std::vector<U> phase(anom_size);
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), ecc_anom_phase(anom_size), sin_ecc_anom_phase(anom_size),
+      cos_ecc_anom_phase(anom_size);
+  for (size_t m = 0; m < anom_size; ++m) {
+    phase[m] = U(m) * (std::numeric_limits<U>::max() / U(anom_size - 1));
+    mean_anomaly[m] = T(std::ldexp(constants::twopi<double>() * double(phase[m]), -bits));
+  }
+
+  for (size_t n = 0; n < ecc_size; ++n) {
+    const T eccentricity = n / T(ecc_size);
+    solver::solve_simd<Starter, Refiner>(eccentricity, anom_size, mean_anomaly.data(),
+                                         ecc_anom.data(), sin_ecc_anom.data(),
+                                         cos_ecc_anom.data());
+    solver::solve_phase_simd<Starter, Refiner>(eccentricity, anom_size, phase.data(),
+                                               ecc_anom_phase.data(), sin_ecc_anom_phase.data(),
+                                               cos_ecc_anom_phase.data());
+    for (size_t m = 0; m < anom_size; ++m) {
+      REQUIRE(ecc_anom_phase[m] >= T(0.));
+      REQUIRE(ecc_anom_phase[m] <= constants::twopi<T>());
+      REQUIRE_THAT(sin_ecc_anom_phase[m], WithinAbs(sin_ecc_anom[m], abs_tol));
+      REQUIRE_THAT(cos_ecc_anom_phase[m], WithinAbs(cos_ecc_anom[m], abs_tol));
+    }
+  }
+}
+
+TEST_CASE("Fixed-point phase near a full orbit", "[solve][phase]") {
+  using T = double;
+  using U = std::uint64_t;
+  using Starter = starters::raposo_pulido_brandt<T>;
+  using Refiner = refiners::brandt<T>;
+  const T eccentricity = 0.5;
+  const size_t anom_size = 100;
+  std::vector<U> phase(anom_size);
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), ecc_anom_phase(anom_size), sin_ecc_anom_phase(anom_size),
+      cos_ecc_anom_phase(anom_size);
+
+  // Phases just short of a full orbit are not representable as radians near
+  // 2 pi, but are solved exactly as the reflection of a tiny mean anomaly
+  for (size_t m = 0; m < anom_size; ++m) {
+    U offset = U(1) << (10 + m % 40);
+    phase[m] = U(0) - offset;
+    mean_anomaly[m] = std::ldexp(constants::twopi<T>() * T(offset), -64);
+  }
+
+  solver::solve_simd<Starter, Refiner>(eccentricity, anom_size, mean_anomaly.data(),
+                                       ecc_anom.data(), sin_ecc_anom.data(), cos_ecc_anom.data());
+  solver::solve_phase_simd<Starter, Refiner>(eccentricity, anom_size, phase.data(),
+                                             ecc_anom_phase.data(), sin_ecc_anom_phase.data(),
+                                             cos_ecc_anom_phase.data());
+  for (size_t m = 0; m < anom_size; ++m) {
+    REQUIRE_THAT(ecc_anom_phase[m], WithinAbs(constants::twopi<T>() - ecc_anom[m], T(1e-15)));
+    REQUIRE_THAT(-sin_ecc_anom_phase[m], WithinRel(sin_ecc_anom[m], T(1e-12)));
+    REQUIRE_THAT(cos_ecc_anom_phase[m], WithinAbs(cos_ecc_anom[m], T(1e-15)));
+  }
+}
+
+TEMPLATE_PRODUCT_TEST_CASE("Continuation", "[solve][continuation][simd]", SolveTestCase,
+                           ((refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
+                            (refiners::brandt<double>, starters::raposo_pulido_brandt<double>),
+                            (refiners::non_iterative<3, double>, starters::markley<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const T abs_tol = tolerance<TestType>::abs;
+  const size_t anom_size = 20003;
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), ecc_anom_cont(anom_size), sin_ecc_anom_cont(anom_size),
+      cos_ecc_anom_cont(anom_size);
+
+  // A dense monotonic grid, with a few large jumps to exercise the fallback
+  for (size_t m = 0; m < anom_size; ++m) {
+    mean_anomaly[m] = T(40.) * m / T(anom_size - 1) - T(20.) + T(3.) * T(m / 5000);
+  }
+
+  for (T eccentricity : {T(0.), T(1e-5), T(0.1), T(0.5), T(0.9), T(0.999)}) {
+    solver::solve_simd<starter_type, refiner_type>(eccentricity, anom_size, mean_anomaly.data(),
+                                                   ecc_anom.data(), sin_ecc_anom.data(),
+                                                   cos_ecc_anom.data());
+
+    for (int simd = 0; simd < 2; ++simd) {
+      if (simd) {
+        solver::solve_continuation_simd<starter_type, refiner_type>(
+            eccentricity, anom_size, mean_anomaly.data(), ecc_anom_cont.data(),
+            sin_ecc_anom_cont.data(), cos_ecc_anom_cont.data());
+      } else {
+        solver::solve_continuation<starter_type, refiner_type>(
+            eccentricity, anom_size, mean_anomaly.data(), ecc_anom_cont.data(),
+            sin_ecc_anom_cont.data(), cos_ecc_anom_cont.data());
+      }
+
+      // The eccentric anomaly is wrapped to the same range as the full solver
+      for (size_t m = 0; m < anom_size; ++m) {
+        REQUIRE_THAT(ecc_anom_cont[m], WithinAbs(ecc_anom[m], abs_tol));
+        REQUIRE_THAT(sin_ecc_anom_cont[m], WithinAbs(sin_ecc_anom[m], abs_tol));
+        REQUIRE_THAT(cos_ecc_anom_cont[m], WithinAbs(cos_ecc_anom[m], abs_tol));
+      }
+    }
+  }
+}
+
+TEMPLATE_PRODUCT_TEST_CASE("Uniform grid", "[solve][uniform][simd]", SolveTestCase,
+                           ((refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
+                            (refiners::brandt<double>, starters::raposo_pulido_brandt<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const T abs_tol = tolerance<TestType>::abs;
+  const size_t anom_size = 100003;
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), ecc_anom_grid(anom_size), sin_ecc_anom_grid(anom_size),
+      cos_ecc_anom_grid(anom_size);
+
+  // The long grids check that the rounding error doesn't drift
+  for (auto grid : {std::make_pair(T(-30.), T(6e-4)), std::make_pair(T(1000.), T(0.07))}) {
+    const T mean_anom_0 = grid.first, mean_anom_step = grid.second;
+    for (size_t m = 0; m < anom_size; ++m) {
+      mean_anomaly[m] = math::fma(T(m), mean_anom_step, mean_anom_0);
+    }
+
+    for (T eccentricity : {T(0.), T(1e-5), T(0.1), T(0.5), T(0.9), T(0.999)}) {
+      solver::solve_simd<starter_type, refiner_type>(eccentricity, anom_size,
+                                                     mean_anomaly.data(), ecc_anom.data(),
+                                                     sin_ecc_anom.data(), cos_ecc_anom.data());
+
+      for (int simd = 0; simd < 2; ++simd) {
+        if (simd) {
+          solver::solve_uniform_simd<starter_type, refiner_type>(
+              eccentricity, mean_anom_0, mean_anom_step, anom_size, ecc_anom_grid.data(),
+              sin_ecc_anom_grid.data(), cos_ecc_anom_grid.data());
+        } else {
+          solver::solve_uniform<starter_type, refiner_type>(
+              eccentricity, mean_anom_0, mean_anom_step, anom_size, ecc_anom_grid.data(),
+              sin_ecc_anom_grid.data(), cos_ecc_anom_grid.data());
+        }
+
+        // The grid solvers see the same M as the full solver, but reduce it
+        // relative to an anchor, which can round differently by a few ulp of
+        // |M| (or of pi, for the reduced anchor). That difference is then
+        // amplified by dE/dM = 1 / (1 - e cos(E)).
+        for (size_t m = 0; m < anom_size; ++m) {
+          const T abs_mean_anom = std::max(std::abs(mean_anomaly[m]), constants::pi<T>());
+          const T ulp = std::nextafter(abs_mean_anom, std::numeric_limits<T>::infinity()) -
+                        abs_mean_anom;
+          const T tol = abs_tol + T(4.) * ulp / (T(1.) - eccentricity * cos_ecc_anom[m]);
+          REQUIRE_THAT(ecc_anom_grid[m], WithinAbs(ecc_anom[m], tol));
+          REQUIRE_THAT(sin_ecc_anom_grid[m], WithinAbs(sin_ecc_anom[m], tol));
+          REQUIRE_THAT(cos_ecc_anom_grid[m], WithinAbs(cos_ecc_anom[m], tol));
+        }
+      }
+    }
+  }
+}
@@ -13,8 +13,23 @@ struct tolerance<starters::mikkola<double>> {
   constexpr static double rel = 0.002;
 };
 
+template <>
+struct tolerance<starters::fukushima<double>> {
+  constexpr static double abs = 1e-13;
+  constexpr static double rel = 0.001;
+};
+
+// The quadrature loses accuracy towards the singular corner, at e = 0.9 and
+// M = 0 here, where the contour starter is meant to be refined
+template <>
+struct tolerance<starters::contour16<double>> {
+  constexpr static double abs = 1e-10;
+  constexpr static double rel = default_rel<double>::value;
+};
+
 TEMPLATE_PRODUCT_TEST_CASE("Starters", "[starters]",
-                           (starters::mikkola, starters::markley, starters::raposo_pulido_brandt),
+                           (starters::mikkola, starters::markley, starters::raposo_pulido_brandt,
+                            starters::fukushima, starters::nijenhuis, starters::contour16),
                            (double, float)) {
   using T = typename TestType::value_type;
   const T abs_tol = tolerance<TestType>::abs;
@@ -35,6 +50,17 @@ TEMPLATE_PRODUCT_TEST_CASE("Starters", "[starters]",
       }
     }
   }
+
+  // Small eccentricities, around the float threshold of the contour starter,
+  // where the error is dominated by e^2 rather than the relative tolerance
+  for (T eccentricity : {T(1e-3), T(1.1e-3), T(1.2e-3)}) {
+    const TestType starter(eccentricity);
+    for (size_t m = 0; m < anom_size; ++m) {
+      const T ecc_anom_expect = constants::pi<T>() * m / T(anom_size - 1);
+      auto mean_anomaly = ecc_anom_expect - eccentricity * std::sin(ecc_anom_expect);
+      REQUIRE_THAT(starter.start(mean_anomaly), WithinAbs(ecc_anom_expect, T(1e-5)));
+    }
+  }
 }
 
 TEST_CASE("RPP17/B21 singular corner", "[starters]") {
@@ -63,7 +89,8 @@ TEST_CASE("RPP17/B21 singular corner", "[starters]") {
 
 TEMPLATE_PRODUCT_TEST_CASE("SIMD comparison", "[starters][simd]",
                            (starters::noop, starters::basic, starters::mikkola, starters::markley,
-                            starters::raposo_pulido_brandt),
+                            starters::raposo_pulido_brandt, starters::fukushima,
+                            starters::nijenhuis, starters::contour16),
                            (double, float)) {
   using T = typename TestType::value_type;
   using B = xs::batch<T>;
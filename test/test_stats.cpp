@@ -0,0 +1,218 @@
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/compact.hpp"
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/memory.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/stats.hpp"
+#include "kepler/kepler/stream.hpp"
+
+using namespace kepler;
+
+namespace {
+
+std::size_t histogram_total(const stats::convergence& result) {
+  std::size_t total = 0;
+  for (int k = 0; k < stats::num_residual_bins; ++k) total += result.residual_histogram[k];
+  return total;
+}
+
+}  // namespace
+
+TEMPLATE_TEST_CASE("Branch statistics", "[stats][simd]", float, double) {
+  using T = TestType;
+  const T abs_tol = default_abs<T>::value;
+  const std::size_t size = 1003;
+  std::vector<T> mean_anomaly(size), ecc_anom(size), sin_ecc_anom(size), cos_ecc_anom(size);
+  for (std::size_t m = 0; m < size; ++m) {
+    mean_anomaly[m] = T(2.) * m / T(size - 1) - T(1.);
+  }
+
+  for (int simd = 0; simd < 2; ++simd) {
+    stats::reset();
+    if (simd) {
+      solver::solve_simd<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+          T(0.9), size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+          cos_ecc_anom.data());
+    } else {
+      solver::solve<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+          T(0.9), size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+          cos_ecc_anom.data());
+    }
+    const auto result = stats::collect();
+
+    REQUIRE(result.calls == 1);
+    REQUIRE(result.elements == size);
+    REQUIRE(result.iterations == 0);
+    REQUIRE(result.max_iterations_reached == 0);
+    REQUIRE(result.non_finite == 0);
+
+    // Both branches are taken in the starter and the refiner for |M| < 0.05
+    // and |M| < 0.4 respectively
+    REQUIRE(result.singular > 0);
+    REQUIRE(result.singular < size);
+    REQUIRE(result.brandt_second_order > 0);
+    REQUIRE(result.brandt_third_order > 0);
+    REQUIRE(result.brandt_second_order + result.brandt_third_order == size);
+    if (!simd) {
+      REQUIRE(result.singular_mixed_batches == 0);
+      REQUIRE(result.brandt_mixed_batches == 0);
+    }
+
+    // Every solution is counted once, and none are less accurate than the tests
+    // require
+    REQUIRE(histogram_total(result) == size);
+    for (int k = 0; k < stats::num_residual_bins; ++k) {
+      if (std::pow(T(10.), T(k - 17)) > abs_tol) REQUIRE(result.residual_histogram[k] == 0);
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("Iteration statistics", "[stats][simd]", float, double) {
+  using T = TestType;
+  const std::size_t size = 1003;
+  std::vector<T> mean_anomaly(size), ecc_anom(size), sin_ecc_anom(size), cos_ecc_anom(size);
+  for (std::size_t m = 0; m < size; ++m) {
+    mean_anomaly[m] = T(100.) * m / T(size - 1) - T(50.);
+  }
+
+  // A zero tolerance never converges, so every element takes every step
+  stats::reset();
+  const refiners::iterative<3, T> capped(2, T(0.));
+  solver::solve_simd<starters::basic<T>, refiners::iterative<3, T>>(
+      T(0.5), size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+      cos_ecc_anom.data(), capped);
+  auto result = stats::collect();
+  REQUIRE(result.iterations == 2 * size);
+  REQUIRE(result.max_iterations_reached == size);
+
+  stats::reset();
+  solver::solve_simd<starters::basic<T>, refiners::iterative<3, T>>(
+      T(0.5), size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+      cos_ecc_anom.data());
+  result = stats::collect();
+  REQUIRE(result.iterations > 0);
+  REQUIRE(result.max_iterations_reached == 0);
+  REQUIRE(result.singular == 0);
+  REQUIRE(result.brandt_second_order + result.brandt_third_order == 0);
+}
+
+TEMPLATE_TEST_CASE("Non-finite statistics", "[stats][simd]", float, double) {
+  using T = TestType;
+  const std::size_t size = 101;
+  std::vector<T> mean_anomaly(size), ecc_anom(size), sin_ecc_anom(size), cos_ecc_anom(size);
+  for (std::size_t m = 0; m < size; ++m) {
+    mean_anomaly[m] = T(0.1) * m;
+  }
+  mean_anomaly[17] = std::numeric_limits<T>::quiet_NaN();
+  mean_anomaly[size - 1] = std::numeric_limits<T>::infinity();
+
+  const T eccentricities[] = {T(0.), T(0.5), T(0.95)};
+  for (const auto eccentricity : eccentricities) {
+    stats::reset();
+    solver::solve_simd<starters::raposo_pulido_brandt<T>, refiners::brandt<T>>(
+        eccentricity, size, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+        cos_ecc_anom.data());
+    const auto result = stats::collect();
+    REQUIRE(result.non_finite == 2);
+    REQUIRE(histogram_total(result) == size - 2);
+  }
+}
+
+TEMPLATE_TEST_CASE("Padded batch statistics", "[stats][simd]", float, double) {
+  using T = TestType;
+  using starter_type = starters::raposo_pulido_brandt<T>;
+  using refiner_type = refiners::brandt<T>;
+  const std::size_t size = 1003;
+
+  // The outputs are offset by one element, so that the streaming solver has a
+  // partial batch before its first aligned store, as well as at the end
+  std::vector<T> mean_anomaly(size), ecc_anom(size + 1), sin_ecc_anom(size + 1),
+      cos_ecc_anom(size + 1);
+  for (std::size_t m = 0; m < size; ++m) {
+    mean_anomaly[m] = T(2.) * m / T(size - 1) - T(1.);
+  }
+
+  for (std::size_t count : {size, size - 1}) {
+    stats::reset();
+    Solver<T> solver(T(0.9));
+    solver.push(count, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+                cos_ecc_anom.data());
+    auto result = stats::collect();
+    REQUIRE(result.calls == 1);
+    REQUIRE(result.elements == count);
+    REQUIRE(result.brandt_second_order + result.brandt_third_order == count);
+    REQUIRE(histogram_total(result) == count);
+
+    stats::reset();
+    solver::solve_simd<starter_type, refiner_type, memory::streaming_mode>(
+        T(0.9), count, mean_anomaly.data(), ecc_anom.data() + 1, sin_ecc_anom.data() + 1,
+        cos_ecc_anom.data() + 1);
+    result = stats::collect();
+    REQUIRE(result.calls == 1);
+    REQUIRE(result.elements == count);
+    REQUIRE(result.brandt_second_order + result.brandt_third_order == count);
+    REQUIRE(histogram_total(result) == count);
+
+    stats::reset();
+    compact::solve<starter_type, refiners::iterative<3, T>>(
+        T(0.9), count, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+        cos_ecc_anom.data());
+    result = stats::collect();
+    REQUIRE(result.calls == 1);
+    REQUIRE(result.elements == count);
+    REQUIRE(histogram_total(result) == count);
+
+    // A zero tolerance never converges, so every element takes every step
+    stats::reset();
+    const refiners::iterative<3, T> capped(2, T(0.));
+    compact::solve<starters::basic<T>, refiners::iterative<3, T>>(
+        T(0.9), count, mean_anomaly.data(), ecc_anom.data(), sin_ecc_anom.data(),
+        cos_ecc_anom.data(), capped);
+    result = stats::collect();
+    REQUIRE(result.iterations == 2 * count);
+    REQUIRE(result.max_iterations_reached == count);
+    REQUIRE(histogram_total(result) == count);
+  }
+}
+
+TEMPLATE_TEST_CASE("Compacting solver statistics", "[stats][compact][simd]", float, double) {
+  using T = TestType;
+  using starter_type = starters::basic<T>;
+  using refiner_type = refiners::iterative<3, T>;
+  const std::size_t size = 10003;
+
+  // The mean anomalies are scattered over [-pi, pi), in no particular order
+  std::vector<T> mean_anomaly(size), ecc_anom(size), sin_ecc_anom(size), cos_ecc_anom(size);
+  for (std::size_t m = 0; m < size; ++m) {
+    mean_anomaly[m] = constants::twopi<T>() * T(std::fmod(0.6180339887498949 * m, 1.) - 0.5);
+  }
+
+  // Near e = 1 the number of steps varies between neighbouring elements, so
+  // the compacting solver takes the same steps on each element as
+  // `solve_simd`, but on fewer batches
+  stats::reset();
+  solver::solve_simd<starter_type, refiner_type>(T(0.99), size, mean_anomaly.data(),
+                                                 ecc_anom.data(), sin_ecc_anom.data(),
+                                                 cos_ecc_anom.data());
+  const auto simd = stats::collect();
+  stats::reset();
+  compact::solve<starter_type, refiner_type>(T(0.99), size, mean_anomaly.data(),
+                                             ecc_anom.data(), sin_ecc_anom.data(),
+                                             cos_ecc_anom.data());
+  const auto result = stats::collect();
+  REQUIRE(result.iterations == simd.iterations);
+  REQUIRE(result.max_iterations_reached == simd.max_iterations_reached);
+  if (xsimd::batch<T>::size > 1) {
+    REQUIRE(result.iteration_batches < simd.iteration_batches);
+  } else {
+    REQUIRE(result.iteration_batches == simd.iteration_batches);
+  }
+  REQUIRE(histogram_total(result) == size);
+}
@@ -0,0 +1,53 @@
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/stream.hpp"
+
+using namespace kepler;
+
+TEMPLATE_PRODUCT_TEST_CASE("Streaming solver", "[stream][simd]", SolveTestCase,
+                           ((refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
+                            (refiners::brandt<double>, starters::raposo_pulido_brandt<double>),
+                            (refiners::non_iterative<3, double>, starters::markley<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const T abs_tol = tolerance<TestType>::abs;
+  const std::size_t anom_size = 1003;
+  const std::size_t chunk_sizes[] = {1, 7, 64, 3, 100, 828};
+  std::vector<T> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), ecc_anom_stream(anom_size), sin_ecc_anom_stream(anom_size),
+      cos_ecc_anom_stream(anom_size);
+  for (std::size_t m = 0; m < anom_size; ++m) {
+    mean_anomaly[m] = T(100.) * m / T(anom_size - 1) - T(50.);
+  }
+
+  Solver<T, starter_type, refiner_type> solver(T(0.));
+  for (T eccentricity : {T(0.), T(1e-5), T(0.3), T(0.9), T(0.999)}) {
+    solver.reset(eccentricity);
+    solver::solve_simd<starter_type, refiner_type>(eccentricity, anom_size, mean_anomaly.data(),
+                                                   ecc_anom.data(), sin_ecc_anom.data(),
+                                                   cos_ecc_anom.data());
+
+    std::size_t offset = 0, num_chunks = 0;
+    for (std::size_t chunk : chunk_sizes) {
+      solver.push(chunk, &mean_anomaly[offset], &ecc_anom_stream[offset],
+                  &sin_ecc_anom_stream[offset], &cos_ecc_anom_stream[offset]);
+      offset += chunk;
+      num_chunks += 1;
+    }
+    REQUIRE(offset == anom_size);
+    REQUIRE(solver.stats().chunks == num_chunks);
+    REQUIRE(solver.stats().elements == anom_size);
+
+    for (std::size_t m = 0; m < anom_size; ++m) {
+      REQUIRE_THAT(ecc_anom_stream[m], WithinAbs(ecc_anom[m], abs_tol));
+      REQUIRE_THAT(sin_ecc_anom_stream[m], WithinAbs(sin_ecc_anom[m], abs_tol));
+      REQUIRE_THAT(cos_ecc_anom_stream[m], WithinAbs(cos_ecc_anom[m], abs_tol));
+    }
+  }
+}
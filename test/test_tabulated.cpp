@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/tabulated.hpp"
+
+using namespace kepler;
+
+namespace {
+
+const tabulated::table& default_table() {
+  static const tabulated::table instance = tabulated::table::generate();
+  return instance;
+}
+
+}  // namespace
+
+TEST_CASE("Tabulated solver accuracy", "[tabulated]") {
+  const auto& table = default_table();
+  REQUIRE(table.valid());
+  REQUIRE(table.info().max_error < 1e-6);
+
+  // Eccentricities beyond the table use the fallback solver
+  const float eccentricities[] = {0.f, 0.1f, 0.5f, 0.8f, 0.85f, 0.9f, 0.95f, 0.999f};
+  const std::size_t anom_size = 1003;
+  std::vector<float> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size);
+  std::vector<double> mean_anomaly_d(anom_size), expect_ecc_anom(anom_size),
+      expect_sin_ecc_anom(anom_size), expect_cos_ecc_anom(anom_size);
+  for (std::size_t m = 0; m < anom_size; ++m) {
+    mean_anomaly[m] = 100.f * m / float(anom_size - 1) - 50.f;
+    mean_anomaly_d[m] = mean_anomaly[m];
+  }
+
+  for (int simd = 0; simd < 2; ++simd) {
+    for (const auto eccentricity : eccentricities) {
+      if (simd) {
+        tabulated::solve_simd(table, eccentricity, anom_size, mean_anomaly.data(),
+                              ecc_anom.data(), sin_ecc_anom.data(), cos_ecc_anom.data());
+      } else {
+        tabulated::solve(table, eccentricity, anom_size, mean_anomaly.data(), ecc_anom.data(),
+                         sin_ecc_anom.data(), cos_ecc_anom.data());
+      }
+      solver::solve<starters::raposo_pulido_brandt<double>, refiners::brandt<double>>(
+          eccentricity, anom_size, mean_anomaly_d.data(), expect_ecc_anom.data(),
+          expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data());
+
+      // The error includes rounding the reduced mean anomaly and E to float
+      const double abs_tol = eccentricity > 0.9f ? 5e-5 : 2e-6;
+      for (std::size_t m = 0; m < anom_size; ++m) {
+        REQUIRE_THAT(ecc_anom[m], WithinAbs(expect_ecc_anom[m], abs_tol));
+        REQUIRE_THAT(sin_ecc_anom[m], WithinAbs(expect_sin_ecc_anom[m], abs_tol));
+        REQUIRE_THAT(cos_ecc_anom[m], WithinAbs(expect_cos_ecc_anom[m], abs_tol));
+      }
+    }
+  }
+}
+
+TEST_CASE("Tabulated solver file format", "[tabulated]") {
+  const auto& table = default_table();
+  const char* path = "test_tabulated.bin";
+  REQUIRE(table.save(path) == tabulated::ok);
+
+  tabulated::table loaded;
+  REQUIRE(loaded.load(path) == tabulated::ok);
+  REQUIRE(loaded.valid());
+  REQUIRE(loaded.size() == table.size());
+  REQUIRE(std::memcmp(loaded.data(), table.data(), table.size()) == 0);
+
+  const std::size_t anom_size = 101;
+  std::vector<float> mean_anomaly(anom_size), ecc_anom(anom_size), sin_ecc_anom(anom_size),
+      cos_ecc_anom(anom_size), expect_ecc_anom(anom_size), expect_sin_ecc_anom(anom_size),
+      expect_cos_ecc_anom(anom_size);
+  for (std::size_t m = 0; m < anom_size; ++m) mean_anomaly[m] = 0.1f * m;
+  tabulated::solve_simd(loaded, 0.7f, anom_size, mean_anomaly.data(), ecc_anom.data(),
+                        sin_ecc_anom.data(), cos_ecc_anom.data());
+  tabulated::solve_simd(table, 0.7f, anom_size, mean_anomaly.data(), expect_ecc_anom.data(),
+                        expect_sin_ecc_anom.data(), expect_cos_ecc_anom.data());
+  for (std::size_t m = 0; m < anom_size; ++m) REQUIRE(ecc_anom[m] == expect_ecc_anom[m]);
+
+  // Tables from other versions, or that are truncated, are rejected
+  std::vector<unsigned char> contents(table.data(), table.data() + table.size());
+  tabulated::header h;
+  std::memcpy(&h, contents.data(), sizeof(h));
+  REQUIRE(tabulated::table::validate(contents.data(), contents.size()) == tabulated::ok);
+  REQUIRE(tabulated::table::validate(contents.data(), contents.size() - 1) ==
+          tabulated::bad_header);
+
+  // A shape whose data size overflows is rejected, even though the wrapped
+  // size, 2^62 cells of 256 bytes modulo 2^64, matches the header
+  std::vector<unsigned char> huge_contents(contents);
+  tabulated::header huge = h;
+  huge.num_ecc = huge.num_anom = std::uint32_t(1) << 31;
+  huge.ecc_degree = huge.anom_degree = tabulated::max_degree;
+  huge.data_size = 0;
+  std::memcpy(huge_contents.data(), &huge, sizeof(huge));
+  REQUIRE(tabulated::table::validate(huge_contents.data(), huge_contents.size()) ==
+          tabulated::bad_header);
+  h.version += 1;
+  std::memcpy(contents.data(), &h, sizeof(h));
+  REQUIRE(tabulated::table::validate(contents.data(), contents.size()) ==
+          tabulated::bad_version);
+  contents[0] = 'X';
+  REQUIRE(tabulated::table::validate(contents.data(), contents.size()) == tabulated::bad_magic);
+
+  std::FILE* file = std::fopen(path, "wb");
+  REQUIRE(file != nullptr);
+  std::fwrite(contents.data(), 1, contents.size(), file);
+  std::fclose(file);
+  REQUIRE(loaded.load(path) == tabulated::bad_magic);
+  REQUIRE(!loaded.valid());
+  std::remove(path);
+
+  REQUIRE(loaded.load("does_not_exist.bin") == tabulated::io_error);
+}
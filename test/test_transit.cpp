@@ -0,0 +1,90 @@
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "./test_utils.hpp"
+#include "kepler/kepler/constants.hpp"
+#include "kepler/kepler/refiners.hpp"
+#include "kepler/kepler/solver.hpp"
+#include "kepler/kepler/starters.hpp"
+#include "kepler/kepler/transit.hpp"
+
+using namespace kepler;
+
+TEMPLATE_PRODUCT_TEST_CASE("Transit culling", "[transit][simd]", SolveTestCase,
+                           ((refiners::brandt<float>, starters::raposo_pulido_brandt<float>),
+                            (refiners::brandt<double>, starters::raposo_pulido_brandt<double>),
+                            (refiners::non_iterative<3, double>, starters::markley<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const T abs_tol = tolerance<TestType>::abs;
+  const std::size_t size = 20011;
+  const T radius = T(1.1);
+  std::vector<T> time(size), mean_anomaly(size), ecc_anom(size), sin_ecc_anom(size),
+      cos_ecc_anom(size), ecc_anom_transit(size), sin_ecc_anom_transit(size),
+      cos_ecc_anom_transit(size);
+  std::vector<std::size_t> index(size);
+  for (std::size_t n = 0; n < size; ++n) {
+    time[n] = T(30.) * n / T(size - 1) - T(3.);
+  }
+
+  for (T eccentricity : {T(0.), T(0.3), T(0.9)}) {
+    for (T omega : {T(-2.), T(0.5)}) {
+      const auto orb = transit::orbit<T>::from_transit(T(10.), T(4.), eccentricity, omega,
+                                                       T(15.), T(1.56));
+      const transit::projection<T> proj(orb);
+      for (std::size_t n = 0; n < size; ++n) {
+        mean_anomaly[n] =
+            constants::twopi<T>() * (time[n] - orb.time_of_periastron) / orb.period;
+      }
+      solver::solve_simd<starter_type, refiner_type>(eccentricity, size, mean_anomaly.data(),
+                                                     ecc_anom.data(), sin_ecc_anom.data(),
+                                                     cos_ecc_anom.data());
+
+      const std::size_t count = transit::solve<starter_type, refiner_type>(
+          orb, radius, size, time.data(), index.data(), ecc_anom_transit.data(),
+          sin_ecc_anom_transit.data(), cos_ecc_anom_transit.data());
+
+      // The transits are short, so most of the times should be culled
+      REQUIRE(count > 0);
+      REQUIRE(count < size / 4);
+
+      std::vector<bool> solved(size, false);
+      for (std::size_t k = 0; k < count; ++k) {
+        const std::size_t n = index[k];
+        REQUIRE(n < size);
+        REQUIRE((k == 0 || index[k - 1] < n));
+        solved[n] = true;
+        REQUIRE_THAT(ecc_anom_transit[k], WithinAbs(ecc_anom[n], abs_tol));
+        REQUIRE_THAT(sin_ecc_anom_transit[k], WithinAbs(sin_ecc_anom[n], abs_tol));
+        REQUIRE_THAT(cos_ecc_anom_transit[k], WithinAbs(cos_ecc_anom[n], abs_tol));
+      }
+
+      // Every time in transit must have been solved
+      for (std::size_t n = 0; n < size; ++n) {
+        if (proj.separation(sin_ecc_anom[n], cos_ecc_anom[n]) < radius) {
+          REQUIRE(solved[n]);
+        }
+      }
+    }
+  }
+}
+
+TEMPLATE_PRODUCT_TEST_CASE("Transit culling with wide blocks", "[transit]", SolveTestCase,
+                           ((refiners::brandt<double>, starters::raposo_pulido_brandt<double>))) {
+  using T = typename TestType::value_type;
+  using starter_type = typename TestType::starter_type;
+  using refiner_type = typename TestType::refiner_type;
+  const std::size_t size = 101;
+  std::vector<T> time(size), ecc_anom(size), sin_ecc_anom(size), cos_ecc_anom(size);
+  std::vector<std::size_t> index(size);
+  for (std::size_t n = 0; n < size; ++n) time[n] = T(100.) * n / T(size - 1);
+
+  // A block spanning several orbits can't be culled, so everything is solved
+  const auto orb = transit::orbit<T>::from_transit(T(3.), T(1.), T(0.1), T(0.2), T(10.), T(1.5));
+  REQUIRE(transit::solve<starter_type, refiner_type>(orb, T(1.1), size, time.data(), index.data(),
+                                                     ecc_anom.data(), sin_ecc_anom.data(),
+                                                     cos_ecc_anom.data(), size) == size);
+  for (std::size_t n = 0; n < size; ++n) REQUIRE(index[n] == n);
+}
@@ -9,7 +9,7 @@ parser.add_argument(
     "-i",
     "--input-file",
     default="benchmark.xml",
-    help="Path to the XML benchmark results",
+    help="Path to the XML benchmark results, or the JSON output of the sweep benchmark",
 )
 parser.add_argument(
     "-o",
@@ -40,14 +40,37 @@ if out_path.exists():
 else:
     out_path.parent.mkdir(parents=True, exist_ok=True)
     previous = []
+print(f"Collecting from: {args.input_file}")
+if args.input_file.endswith(".json"):
+    # Sweep results are stored alongside the Catch2 results for the same
+    # identifier, under the "sweep" key
+    with open(args.input_file, "r") as f:
+        sweep = json.load(f)
+    if sweep.get("type") != "sweep":
+        raise RuntimeError(f"{args.input_file} doesn't contain sweep results")
+    sweep = {"machine": sweep["machine"], "results": sweep["results"]}
+    for result in previous:
+        if result["identifier"] == identifier:
+            if "sweep" in result and not args.overwrite:
+                raise RuntimeError(f"Sweep results already collected for {identifier}")
+            result["sweep"] = sweep
+            break
+    else:
+        previous.append({"identifier": identifier, "results": [], "sweep": sweep})
+    print(f"Writing to: {out_path}")
+    with open(out_path, "w") as f:
+        json.dump(previous, f, indent=4)
+    raise SystemExit(0)
+
+sweep = None
 for result in previous:
     if result["identifier"] == identifier:
-        if args.overwrite:
-            previous.remove(result)
-        else:
+        if result["results"] and not args.overwrite:
             raise RuntimeError(f"Results already collected for {identifier}")
+        previous.remove(result)
+        sweep = result.get("sweep")
+        break
 
-print(f"Collecting from: {args.input_file}")
 results = []
 tree = ElementTree.parse(args.input_file)
 root = tree.getroot()
@@ -57,6 +80,17 @@ for test_case in root:
     info = dict(test_case.attrib)
     info["results"] = []
     for test_result in test_case:
+        text = (test_result.text or "").strip()
+        if test_result.tag == "Warning" and text.startswith("perf: "):
+            # Hardware counters, written by benchmark/perf_counters.hpp after
+            # the benchmark with the same name
+            name, counters = text[6:].split(" | ")
+            for data in info["results"]:
+                if data["name"] == name:
+                    data["counters"] = {
+                        k: float(v) for k, v in (c.split("=") for c in counters.split())
+                    }
+            continue
         if test_result.tag != "BenchmarkResults":
             continue
         data = dict(test_result.attrib)
@@ -66,6 +100,9 @@ for test_case in root:
     results.append(info)
 
 print(f"Writing to: {out_path}")
-previous.append({"identifier": identifier, "results": results})
+entry = {"identifier": identifier, "results": results}
+if sweep is not None:
+    entry["sweep"] = sweep
+previous.append(entry)
 with open(out_path, "w") as f:
     json.dump(previous, f, indent=4)